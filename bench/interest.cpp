@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <unordered_set>
+#include <vector>
+#include "InterestManager.hpp"
+#include "Protocol.hpp"
+#include "Server.hpp"
+
+// Drives the server's interest management with thousands of moving players and no sockets: every tick
+// they move, the grid is rebuilt, every player is sent its PlayerStates and every block edit goes to the
+// players subscribed to its column. Reports the time this takes per tick, against the time the server
+// has for one, and the bytes it would send next to what broadcasting everything to everyone would send.
+// Timings depend on the machine and whatever else it runs, so they are only reported, never failed on.
+
+constexpr int DEFAULT_PLAYER_COUNT = 4000;
+constexpr int DEFAULT_TICK_COUNT = 200;
+constexpr int DEFAULT_VIEW_RADIUS = 6;
+constexpr int EDITS_PER_TICK = 200;
+constexpr double TICK_BUDGET_MS = 1000.0 / SERVER_TICK_RATE;
+
+// Players spread over a square with about this many blocks of it to each; a quarter of them crowd
+// into one spot instead, far more than fit in a tick's budget
+constexpr float BLOCKS_PER_PLAYER = 32.0f * 32.0f;
+constexpr float CROWD_FRACTION = 0.25f;
+constexpr float CROWD_RADIUS = 48.0f;
+
+// Players turn a little every tick, so they wander instead of walking in straight lines
+constexpr float WALK_SPEED = PLAYER_SPEED;
+constexpr float TURN_PER_TICK = 0.3f;
+
+// Id, position and yaw
+constexpr uint64_t REMOTE_PLAYER_BYTES = 4 + 3 * 4 + 4;
+
+using Clock = std::chrono::steady_clock;
+
+struct SimulatedPlayer {
+  glm::vec3 position;
+  float heading;
+  ColumnPos center;
+  bool hasCenter = false;
+  std::unordered_set<ColumnPos, ColumnPosHash> columns;
+};
+
+// What Server::updateInterest does, without the streaming: the player has every column in its view
+void updateColumns(InterestManager &interest, uint32_t id, SimulatedPlayer &player, int viewRadius) {
+  auto center = columnOf(chunkContaining(glm::ivec3(glm::floor(player.position))));
+  if (player.hasCenter && center == player.center) {
+    return;
+  }
+  player.center = center;
+  player.hasCenter = true;
+
+  auto unloadRadius = viewRadius + 1;
+  std::erase_if(player.columns, [&](ColumnPos position) {
+    auto delta = position - center;
+    if (delta.x * delta.x + delta.y * delta.y <= unloadRadius * unloadRadius) {
+      return false;
+    }
+    interest.unsubscribe(id, position);
+    return true;
+  });
+
+  for (auto dx = -viewRadius; dx <= viewRadius; ++dx) {
+    for (auto dz = -viewRadius; dz <= viewRadius; ++dz) {
+      ColumnPos position = center + ColumnPos(dx, dz);
+      if (dx * dx + dz * dz <= viewRadius * viewRadius && player.columns.insert(position).second) {
+        interest.subscribe(id, position);
+      }
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  auto playerCount = argc > 1 ? std::atoi(argv[1]) : DEFAULT_PLAYER_COUNT;
+  auto tickCount = argc > 2 ? std::atoi(argv[2]) : DEFAULT_TICK_COUNT;
+  auto viewRadius = argc > 3 ? std::atoi(argv[3]) : DEFAULT_VIEW_RADIUS;
+  if (playerCount <= 1 || tickCount <= 0 || viewRadius <= 0) {
+    std::cerr << "Usage: netblocks_interest [players] [ticks] [view radius]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::mt19937 random(42);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  auto worldSize = std::sqrt(static_cast<float>(playerCount) * BLOCKS_PER_PLAYER);
+  auto crowdSize = static_cast<int>(static_cast<float>(playerCount) * CROWD_FRACTION);
+
+  std::vector<SimulatedPlayer> players(playerCount);
+  for (auto i = 0; i < playerCount; ++i) {
+    auto &player = players[i];
+    if (i < crowdSize) {
+      auto angle = unit(random) * 6.2831853f;
+      auto distance = std::sqrt(unit(random)) * CROWD_RADIUS;
+      player.position = {std::cos(angle) * distance, 100.0f, std::sin(angle) * distance};
+    } else {
+      player.position = {(unit(random) - 0.5f) * worldSize, 100.0f, (unit(random) - 0.5f) * worldSize};
+    }
+    player.heading = unit(random) * 6.2831853f;
+  }
+
+  std::cout << playerCount << " players (" << crowdSize << " in a crowd) over " << static_cast<int>(worldSize)
+            << " blocks square, view radius " << viewRadius << ", " << tickCount << " ticks" << std::endl;
+
+  // Everyone has joined before the clock starts; the server streams a player's columns over many ticks,
+  // never a whole view for thousands of players in one
+  InterestManager interest;
+  for (auto i = 0; i < playerCount; ++i) {
+    auto id = static_cast<uint32_t>(i);
+    interest.setPlayer(id, players[i].position, viewRadius);
+    updateColumns(interest, id, players[i], viewRadius);
+  }
+
+  std::vector<uint32_t> selected;
+  std::vector<uint8_t> out;
+  std::vector<uint8_t> changeMessage;
+  PlayerStatesMessage states{};
+  writePlayerStates(out, states);
+  auto emptyStates = static_cast<uint64_t>(out.size());
+
+  uint64_t stateBytes = 0;
+  uint64_t changeBytes = 0;
+  uint64_t naiveStateBytes = 0;
+  uint64_t naiveChangeBytes = 0;
+  size_t crowdWorstMessage = 0;
+  std::vector<double> tickMs;
+  tickMs.reserve(tickCount);
+
+  for (auto tick = 1; tick <= tickCount; ++tick) {
+    for (auto &player: players) {
+      player.heading += (unit(random) - 0.5f) * TURN_PER_TICK;
+      player.position += glm::vec3(std::cos(player.heading), 0.0f, std::sin(player.heading)) * WALK_SPEED /
+                         static_cast<float>(SERVER_TICK_RATE);
+    }
+
+    auto start = Clock::now();
+    for (auto i = 0; i < playerCount; ++i) {
+      auto id = static_cast<uint32_t>(i);
+      interest.setPlayer(id, players[i].position, viewRadius);
+      updateColumns(interest, id, players[i], viewRadius);
+    }
+    interest.rebuildGrid();
+
+    // Edits land next to random players, as digging and building would
+    for (auto edit = 0; edit < EDITS_PER_TICK; ++edit) {
+      const auto &editor = players[random() % players.size()];
+      auto chunk = chunkContaining(glm::ivec3(glm::floor(editor.position)));
+      changeMessage.clear();
+      writeBlockChanges(changeMessage, {chunk, 0, 1, {{static_cast<uint16_t>(random() % 4096), 1}}});
+      changeBytes += changeMessage.size() * interest.getSubscribers(columnOf(chunk)).size();
+      naiveChangeBytes += changeMessage.size() * static_cast<size_t>(playerCount);
+    }
+
+    for (auto i = 0; i < playerCount; ++i) {
+      auto id = static_cast<uint32_t>(i);
+      states.tick = static_cast<uint32_t>(tick);
+      states.state.position = players[i].position;
+      states.players.clear();
+      interest.selectPlayers(id, MAX_PLAYER_UPDATES_PER_TICK, selected, states.removed);
+      for (auto other: selected) {
+        states.players.push_back({other, players[other].position, players[other].heading});
+      }
+
+      out.clear();
+      writePlayerStates(out, states);
+      stateBytes += out.size();
+      if (i < crowdSize) {
+        crowdWorstMessage = std::max(crowdWorstMessage, out.size());
+      }
+    }
+    tickMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+
+    // Every other player in every message, whether in view or not
+    naiveStateBytes += static_cast<uint64_t>(playerCount) * (emptyStates + (playerCount - 1) * REMOTE_PLAYER_BYTES);
+  }
+
+  auto stats = interest.getStats();
+  auto seconds = static_cast<double>(tickCount) / SERVER_TICK_RATE;
+  auto perClient = [&](uint64_t bytes) {
+    return static_cast<double>(bytes) / seconds / playerCount / 1024.0;
+  };
+  auto meanMs = std::accumulate(tickMs.begin(), tickMs.end(), 0.0) / tickCount;
+  std::sort(tickMs.begin(), tickMs.end());
+  std::cout << "interest management: " << meanMs << " ms per tick (" << 100.0 * meanMs / TICK_BUDGET_MS
+            << "% of a " << TICK_BUDGET_MS << " ms server tick), " << tickMs[tickMs.size() / 2] << " ms median, "
+            << tickMs.back() << " ms worst, " << stats.cells << " grid cells" << std::endl;
+  std::cout << "player states: " << perClient(stateBytes) << " KiB/s per client, " << stats.selected << " updates, "
+            << stats.deferred << " deferred by the budget ("
+            << 100.0 * static_cast<double>(stats.deferred) / static_cast<double>(std::max<uint64_t>(stats.candidates, 1))
+            << "% of players in view), largest crowd message " << crowdWorstMessage << " bytes" << std::endl;
+  std::cout << "block changes: " << perClient(changeBytes) << " KiB/s per client" << std::endl;
+  std::cout << "broadcasting everything instead: " << perClient(naiveStateBytes) << " KiB/s of player states and "
+            << perClient(naiveChangeBytes) << " KiB/s of block changes per client" << std::endl;
+  return EXIT_SUCCESS;
+}
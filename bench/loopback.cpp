@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "NetworkClient.hpp"
+#include "Server.hpp"
+#include "TerrainGenerator.hpp"
+
+constexpr int DEFAULT_CLIENT_COUNT = 256;
+constexpr double DEFAULT_DURATION_SECONDS = 10.0;
+constexpr int DEFAULT_VIEW_RADIUS = 6;
+constexpr uint32_t SEED = 42;
+
+// Every client sprints straight out from the origin in its own direction, so the server keeps streaming
+// new chunks for the whole run instead of only the initial view. They fly above the terrain, so the server
+// only stops them where it has not generated a column yet, which shows up as a prediction correction.
+constexpr uint8_t WALK_BUTTONS = INPUT_FORWARD | INPUT_SPRINT | INPUT_FLY;
+
+// Streaming only follows the column a client is in, so its height only has to clear the terrain
+constexpr float CLIENT_HEIGHT = WORLD_HEIGHT - 8.0f;
+
+// Every client also edits a block near itself and the surface this often, which every other client nearby
+// receives
+constexpr double EDIT_INTERVAL_SECONDS = 0.5;
+
+using Clock = std::chrono::steady_clock;
+
+struct SimulatedClient {
+  NetworkClient client;
+  // The clients keep no world, so they predict open air
+  MovementPredictor predictor{[](glm::ivec3) {
+    return false;
+  }, PlayerState{{0.0f, CLIENT_HEIGHT, 0.0f}, glm::vec3(0.0f), false}};
+  float yaw;
+  uint64_t steps = 0;
+  size_t playersSeen = 0;
+  double fullViewSeconds = -1.0;
+};
+
+int viewColumnCount(int radius) {
+  auto count = 0;
+  for (auto dx = -radius; dx <= radius; ++dx) {
+    for (auto dz = -radius; dz <= radius; ++dz) {
+      count += dx * dx + dz * dz <= radius * radius;
+    }
+  }
+  return count;
+}
+
+// Runs a server on a free loopback port and drives many clients against it from this thread
+int main(int argc, char **argv) {
+  auto clientCount = argc > 1 ? std::atoi(argv[1]) : DEFAULT_CLIENT_COUNT;
+  auto duration = argc > 2 ? std::atof(argv[2]) : DEFAULT_DURATION_SECONDS;
+  auto viewRadius = argc > 3 ? std::atoi(argv[3]) : DEFAULT_VIEW_RADIUS;
+  if (clientCount <= 0 || duration <= 0 || viewRadius <= 0) {
+    std::cerr << "Usage: netblocks_loopback [clients] [seconds] [view radius]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Server server(SEED, 0);
+  if (!server.start()) {
+    return EXIT_FAILURE;
+  }
+
+  std::atomic<bool> running = true;
+  std::thread serverThread([&server, &running]() {
+    server.run(running);
+  });
+
+  std::cout << clientCount << " clients, view radius " << viewRadius << ", " << duration << " s on port "
+            << server.getPort() << std::endl;
+
+  auto start = Clock::now();
+  std::vector<std::unique_ptr<SimulatedClient>> clients;
+  for (auto i = 0; i < clientCount; ++i) {
+    auto angle = static_cast<float>(i) / clientCount * 6.2831853f;
+    auto simulated = std::make_unique<SimulatedClient>();
+    simulated->yaw = glm::degrees(angle);
+    simulated->client.setPlayerStatesHandler([client = simulated.get()](const PlayerStatesMessage &message) {
+      client->predictor.reconcile(message.lastInput, message.state);
+      client->playersSeen = std::max(client->playersSeen, message.players.size());
+    });
+    if (!simulated->client.connect("127.0.0.1", server.getPort(), viewRadius, glm::vec3(0.0f, CLIENT_HEIGHT, 0.0f))) {
+      std::cerr << "Client " << i << " could not connect" << std::endl;
+      break;
+    }
+    clients.push_back(std::move(simulated));
+  }
+  auto connectSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  auto fullView = static_cast<uint64_t>(viewColumnCount(viewRadius));
+  std::vector<PlayerInput> inputs;
+  auto lastEdit = 0.0;
+  uint32_t editState = SEED;
+  TerrainGenerator terrain(SEED);
+  HeightMap surface;
+  size_t disconnected = 0;
+
+  start = Clock::now();
+  while (true) {
+    auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    if (elapsed >= duration) {
+      break;
+    }
+
+    auto steps = static_cast<uint64_t>(elapsed * MOVEMENT_TICK_RATE);
+    auto sendEdits = elapsed - lastEdit >= EDIT_INTERVAL_SECONDS;
+    if (sendEdits) {
+      lastEdit = elapsed;
+    }
+
+    for (auto &simulated: clients) {
+      if (!simulated->client.isConnected()) {
+        continue;
+      }
+      if (!simulated->client.poll()) {
+        ++disconnected;
+        continue;
+      }
+
+      if (simulated->fullViewSeconds < 0 && simulated->client.getStats().columnsReceived >= fullView) {
+        simulated->fullViewSeconds = elapsed;
+      }
+      // Steps start once the server has welcomed the client, since inputs sent before then are dropped
+      if (!simulated->client.isWelcomed()) {
+        simulated->steps = steps;
+      }
+      for (; simulated->steps < steps; ++simulated->steps) {
+        simulated->predictor.predict(WALK_BUTTONS, simulated->yaw, 0.0f);
+        simulated->predictor.getRecentInputs(INPUTS_PER_DATAGRAM, inputs);
+        simulated->client.sendInputs(inputs);
+      }
+      auto walked = glm::vec2(simulated->predictor.getState().position.x, simulated->predictor.getState().position.z);
+      if (sendEdits) {
+        editState = editState * 1664525u + 1013904223u;
+        glm::ivec3 block(static_cast<int>(walked.x) + static_cast<int>(editState >> 28) - 8, 0,
+                         static_cast<int>(walked.y) + static_cast<int>((editState >> 24) & 15) - 8);
+        auto chunk = chunkContaining(block);
+        terrain.getHeightMap(columnOf(chunk), surface);
+        block.y = surface.get(block.x - chunk.x * CHUNK_SIZE, block.z - chunk.z * CHUNK_SIZE) +
+                  static_cast<int>((editState >> 8) & 3) - 2;
+        simulated->client.sendSetBlock(block, static_cast<BlockId>((editState >> 4) & 1));
+      }
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  running = false;
+  serverThread.join();
+
+  uint64_t columns = 0;
+  uint64_t chunks = 0;
+  uint64_t bytes = 0;
+  uint64_t changeBatches = 0;
+  uint64_t resyncs = 0;
+  uint64_t corrections = 0;
+  float maxCorrection = 0.0f;
+  size_t playersSeen = 0;
+  std::vector<double> fullViewTimes;
+  for (const auto &simulated: clients) {
+    auto stats = simulated->client.getStats();
+    columns += stats.columnsReceived;
+    chunks += stats.chunksReceived;
+    bytes += stats.bytesReceived;
+    changeBatches += stats.blockChangeBatches;
+    resyncs += stats.resyncs;
+    corrections += simulated->predictor.getStats().corrections;
+    maxCorrection = std::max(maxCorrection, simulated->predictor.getStats().maxCorrection);
+    playersSeen = std::max(playersSeen, simulated->playersSeen);
+    if (simulated->fullViewSeconds >= 0) {
+      fullViewTimes.push_back(simulated->fullViewSeconds);
+    }
+  }
+  std::sort(fullViewTimes.begin(), fullViewTimes.end());
+
+  const auto &stats = server.getStats();
+  std::cout << clients.size() << " connected in " << connectSeconds * 1000 << " ms, " << disconnected
+            << " dropped" << std::endl;
+  std::cout << columns << " columns and " << chunks << " chunks received (" << chunks / duration << " chunks/s), "
+            << bytes / duration / (1024 * 1024) << " MiB/s, " << (chunks ? bytes / chunks : 0) << " bytes/chunk"
+            << std::endl;
+  std::cout << stats.blockChanges << " block changes applied, " << changeBatches << " change batches received, "
+            << resyncs << " resyncs" << std::endl;
+  std::cout << corrections << " prediction corrections, largest " << maxCorrection << " blocks, up to "
+            << playersSeen << " other players per update, " << stats.playerUpdates << " player updates sent, "
+            << stats.playerUpdatesDeferred << " deferred" << std::endl;
+  if (!fullViewTimes.empty()) {
+    std::cout << fullViewTimes.size() << " clients reached their full " << fullView << "-column view, median "
+              << fullViewTimes[fullViewTimes.size() / 2] * 1000 << " ms, worst " << fullViewTimes.back() * 1000
+              << " ms" << std::endl;
+  }
+  std::cout << "server: " << stats.ticks << " ticks, " << stats.totalTickMs / std::max<uint64_t>(stats.ticks, 1)
+            << " ms average, " << stats.maxTickMs << " ms worst, " << stats.chunksGenerated << " chunks generated, "
+            << stats.cachedColumns << " columns cached" << std::endl;
+  return disconnected == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,1006 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "ChunkCodec.hpp"
+#include "ChunkConnectivity.hpp"
+#include "ChunkMesher.hpp"
+#include "JobSystem.hpp"
+#include "LightEngine.hpp"
+#include "Noise.hpp"
+#include "PlayerMovement.hpp"
+#include "TerrainGenerator.hpp"
+
+constexpr int ITERATIONS = 2000;
+constexpr int DEFAULT_CHUNK_COUNT = 1024;
+constexpr uint32_t SEED = 42;
+constexpr int WIRE_ROUNDS = 20;
+constexpr int CHANGES_PER_BATCH = 64;
+constexpr int REPEATED_EDITS = 3 * CHUNK_VOLUME;
+constexpr int PHYSICS_RADIUS_COLUMNS = 4;
+constexpr int PHYSICS_PLAYERS = 1024;
+constexpr int PHYSICS_STEPS = MOVEMENT_TICK_RATE * 10;
+constexpr int PHYSICS_INPUT_STEPS = 30;
+constexpr int LIGHT_RADIUS_COLUMNS = 3;
+constexpr int LIGHT_EDITS = 2000;
+constexpr unsigned ORDERING_WORKERS = 4;
+constexpr int ORDERING_JOBS = 2000;
+constexpr int ORDERING_JOB_MICROSECONDS = 20;
+// A worker descheduled between popping a job and running it lets that job start far behind its queue
+constexpr size_t ORDERING_STRAGGLERS = ORDERING_JOBS / 100;
+
+// Every heap allocation in the process is counted, so phases can report how many they made. All the
+// replaceable forms go through the same pair, so whichever one the compiler picks, allocation and release
+// match. Blocks are aligned by hand inside a larger malloc block, whose start is kept just before the
+// pointer handed out, since Windows has no aligned_alloc that free can release.
+std::atomic<size_t> allocationCount = 0;
+
+void *allocate(size_t size, std::align_val_t alignment, bool throws) {
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  auto align = std::max(static_cast<size_t>(alignment), alignof(std::max_align_t));
+  auto *block = static_cast<char *>(std::malloc(size + align + sizeof(void *)));
+  if (block == nullptr) {
+    if (throws) {
+      throw std::bad_alloc();
+    }
+    return nullptr;
+  }
+
+  auto start = reinterpret_cast<uintptr_t>(block + sizeof(void *));
+  auto *pointer = reinterpret_cast<void **>((start + align - 1) & ~(static_cast<uintptr_t>(align) - 1));
+  pointer[-1] = block;
+  return pointer;
+}
+
+void release(void *pointer) noexcept {
+  if (pointer != nullptr) {
+    std::free(static_cast<void **>(pointer)[-1]);
+  }
+}
+
+void *operator new(size_t size) {
+  return allocate(size, std::align_val_t(alignof(std::max_align_t)), true);
+}
+
+void *operator new[](size_t size) {
+  return allocate(size, std::align_val_t(alignof(std::max_align_t)), true);
+}
+
+void *operator new(size_t size, std::align_val_t alignment) {
+  return allocate(size, alignment, true);
+}
+
+void *operator new[](size_t size, std::align_val_t alignment) {
+  return allocate(size, alignment, true);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return allocate(size, std::align_val_t(alignof(std::max_align_t)), false);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return allocate(size, std::align_val_t(alignof(std::max_align_t)), false);
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+  return allocate(size, alignment, false);
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+  return allocate(size, alignment, false);
+}
+
+void operator delete(void *pointer) noexcept {
+  release(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+  release(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+  release(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept {
+  release(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+  release(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+  release(pointer);
+}
+
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept {
+  release(pointer);
+}
+
+void operator delete[](void *pointer, size_t, std::align_val_t) noexcept {
+  release(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept {
+  release(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept {
+  release(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t, const std::nothrow_t &) noexcept {
+  release(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t, const std::nothrow_t &) noexcept {
+  release(pointer);
+}
+
+// The chunk holding the surface at the middle of a column
+ChunkPos surfaceChunk(const TerrainGenerator &terrain, int x, int z) {
+  HeightMap map;
+  terrain.getHeightMap({x, z}, map);
+  return {x, std::max(floorDiv(map.get(CHUNK_SIZE / 2, CHUNK_SIZE / 2) - 1, CHUNK_SIZE), 0), z};
+}
+
+// The surface chunk of column (0, 0) of the hills terrain with its neighbours, as the world would
+// snapshot it
+void generateSnapshot(ChunkSnapshot &snapshot) {
+  TerrainGenerator terrain(SEED);
+  auto center = surfaceChunk(terrain, 0, 0);
+  std::vector<BlockStorage> storage(27);
+  const BlockStorage *neighbors[3][3][3];
+  for (auto dx = -1; dx <= 1; ++dx) {
+    for (auto dy = -1; dy <= 1; ++dy) {
+      for (auto dz = -1; dz <= 1; ++dz) {
+        auto &blocks = storage[((dx + 1) * 3 + dy + 1) * 3 + dz + 1];
+        terrain.generate(center + ChunkPos(dx, dy, dz), blocks);
+        neighbors[dx + 1][dy + 1][dz + 1] = &blocks;
+      }
+    }
+  }
+  snapshot.fill(neighbors);
+}
+
+// The mesher as it was before bit-column occupancy and corner AO: six isSolid calls per voxel and a
+// 27-sample neighbourhood per vertex. Kept here only as the baseline to compare against.
+size_t buildLegacyMesh(const ChunkSnapshot &snapshot, MeshData &mesh) {
+  static const glm::ivec3 normals[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+  static const glm::ivec3 corners[6][4] = {
+    {{1, 0, 0}, {1, 1, 0}, {1, 1, 1}, {1, 0, 1}},
+    {{0, 0, 1}, {0, 1, 1}, {0, 1, 0}, {0, 0, 0}},
+    {{0, 1, 1}, {1, 1, 1}, {1, 1, 0}, {0, 1, 0}},
+    {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}},
+    {{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}},
+    {{1, 1, 0}, {0, 1, 0}, {0, 0, 0}, {1, 0, 0}}
+  };
+
+  mesh = MeshData();
+  for (auto x = 0; x < CHUNK_SIZE; ++x) {
+    for (auto y = 0; y < CHUNK_SIZE; ++y) {
+      for (auto z = 0; z < CHUNK_SIZE; ++z) {
+        if (!snapshot.isSolid(x, y, z)) {
+          continue;
+        }
+
+        for (auto face = 0; face < 6; ++face) {
+          auto neighbor = glm::ivec3(x, y, z) + normals[face];
+          if (snapshot.isSolid(neighbor.x, neighbor.y, neighbor.z)) {
+            continue;
+          }
+
+          auto startIndex = static_cast<uint32_t>(mesh.vertices.size());
+          for (auto corner = 0; corner < 4; ++corner) {
+            auto vertex = glm::ivec3(x, y, z) + corners[face][corner];
+            auto solidCount = 0;
+            for (auto dx = -1; dx <= 1; ++dx) {
+              for (auto dy = -1; dy <= 1; ++dy) {
+                for (auto dz = -1; dz <= 1; ++dz) {
+                  solidCount += snapshot.isSolid(vertex.x + dx, vertex.y + dy, vertex.z + dz);
+                }
+              }
+            }
+            auto occlusion = static_cast<uint32_t>((3 * (27 - solidCount) + 13) / 27);
+            mesh.vertices.push_back(packVertex(vertex, face, occlusion, FULL_SKY_LIGHT));
+          }
+
+          for (auto index: {0u, 1u, 2u, 0u, 2u, 3u}) {
+            mesh.indices.push_back(startIndex + index);
+          }
+          ++mesh.stats.quads;
+        }
+      }
+    }
+  }
+  return mesh.stats.quads;
+}
+
+template<typename Function>
+double measure(const char *name, Function &&function) {
+  size_t quads = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (auto i = 0; i < ITERATIONS; ++i) {
+    quads += function();
+  }
+  auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+  auto perMesh = elapsed / ITERATIONS;
+  std::cout << name << ": " << perMesh << " us/mesh, " << quads / ITERATIONS << " quads" << std::endl;
+  return perMesh;
+}
+
+// Terrain noise for one chunk's worth of columns, and a 3D field of the same size per block
+template<typename Function>
+double measureNoise(const char *name, Function &&function) {
+  auto start = std::chrono::steady_clock::now();
+  for (auto i = 0; i < ITERATIONS; ++i) {
+    function(i);
+  }
+  auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+  auto perChunk = elapsed / ITERATIONS;
+  std::cout << name << ": " << perChunk << " us/chunk, " << 1e6 / perChunk << " chunks/s" << std::endl;
+  return perChunk;
+}
+
+// Decodes both meshes and interpolates each greedy quad at the corners of every naive face it covers, which
+// must give that face's own occlusion and light. The snapshot is checked as generated and with light
+// falling off across it, so light gradients are merged too.
+size_t countGreedyShadingMismatches(const ChunkSnapshot &generated) {
+  auto lit = std::make_unique<ChunkSnapshot>(generated);
+  for (auto x = 0; x < SNAPSHOT_SIZE; ++x) {
+    for (auto y = 0; y < SNAPSHOT_SIZE; ++y) {
+      for (auto z = 0; z < SNAPSHOT_SIZE; ++z) {
+        lit->light[x][y][z] = packLight(static_cast<uint8_t>(y % (MAX_LIGHT + 1)), static_cast<uint8_t>(x / 2));
+      }
+    }
+  }
+
+  struct Corner {
+    glm::vec3 position;
+    // Occlusion, sky light and block light
+    glm::vec3 shading;
+  };
+  auto decode = [](uint32_t vertex) {
+    constexpr uint32_t POSITION_MASK = (1u << VERTEX_POSITION_BITS) - 1;
+    auto light = vertex >> VERTEX_LIGHT_SHIFT & 0xff;
+    return Corner{{vertex & POSITION_MASK, vertex >> VERTEX_POSITION_BITS & POSITION_MASK,
+                   vertex >> (VERTEX_POSITION_BITS * 2) & POSITION_MASK},
+                  {vertex >> VERTEX_OCCLUSION_SHIFT & 3u, light >> 4, light & MAX_LIGHT}};
+  };
+  auto normalOf = [](uint32_t vertex) {
+    return vertex >> VERTEX_NORMAL_SHIFT & 7u;
+  };
+
+  size_t mismatches = 0;
+  for (const auto *snapshot: {&generated, static_cast<const ChunkSnapshot *>(lit.get())}) {
+    auto naive = ChunkMesher(*snapshot, MeshingMode::Naive).build();
+    auto greedy = ChunkMesher(*snapshot, MeshingMode::Greedy).build();
+
+    for (size_t face = 0; face < naive.vertices.size(); face += 4) {
+      Corner corners[4];
+      for (auto corner = 0; corner < 4; ++corner) {
+        corners[corner] = decode(naive.vertices[face + corner]);
+      }
+      auto low = glm::min(glm::min(corners[0].position, corners[1].position), corners[2].position);
+      auto high = glm::max(glm::max(corners[0].position, corners[1].position), corners[2].position);
+
+      auto covered = false;
+      for (size_t quad = 0; quad < greedy.vertices.size() && !covered; quad += 4) {
+        if (normalOf(greedy.vertices[quad]) != normalOf(naive.vertices[face])) {
+          continue;
+        }
+        Corner quadCorners[4];
+        for (auto corner = 0; corner < 4; ++corner) {
+          quadCorners[corner] = decode(greedy.vertices[quad + corner]);
+        }
+        auto quadLow = glm::min(quadCorners[0].position, quadCorners[2].position);
+        auto quadHigh = glm::max(quadCorners[0].position, quadCorners[2].position);
+        if (glm::any(glm::lessThan(low, quadLow)) || glm::any(glm::greaterThan(high, quadHigh))) {
+          continue;
+        }
+
+        // Corners go around the quad, so 1 and 3 are along its two edges from 0
+        covered = true;
+        auto edgeS = quadCorners[1].position - quadCorners[0].position;
+        auto edgeT = quadCorners[3].position - quadCorners[0].position;
+        for (const auto &corner: corners) {
+          auto offset = corner.position - quadCorners[0].position;
+          auto s = glm::dot(offset, edgeS) / glm::dot(edgeS, edgeS);
+          auto t = glm::dot(offset, edgeT) / glm::dot(edgeT, edgeT);
+          auto shading = (1.0f - s) * (1.0f - t) * quadCorners[0].shading + s * (1.0f - t) * quadCorners[1].shading +
+                         s * t * quadCorners[2].shading + (1.0f - s) * t * quadCorners[3].shading;
+          if (glm::any(glm::greaterThan(glm::abs(shading - corner.shading), glm::vec3(0.01f)))) {
+            ++mismatches;
+            break;
+          }
+        }
+      }
+      mismatches += !covered;
+    }
+  }
+  return mismatches;
+}
+
+// Counts samples where the batched noise differs from the scalar reference in any bit
+size_t countNoiseMismatches() {
+  constexpr int SAMPLES = 4099;
+  std::vector<float> xs(SAMPLES), ys(SAMPLES), zs(SAMPLES), batched(SAMPLES);
+  for (auto i = 0; i < SAMPLES; ++i) {
+    xs[i] = static_cast<float>(i % 97) * 0.37f - 18.0f;
+    ys[i] = static_cast<float>(i / 97) * 0.29f - 6.0f;
+    zs[i] = static_cast<float>(i % 13) * 1.71f - 11.0f;
+  }
+
+  size_t mismatches = 0;
+  auto compare = [&mismatches](float a, float b) {
+    mismatches += std::memcmp(&a, &b, sizeof(float)) != 0;
+  };
+
+  fractalNoise2(xs.data(), ys.data(), SAMPLES, SEED, TERRAIN_NOISE, batched.data());
+  for (auto i = 0; i < SAMPLES; ++i) {
+    compare(batched[i], fractalNoise2(xs[i], ys[i], SEED, TERRAIN_NOISE));
+  }
+
+  fractalNoise3(xs.data(), ys.data(), zs.data(), SAMPLES, SEED, TERRAIN_NOISE, batched.data());
+  for (auto i = 0; i < SAMPLES; ++i) {
+    compare(batched[i], fractalNoise3(xs[i], ys[i], zs[i], SEED, TERRAIN_NOISE));
+  }
+  return mismatches;
+}
+
+struct ScenarioResult {
+  double generateSeconds = 0.0;
+  double meshSeconds = 0.0;
+  size_t quads = 0;
+  size_t vertexBytes = 0;
+  size_t indexBytes = 0;
+  size_t blockBytes = 0;
+  size_t generateAllocations = 0;
+  size_t meshAllocations = 0;
+  size_t chunks = 0;
+  size_t skippedChunks = 0;
+};
+
+// Generates whole columns in a square around the origin until there are chunkCount chunks, skipping air
+// and buried chunks the way World does, then meshes each one the way a World mesh job does: snapshot,
+// mesher, connectivity
+ScenarioResult runScenario(TerrainType type, MeshingMode mode, int chunkCount, int lodLevel = 0) {
+  TerrainGenerator terrain(SEED, type);
+  auto side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(chunkCount))));
+  std::vector<BlockStorage> chunks;
+  std::vector<ChunkPos> positions;
+  std::unordered_map<ChunkPos, size_t, ChunkPosHash> indices;
+  std::unordered_map<ColumnPos, int, ColumnPosHash> firstSurfaceChunks;
+  chunks.reserve(chunkCount + WORLD_HEIGHT_CHUNKS);
+
+  ScenarioResult result;
+  auto allocationsBefore = allocationCount.load();
+  auto start = std::chrono::steady_clock::now();
+  for (auto i = 0; static_cast<int>(chunks.size()) < chunkCount; ++i) {
+    ColumnPos column(i / side, i % side);
+    HeightMap map;
+    terrain.getHeightMap(column, map);
+    firstSurfaceChunks[column] = map.getFirstSurfaceChunk();
+
+    auto first = map.getFirstSurfaceChunk();
+    auto last = map.getLastSurfaceChunk();
+    for (auto y = first; y <= last; ++y) {
+      ChunkPos position(column.x, y, column.y);
+      indices[position] = chunks.size();
+      positions.push_back(position);
+      terrain.generate(position, map, chunks.emplace_back());
+    }
+    result.skippedChunks += WORLD_HEIGHT_CHUNKS - std::max(last - first + 1, 0);
+  }
+  result.chunks = chunks.size();
+  result.generateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result.generateAllocations = allocationCount.load() - allocationsBefore;
+
+  for (const auto &blocks : chunks) {
+    result.blockBytes += blocks.getMemoryUsage();
+  }
+
+  BlockStorage solidBlocks;
+  solidBlocks.fill(TERRAIN_BLOCK);
+
+  auto snapshot = std::make_unique<ChunkSnapshot>();
+  allocationsBefore = allocationCount.load();
+  start = std::chrono::steady_clock::now();
+  for (auto position : positions) {
+    const BlockStorage *neighbors[3][3][3];
+    for (auto dx = -1; dx <= 1; ++dx) {
+      for (auto dy = -1; dy <= 1; ++dy) {
+        for (auto dz = -1; dz <= 1; ++dz) {
+          auto neighbor = position + ChunkPos(dx, dy, dz);
+          auto column = firstSurfaceChunks.find(columnOf(neighbor));
+          const BlockStorage *blocks = nullptr;
+          if (auto index = indices.find(neighbor); index != indices.end()) {
+            blocks = &chunks[index->second];
+          } else if (column != firstSurfaceChunks.end() && neighbor.y >= 0 && neighbor.y < column->second) {
+            blocks = &solidBlocks;
+          }
+          neighbors[dx + 1][dy + 1][dz + 1] = blocks;
+        }
+      }
+    }
+
+    snapshot->fill(neighbors);
+    auto mesh = ChunkMesher(*snapshot, mode, lodLevel).build();
+    ChunkConnectivity connectivity(*snapshot);
+
+    result.quads += mesh.stats.quads;
+    result.vertexBytes += mesh.vertices.size() * sizeof(uint32_t);
+    result.indexBytes += mesh.indices.size() * sizeof(uint32_t);
+  }
+  result.meshSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  result.meshAllocations = allocationCount.load() - allocationsBefore;
+  return result;
+}
+
+void runScenarios(int chunkCount) {
+  struct Scenario {
+    const char *name;
+    TerrainType type;
+  };
+  const Scenario scenarios[] = {
+    {"flat", TerrainType::Flat},
+    {"hills", TerrainType::Hills},
+    {"checkerboard", TerrainType::Checkerboard}
+  };
+
+  std::cout << "At least " << chunkCount << " chunks per scenario, seed " << SEED << std::endl;
+  std::cout << std::left << std::setw(14) << "scenario" << std::setw(8) << "mesher" << std::right
+            << std::setw(12) << "chunks" << std::setw(12) << "skipped" << std::setw(12) << "gen/s" << std::setw(12) << "mesh/s" << std::setw(12) << "quads"
+            << std::setw(12) << "vert KiB" << std::setw(12) << "index KiB" << std::setw(12) << "block KiB"
+            << std::setw(12) << "gen allocs" << std::setw(12) << "mesh allocs" << std::endl;
+
+  auto precision = std::cout.precision();
+  std::vector<double> greedyRatios;
+  for (const auto &scenario : scenarios) {
+    size_t naiveQuads = 0;
+    for (auto mode : {MeshingMode::Naive, MeshingMode::Greedy}) {
+      auto result = runScenario(scenario.type, mode, chunkCount);
+      if (mode == MeshingMode::Naive) {
+        naiveQuads = result.quads;
+      } else {
+        greedyRatios.push_back(naiveQuads > 0 ? 100.0 * result.quads / naiveQuads : 100.0);
+      }
+      std::cout << std::left << std::setw(14) << scenario.name << std::setw(8)
+                << (mode == MeshingMode::Naive ? "naive" : "greedy") << std::right << std::fixed
+                << std::setprecision(0) << std::setw(12) << result.chunks << std::setw(12)
+                << result.skippedChunks << std::setw(12) << result.chunks / result.generateSeconds << std::setw(12)
+                << result.chunks / result.meshSeconds << std::setw(12) << result.quads << std::setw(12)
+                << result.vertexBytes / 1024 << std::setw(12) << result.indexBytes / 1024 << std::setw(12)
+                << result.blockBytes / 1024 << std::setw(12) << result.generateAllocations << std::setw(12)
+                << result.meshAllocations << std::defaultfloat << std::setprecision(precision) << std::endl;
+    }
+  }
+
+  std::cout << "greedy quads as a share of naive ones:";
+  for (size_t i = 0; i < greedyRatios.size(); ++i) {
+    std::cout << (i > 0 ? "," : "") << " " << scenarios[i].name << " " << std::fixed << std::setprecision(1)
+              << greedyRatios[i] << "%" << std::defaultfloat << std::setprecision(precision);
+  }
+  std::cout << std::endl << std::endl;
+}
+
+// Walks a chunk away from the camera out to the eviction ring and back for several render radii. Returns how
+// many levels were never chosen on the way out, plus one for each walk that did not end back at level 0.
+size_t countUnreachedLodLevels() {
+  size_t unreached = 0;
+  for (auto radius: {4, 8, 16, 32}) {
+    bool reached[LOD_LEVEL_COUNT] = {};
+    auto level = 0;
+    auto steps = (radius + 1) * 10;
+    for (auto step = 0; step <= steps; ++step) {
+      level = chooseLodLevel(level, static_cast<float>(step) * 0.1f, radius);
+      reached[level] = true;
+    }
+    for (auto step = steps; step >= 0; --step) {
+      level = chooseLodLevel(level, static_cast<float>(step) * 0.1f, radius);
+    }
+    unreached += std::count(std::begin(reached), std::end(reached), false) + (level != 0);
+  }
+  return unreached;
+}
+
+// Hills terrain meshed whole at every level of detail, as a ring of distant chunks would be
+size_t runLodLevels(int chunkCount) {
+  std::cout << std::left << std::setw(14) << "hills LOD" << std::right << std::setw(12) << "chunks"
+            << std::setw(12) << "mesh/s" << std::setw(12) << "triangles" << std::setw(12) << "vert KiB"
+            << std::setw(12) << "index KiB" << std::endl;
+
+  auto precision = std::cout.precision();
+  for (auto level = 0; level < LOD_LEVEL_COUNT; ++level) {
+    auto result = runScenario(TerrainType::Hills, MeshingMode::Greedy, chunkCount, level);
+    std::cout << std::left << std::setw(14) << std::to_string(1 << level) + "x" << std::right << std::fixed
+              << std::setprecision(0) << std::setw(12) << result.chunks << std::setw(12)
+              << result.chunks / result.meshSeconds << std::setw(12) << result.quads * 2 << std::setw(12)
+              << result.vertexBytes / 1024 << std::setw(12) << result.indexBytes / 1024 << std::defaultfloat
+              << std::setprecision(precision) << std::endl;
+  }
+
+  auto unreached = countUnreachedLodLevels();
+  std::cout << "LOD levels never chosen within a render radius: " << unreached << std::endl << std::endl;
+  return unreached;
+}
+
+// Encodes and decodes every chunk of each terrain type WIRE_ROUNDS times. Sizes are compared against the
+// dense array and against shipping BlockStorage's palette and packed words as they are. Returns how many
+// chunks or change batches did not survive the round trip.
+size_t runWireFormat(int chunkCount) {
+  struct Scenario {
+    const char *name;
+    TerrainType type;
+  };
+  const Scenario scenarios[] = {
+    {"flat", TerrainType::Flat},
+    {"hills", TerrainType::Hills},
+    {"checkerboard", TerrainType::Checkerboard}
+  };
+
+  std::cout << std::left << std::setw(14) << "wire format" << std::right << std::setw(12) << "dense KiB"
+            << std::setw(12) << "packed KiB" << std::setw(12) << "wire KiB" << std::setw(12) << "ratio"
+            << std::setw(12) << "enc MiB/s" << std::setw(12) << "dec MiB/s" << std::endl;
+
+  size_t failures = 0;
+  auto precision = std::cout.precision();
+  for (const auto &scenario : scenarios) {
+    TerrainGenerator terrain(SEED, scenario.type);
+    std::vector<BlockStorage> chunks(chunkCount);
+    size_t packedBytes = 0;
+    for (auto i = 0; i < chunkCount; ++i) {
+      terrain.generate(surfaceChunk(terrain, i / 32, i % 32), chunks[i]);
+      packedBytes += chunks[i].getPalette().size() * sizeof(BlockId) + chunks[i].getWords().size() * sizeof(uint64_t);
+    }
+
+    std::vector<uint8_t> encoded;
+    ByteWriter writer(encoded);
+    auto start = std::chrono::steady_clock::now();
+    for (auto round = 0; round < WIRE_ROUNDS; ++round) {
+      encoded.clear();
+      for (const auto &blocks : chunks) {
+        encodeBlocks(writer, blocks);
+      }
+    }
+    auto encodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<BlockStorage> decoded(chunkCount);
+    start = std::chrono::steady_clock::now();
+    for (auto round = 0; round < WIRE_ROUNDS; ++round) {
+      ByteReader reader(encoded.data(), encoded.size());
+      for (auto &blocks : decoded) {
+        decodeBlocks(reader, blocks);
+      }
+    }
+    auto decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (auto i = 0; i < chunkCount; ++i) {
+      for (auto index = 0; index < CHUNK_VOLUME; ++index) {
+        if (decoded[i].get(index) != chunks[i].get(index)) {
+          ++failures;
+          break;
+        }
+      }
+    }
+
+    // Throughput counts the dense size, the work a chunk represents regardless of how well it compresses
+    auto denseBytes = static_cast<double>(chunkCount) * CHUNK_VOLUME * sizeof(BlockId);
+    auto megabytes = denseBytes * WIRE_ROUNDS / (1024 * 1024);
+    std::cout << std::left << std::setw(14) << scenario.name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(12) << denseBytes / 1024 << std::setw(12) << packedBytes / 1024.0 << std::setw(12)
+              << encoded.size() / 1024.0 << std::setprecision(1) << std::setw(11) << denseBytes / encoded.size()
+              << "x" << std::setprecision(0) << std::setw(12) << megabytes / encodeSeconds << std::setw(12)
+              << megabytes / decodeSeconds << std::defaultfloat << std::setprecision(precision) << std::endl;
+  }
+
+  // Batches of scattered edits, as a busy chunk would send them in one tick
+  std::vector<std::vector<BlockChange>> batches(chunkCount);
+  uint32_t state = SEED;
+  for (auto &batch : batches) {
+    for (auto i = 0; i < CHANGES_PER_BATCH; ++i) {
+      state = state * 1664525u + 1013904223u;
+      batch.push_back({static_cast<uint16_t>((state >> 8) % CHUNK_VOLUME), static_cast<BlockId>(state >> 28)});
+    }
+    coalesceBlockChanges(batch);
+  }
+
+  std::vector<uint8_t> encoded;
+  ByteWriter writer(encoded);
+  size_t changes = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &batch : batches) {
+    encodeBlockChanges(writer, batch);
+    changes += batch.size();
+  }
+  auto encodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  ByteReader reader(encoded.data(), encoded.size());
+  std::vector<std::vector<BlockChange>> decoded(chunkCount);
+  start = std::chrono::steady_clock::now();
+  for (auto &batch : decoded) {
+    decodeBlockChanges(reader, batch);
+  }
+  auto decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  auto sameChange = [](const BlockChange &a, const BlockChange &b) {
+    return a.index == b.index && a.block == b.block;
+  };
+  for (auto i = 0; i < chunkCount; ++i) {
+    failures += !std::equal(decoded[i].begin(), decoded[i].end(), batches[i].begin(), batches[i].end(), sameChange);
+  }
+
+  // One block rewritten with more ids than the chunk has blocks: the palette has to keep to what the chunk
+  // holds, or the codec refuses the chunk
+  BlockStorage edited;
+  TerrainGenerator(SEED).generate(surfaceChunk(TerrainGenerator(SEED), 0, 0), edited);
+  for (auto round = 0; round < REPEATED_EDITS; ++round) {
+    edited.set(round % CHUNK_VOLUME, static_cast<BlockId>(round % (CHUNK_VOLUME + 7)));
+  }
+  std::vector<uint8_t> editedEncoded;
+  ByteWriter editedWriter(editedEncoded);
+  encodeBlocks(editedWriter, edited);
+  ByteReader editedReader(editedEncoded.data(), editedEncoded.size());
+  BlockStorage editedDecoded;
+  auto editedMatches = decodeBlocks(editedReader, editedDecoded);
+  for (auto index = 0; editedMatches && index < CHUNK_VOLUME; ++index) {
+    editedMatches = editedDecoded.get(index) == edited.get(index);
+  }
+  failures += !editedMatches;
+
+  std::cout << "block changes: " << static_cast<double>(encoded.size()) / changes << " bytes/change, "
+            << changes / encodeSeconds / 1e6 << "M changes/s encoded, " << changes / decodeSeconds / 1e6
+            << "M changes/s decoded" << std::endl;
+  std::cout << "repeated edits: palette of " << edited.getPaletteSize() << " after " << REPEATED_EDITS
+            << " edits, round trip " << (editedMatches ? "ok" : "failed") << std::endl;
+  std::cout << "wire format round-trip failures: " << failures << std::endl << std::endl;
+  return failures;
+}
+
+// Players walking, sprinting and jumping over hills terrain around the origin, all stepped together as a
+// server tick would step them. Terrain outside the generated columns is solid, as unloaded terrain is.
+void runPhysics() {
+  TerrainGenerator terrain(SEED);
+  std::unordered_map<ChunkPos, BlockStorage, ChunkPosHash> chunks;
+  std::unordered_map<ColumnPos, int, ColumnPosHash> lastSurfaceChunks;
+  std::unordered_map<ColumnPos, HeightMap, ColumnPosHash> heightMaps;
+  for (auto x = -PHYSICS_RADIUS_COLUMNS; x < PHYSICS_RADIUS_COLUMNS; ++x) {
+    for (auto z = -PHYSICS_RADIUS_COLUMNS; z < PHYSICS_RADIUS_COLUMNS; ++z) {
+      auto &map = heightMaps[{x, z}];
+      terrain.getHeightMap({x, z}, map);
+      lastSurfaceChunks[{x, z}] = map.getLastSurfaceChunk();
+      for (auto y = 0; y <= map.getLastSurfaceChunk(); ++y) {
+        terrain.generate({x, y, z}, map, chunks[{x, y, z}]);
+      }
+    }
+  }
+
+  uint64_t queries = 0;
+  SolidBlockQuery isSolid = [&](glm::ivec3 block) {
+    ++queries;
+    if (block.y < 0) {
+      return true;
+    }
+    auto position = chunkContaining(block);
+    auto column = lastSurfaceChunks.find(columnOf(position));
+    if (column == lastSurfaceChunks.end()) {
+      return true;
+    }
+    if (position.y > column->second) {
+      return false;
+    }
+    auto local = block - position * CHUNK_SIZE;
+    return chunks.at(position).get(BlockStorage::index(local.x, local.y, local.z)) != 0;
+  };
+
+  std::mt19937 random(SEED);
+  std::uniform_int_distribution<int> spread(-PHYSICS_RADIUS_COLUMNS * CHUNK_SIZE,
+                                            PHYSICS_RADIUS_COLUMNS * CHUNK_SIZE - 1);
+  std::vector<PlayerState> players;
+  std::vector<PlayerInput> inputs(PHYSICS_PLAYERS);
+  for (auto i = 0; i < PHYSICS_PLAYERS; ++i) {
+    glm::ivec3 block(spread(random), 0, spread(random));
+    auto position = chunkContaining(block);
+    auto local = block - position * CHUNK_SIZE;
+    auto surface = heightMaps[columnOf(position)].get(local.x, local.z);
+    players.push_back({glm::vec3(block) + glm::vec3(0.5f, static_cast<float>(surface) + 2.0f, 0.5f), glm::vec3(0.0f),
+                       false});
+  }
+
+  uint64_t steps = 0;
+  uint64_t grounded = 0;
+  auto allocationsBefore = allocationCount.load();
+  auto start = std::chrono::steady_clock::now();
+  for (auto step = 0; step < PHYSICS_STEPS; ++step) {
+    if (step % PHYSICS_INPUT_STEPS == 0) {
+      for (auto &input : inputs) {
+        input.buttons = static_cast<uint8_t>(random() & (INPUT_FORWARD | INPUT_LEFT | INPUT_SPRINT | INPUT_JUMP));
+        input.yaw = std::uniform_real_distribution<float>(-180.0f, 180.0f)(random);
+      }
+    }
+    for (auto i = 0; i < PHYSICS_PLAYERS; ++i) {
+      players[i] = simulateMovement(players[i], inputs[i], isSolid);
+      grounded += players[i].onGround;
+    }
+    steps += PHYSICS_PLAYERS;
+  }
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  auto allocations = allocationCount.load() - allocationsBefore;
+
+  std::cout << "physics: " << PHYSICS_PLAYERS << " players, " << seconds * 1e6 / static_cast<double>(steps)
+            << " us/step, " << static_cast<double>(queries) / static_cast<double>(steps) << " blocks queried/step, "
+            << 100.0 * static_cast<double>(grounded) / static_cast<double>(steps) << "% of steps on the ground, "
+            << allocations << " allocations" << std::endl << std::endl;
+}
+
+// Hills terrain around the origin with only its surface chunks, as the world keeps them
+struct LightRegion {
+  struct LitChunk {
+    BlockStorage blocks;
+    ChunkLight light;
+  };
+
+  std::unordered_map<ChunkPos, LitChunk, ChunkPosHash> chunks;
+  std::unordered_map<ColumnPos, HeightMap, ColumnPosHash> heightMaps;
+
+  // Columns outside the region are unloaded and dark
+  LightChunk lookup(ChunkPos position) {
+    if (position.y >= WORLD_HEIGHT_CHUNKS) {
+      return {nullptr, nullptr, true};
+    }
+    auto map = heightMaps.find(columnOf(position));
+    if (position.y < 0 || map == heightMaps.end()) {
+      return {};
+    }
+    if (auto chunk = chunks.find(position); chunk != chunks.end()) {
+      return {&chunk->second.blocks, &chunk->second.light, false};
+    }
+    return {nullptr, nullptr, position.y >= map->second.getFirstSurfaceChunk()};
+  }
+
+  // Lights every chunk from scratch, the way columns are lit as they load
+  void relight() {
+    LightEngine engine([this](ChunkPos position) { return lookup(position); });
+    for (auto &[position, chunk]: chunks) {
+      chunk.light.fill(position.y >= heightMaps[columnOf(position)].getFirstSurfaceChunk() ? FULL_SKY_LIGHT : 0);
+    }
+    for (auto &[position, chunk]: chunks) {
+      engine.addChunk(position, position.y >= heightMaps[columnOf(position)].getFirstSurfaceChunk());
+    }
+    engine.propagate();
+  }
+};
+
+// Edits near the surface of a lit region: lamps placed and taken away, holes dug and blocks stacked. Each
+// edit is propagated on its own, as a frame with one edit would be, and the result is checked against
+// lighting the edited region from scratch.
+size_t runLighting() {
+  TerrainGenerator terrain(SEED);
+  LightRegion region;
+  for (auto x = -LIGHT_RADIUS_COLUMNS; x < LIGHT_RADIUS_COLUMNS; ++x) {
+    for (auto z = -LIGHT_RADIUS_COLUMNS; z < LIGHT_RADIUS_COLUMNS; ++z) {
+      auto &map = region.heightMaps[{x, z}];
+      terrain.getHeightMap({x, z}, map);
+      for (auto y = map.getFirstSurfaceChunk(); y <= map.getLastSurfaceChunk(); ++y) {
+        terrain.generate({x, y, z}, map, region.chunks[{x, y, z}].blocks);
+      }
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  region.relight();
+  auto relightSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  LightEngine engine([&region](ChunkPos position) { return region.lookup(position); });
+  std::mt19937 random(SEED);
+  std::uniform_int_distribution<int> spread(-LIGHT_RADIUS_COLUMNS * CHUNK_SIZE, LIGHT_RADIUS_COLUMNS * CHUNK_SIZE - 1);
+  std::vector<glm::ivec3> lamps;
+  std::vector<ChunkPos> dirty;
+  std::vector<double> editMicroseconds;
+  size_t dirtyChunks = 0;
+
+  for (auto i = 0; i < LIGHT_EDITS; ++i) {
+    glm::ivec3 block(spread(random), 0, spread(random));
+    auto column = columnOf(chunkContaining(block));
+    auto surface = region.heightMaps[column].get(floorMod(block.x, CHUNK_SIZE), floorMod(block.z, CHUNK_SIZE));
+    auto action = random() % 4;
+    BlockId value = 0;
+    if (action == 0 && !lamps.empty()) {
+      block = lamps.back();
+      lamps.pop_back();
+    } else if (action <= 1) {
+      // Lamps go a few blocks into the ground as often as on top of it
+      block.y = surface - static_cast<int>(random() % 4);
+      value = LAMP_BLOCK;
+      lamps.push_back(block);
+    } else if (action == 2) {
+      block.y = surface - 1 - static_cast<int>(random() % 6);
+    } else {
+      block.y = surface;
+      value = TERRAIN_BLOCK;
+    }
+
+    auto chunk = region.chunks.find(chunkContaining(block));
+    if (chunk == region.chunks.end()) {
+      continue;
+    }
+    auto local = block - chunk->first * CHUNK_SIZE;
+    chunk->second.blocks.set(BlockStorage::index(local.x, local.y, local.z), value);
+
+    auto editStart = std::chrono::steady_clock::now();
+    engine.changeBlock(block);
+    engine.propagate();
+    engine.takeDirtyChunks(dirty);
+    editMicroseconds.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() -
+                                                                         editStart).count());
+    dirtyChunks += dirty.size();
+  }
+
+  std::unordered_map<ChunkPos, ChunkLight, ChunkPosHash> incremental;
+  for (const auto &[position, chunk]: region.chunks) {
+    incremental[position] = chunk.light;
+  }
+  region.relight();
+  size_t mismatches = 0;
+  for (const auto &[position, chunk]: region.chunks) {
+    for (auto index = 0; index < CHUNK_VOLUME; ++index) {
+      mismatches += chunk.light.values[index] != incremental[position].values[index];
+    }
+  }
+
+  // Most edits stay local; opening or closing a shaft to the sky relights the whole column below it
+  const auto &stats = engine.getStats();
+  auto edits = static_cast<double>(std::max(editMicroseconds.size(), size_t(1)));
+  auto totalMicroseconds = 0.0;
+  for (auto microseconds: editMicroseconds) {
+    totalMicroseconds += microseconds;
+  }
+  std::sort(editMicroseconds.begin(), editMicroseconds.end());
+  std::cout << "lighting: " << region.chunks.size() << " chunks lit in " << relightSeconds * 1e3 << " ms, "
+            << editMicroseconds.size() << " edits" << std::endl;
+  std::cout << "light edits: " << totalMicroseconds / edits << " us mean, "
+            << (editMicroseconds.empty() ? 0.0 : editMicroseconds[editMicroseconds.size() / 2]) << " us median, "
+            << (editMicroseconds.empty() ? 0.0 : editMicroseconds.back()) << " us worst, "
+            << static_cast<double>(stats.visited) / edits << " blocks visited/edit, "
+            << static_cast<double>(dirtyChunks) / edits << " chunks remeshed/edit" << std::endl;
+  std::cout << "incremental light mismatches against a full relight: " << mismatches << std::endl << std::endl;
+  return mismatches;
+}
+
+// Jobs queued with shuffled priorities while every worker is held busy, then released. Each job records
+// when it started. Submits go round-robin over the worker queues and each queue only gives up its best job,
+// so jobs that shared a queue start in priority order, give or take the workers racing to run what they
+// popped. Across queues the order is only approximate; the mean distance from the ideal start is reported.
+// Returns how many jobs started out of order within their queue.
+size_t runJobOrdering() {
+  JobSystem jobs(ORDERING_WORKERS);
+  std::atomic<unsigned> blocked = 0;
+  std::atomic<bool> released = false;
+  for (auto i = 0u; i < ORDERING_WORKERS; ++i) {
+    jobs.submit(INT32_MIN, [&] {
+      ++blocked;
+      released.wait(false);
+    });
+  }
+  while (blocked.load() < ORDERING_WORKERS) {
+    std::this_thread::yield();
+  }
+
+  std::vector<int> priorities(ORDERING_JOBS);
+  std::iota(priorities.begin(), priorities.end(), 0);
+  std::shuffle(priorities.begin(), priorities.end(), std::mt19937(SEED));
+  std::atomic<int> nextStart = 0;
+  std::vector<int> starts(ORDERING_JOBS);
+  for (auto priority: priorities) {
+    jobs.submit(priority, [&starts, &nextStart, priority] {
+      starts[priority] = nextStart++;
+      auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(ORDERING_JOB_MICROSECONDS);
+      while (std::chrono::steady_clock::now() < until) {
+      }
+    });
+  }
+  released = true;
+  released.notify_all();
+  while (jobs.getPendingCount() > 0 || nextStart.load() < ORDERING_JOBS) {
+    std::this_thread::yield();
+  }
+
+  // The blockers took one submit per queue, so the i-th job submitted here went to queue i % workers
+  std::vector<int> queues(ORDERING_JOBS);
+  for (auto i = 0; i < ORDERING_JOBS; ++i) {
+    queues[priorities[i]] = i % ORDERING_WORKERS;
+  }
+  std::vector<std::vector<int>> queueStarts(ORDERING_WORKERS);
+  double displacement = 0;
+  for (auto priority = 0; priority < ORDERING_JOBS; ++priority) {
+    queueStarts[queues[priority]].push_back(starts[priority]);
+    displacement += std::abs(starts[priority] - priority);
+  }
+
+  size_t outOfOrder = 0;
+  for (const auto &byPriority: queueStarts) {
+    auto sorted = byPriority;
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t place = 0; place < byPriority.size(); ++place) {
+      auto startPlace = std::lower_bound(sorted.begin(), sorted.end(), byPriority[place]) - sorted.begin();
+      outOfOrder += std::abs(startPlace - static_cast<std::ptrdiff_t>(place)) >
+                    static_cast<std::ptrdiff_t>(ORDERING_WORKERS);
+    }
+  }
+  std::cout << "job ordering: " << ORDERING_JOBS << " jobs on " << ORDERING_WORKERS << " workers, "
+            << displacement / ORDERING_JOBS << " places from priority order on average, " << outOfOrder
+            << " started out of order within their queue" << std::endl << std::endl;
+  return outOfOrder;
+}
+
+// Usage: netblocks_bench [chunk count]
+int main(int argc, char **argv) {
+  auto chunkCount = argc > 1 ? std::max(std::atoi(argv[1]), 1) : DEFAULT_CHUNK_COUNT;
+  runScenarios(chunkCount);
+  auto unreachedLodLevels = runLodLevels(chunkCount);
+  auto wireFailures = runWireFormat(chunkCount);
+  runPhysics();
+  auto lightMismatches = runLighting();
+  auto jobsOutOfOrder = runJobOrdering();
+
+  auto snapshot = std::make_unique<ChunkSnapshot>();
+  generateSnapshot(*snapshot);
+  MeshData legacyMesh;
+  auto before = measure("legacy (per-voxel isSolid, 27-sample AO)", [&] {
+    return buildLegacyMesh(*snapshot, legacyMesh);
+  });
+
+  auto after = measure("naive (face masks, corner AO)", [&] {
+    return ChunkMesher(*snapshot, MeshingMode::Naive).build().stats.quads;
+  });
+
+  measure("greedy (face masks, corner AO)", [&] {
+    return ChunkMesher(*snapshot, MeshingMode::Greedy).build().stats.quads;
+  });
+  auto shadingMismatches = countGreedyShadingMismatches(*snapshot);
+  std::cout << "greedy faces shaded differently from naive ones: " << shadingMismatches << std::endl;
+
+  std::cout << "speedup: " << before / after << "x" << std::endl;
+
+  float noise[CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE];
+  auto scalar = measureNoise("scalar 2D terrain noise", [&noise](int chunk) {
+    for (auto x = 0; x < CHUNK_SIZE; ++x) {
+      for (auto z = 0; z < CHUNK_SIZE; ++z) {
+        noise[x * CHUNK_SIZE + z] = fractalNoise2(static_cast<float>(chunk * CHUNK_SIZE + x) * NOISE_SCALE,
+                                                  static_cast<float>(z) * NOISE_SCALE, SEED, TERRAIN_NOISE);
+      }
+    }
+  });
+  auto batched = measureNoise("batched 2D terrain noise", [&noise](int chunk) {
+    fractalNoiseGrid2(glm::vec2(chunk * CHUNK_SIZE, 0) * NOISE_SCALE, NOISE_SCALE, CHUNK_SIZE, CHUNK_SIZE, SEED,
+                      TERRAIN_NOISE, noise);
+  });
+  std::cout << "noise speedup: " << scalar / batched << "x" << std::endl;
+
+  measureNoise("batched 3D noise", [&noise](int chunk) {
+    fractalNoiseGrid3(glm::vec3(chunk * CHUNK_SIZE, 0, 0) * NOISE_SCALE, NOISE_SCALE, glm::ivec3(CHUNK_SIZE), SEED,
+                      TERRAIN_NOISE, noise);
+  });
+
+  auto mismatches = countNoiseMismatches();
+  std::cout << "batched noise mismatches against scalar reference: " << mismatches << std::endl;
+  return mismatches == 0 && wireFailures == 0 && lightMismatches == 0 &&
+         unreachedLodLevels == 0 && jobsOutOfOrder <= ORDERING_STRAGGLERS && shadingMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,291 @@
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "Protocol.hpp"
+
+// Simulates one server and two clients over links with latency, jitter and loss, without sockets or real
+// time: client A moves with prediction, client B watches A through interpolation. Every message still goes
+// through the protocol's encoding. A walks, jumps and falls on a floor dotted with pillars, which both sides
+// collide with the same way.
+
+constexpr double DEFAULT_RTT_MS = 150.0;
+constexpr double DEFAULT_JITTER_MS = 30.0;
+constexpr double DEFAULT_LOSS_PERCENT = 2.0;
+constexpr double DEFAULT_DURATION_SECONDS = 20.0;
+
+constexpr double STEP_MS = 1.0;
+constexpr double FRAME_MS = 1000.0 / 60.0;
+constexpr double SERVER_TICK_MS = 1000.0 / SERVER_TICK_RATE;
+
+// A changes what it is doing this often, and stands still for the last second so everything settles
+constexpr double INPUT_CHANGE_MS = 400.0;
+constexpr double SETTLE_MS = 1000.0;
+
+// Halfway through, the server moves A on its own, as a teleport would
+constexpr float OVERRIDE_HEIGHT = 8.0f;
+
+constexpr int FLOOR_HEIGHT = 64;
+constexpr int PILLAR_SPACING = 8;
+constexpr int PILLAR_HEIGHT = 2;
+
+constexpr float AGREEMENT_TOLERANCE = 1e-4f;
+
+struct Packet {
+  double deliverAt;
+  std::vector<uint8_t> bytes;
+};
+
+// One direction of a connection. Reliable links deliver in order, like TCP; the others drop packets and
+// let jitter reorder them, like UDP.
+class SimulatedLink {
+public:
+  SimulatedLink(double rttMs, double jitterMs, double lossPercent, bool reliable, std::mt19937 &random)
+    : latency(rttMs / 2.0), jitter(jitterMs), loss(reliable ? 0.0 : lossPercent / 100.0), reliable(reliable),
+      random(random) {
+  }
+
+  void send(double now, std::vector<uint8_t> bytes) {
+    if (std::uniform_real_distribution<double>(0.0, 1.0)(random) < loss) {
+      ++dropped;
+      return;
+    }
+
+    auto deliverAt = now + latency + std::uniform_real_distribution<double>(0.0, jitter)(random);
+    if (reliable) {
+      deliverAt = std::max(deliverAt, lastDelivery);
+      lastDelivery = deliverAt;
+    }
+    packets.push_back({deliverAt, std::move(bytes)});
+  }
+
+  // Returns false when nothing is due yet
+  bool receive(double now, std::vector<uint8_t> &bytes) {
+    auto due = std::find_if(packets.begin(), packets.end(), [now](const Packet &packet) {
+      return packet.deliverAt <= now;
+    });
+    if (due == packets.end()) {
+      return false;
+    }
+
+    bytes = std::move(due->bytes);
+    packets.erase(due);
+    return true;
+  }
+
+  [[nodiscard]] uint64_t getDropped() const {
+    return dropped;
+  }
+
+private:
+  double latency;
+  double jitter;
+  double loss;
+  bool reliable;
+  std::mt19937 &random;
+  std::deque<Packet> packets;
+  double lastDelivery = 0.0;
+  uint64_t dropped = 0;
+};
+
+bool isSolid(glm::ivec3 block) {
+  auto pillar = (block.x & (PILLAR_SPACING - 1)) == 0 && (block.z & (PILLAR_SPACING - 1)) == 0;
+  return block.y < FLOOR_HEIGHT || (pillar && block.y < FLOOR_HEIGHT + PILLAR_HEIGHT);
+}
+
+bool readFramed(const std::vector<uint8_t> &bytes, PlayerStatesMessage &message) {
+  ByteReader reader(bytes.data(), bytes.size());
+  reader.readU32();
+  return static_cast<MessageType>(reader.readU8()) == MessageType::PlayerStates && readPlayerStates(reader, message);
+}
+
+int main(int argc, char **argv) {
+  auto rtt = argc > 1 ? std::atof(argv[1]) : DEFAULT_RTT_MS;
+  auto jitter = argc > 2 ? std::atof(argv[2]) : DEFAULT_JITTER_MS;
+  auto loss = argc > 3 ? std::atof(argv[3]) : DEFAULT_LOSS_PERCENT;
+  auto duration = (argc > 4 ? std::atof(argv[4]) : DEFAULT_DURATION_SECONDS) * 1000.0;
+  if (rtt < 0 || jitter < 0 || loss < 0 || loss >= 100 || duration <= SETTLE_MS) {
+    std::cerr << "Usage: netblocks_prediction [rtt ms] [jitter ms] [loss %] [seconds]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "RTT " << rtt << " ms, jitter " << jitter << " ms, " << loss << "% loss, " << duration / 1000.0
+            << " s" << std::endl;
+
+  std::mt19937 random(42);
+  SimulatedLink inputsToServer(rtt, jitter, loss, false, random);
+  SimulatedLink statesToA(rtt, jitter, loss, true, random);
+  SimulatedLink statesToB(rtt, jitter, loss, true, random);
+
+  constexpr uint32_t ID_A = 2;
+  constexpr uint32_t TOKEN_A = 0x5eed;
+  const PlayerState spawn{{0.5f, FLOOR_HEIGHT + 10.0f, 0.5f}, glm::vec3(0.0f), false};
+
+  // Server
+  PlayerState serverState = spawn;
+  InputQueue serverInputs;
+  float serverYaw = 0.0f;
+  uint32_t serverTick = 0;
+  double nextServerTick = SERVER_TICK_MS;
+  // A's authoritative position after every tick, to check what B shows against
+  std::vector<glm::vec3> positionsByTick{spawn.position};
+  auto overrideTick = static_cast<uint32_t>(duration / 2.0 / SERVER_TICK_MS);
+
+  // Client A
+  MovementPredictor predictor(isSolid, spawn);
+  double nextStep = 0.0;
+  uint8_t buttons = 0;
+  float yaw = 0.0f;
+  double nextInputChange = 0.0;
+  std::vector<PlayerInput> recentInputs;
+  // When each input that changed the buttons was made, to time how long the server takes to confirm it
+  std::deque<std::pair<uint32_t, double>> pendingChanges;
+  double confirmTotal = 0.0;
+  double confirmWorst = 0.0;
+  uint64_t confirmCount = 0;
+  float correctionBeforeOverride = 0.0f;
+
+  // Client B
+  RemotePlayers remote;
+  double nextFrame = 0.0;
+  std::vector<RemotePlayer> sampled;
+  double interpolationErrorTotal = 0.0;
+  float interpolationErrorWorst = 0.0f;
+  double displayDelayTotal = 0.0;
+  uint64_t samples = 0;
+
+  std::vector<uint8_t> bytes;
+  for (double now = 0.0; now < duration; now += STEP_MS) {
+    // Client A: a new input every movement step, applied at once and sent with the ones before it
+    if (now >= nextInputChange) {
+      nextInputChange += INPUT_CHANGE_MS;
+      auto settling = now >= duration - SETTLE_MS;
+      buttons = settling ? 0 : static_cast<uint8_t>(random() & (INPUT_FORWARD | INPUT_LEFT | INPUT_SPRINT | INPUT_JUMP));
+      yaw = std::uniform_real_distribution<float>(-180.0f, 180.0f)(random);
+    }
+    while (now >= nextStep) {
+      nextStep += MOVEMENT_TICK_SECONDS * 1000.0;
+      auto previousButtons = recentInputs.empty() ? uint8_t(0) : recentInputs.back().buttons;
+      auto input = predictor.predict(buttons, yaw, 0.0f);
+      if (input.buttons != previousButtons) {
+        pendingChanges.emplace_back(input.sequence, now);
+      }
+
+      predictor.getRecentInputs(INPUTS_PER_DATAGRAM, recentInputs);
+      PlayerInputMessage message{TOKEN_A, recentInputs};
+      std::vector<uint8_t> datagram;
+      writePlayerInput(datagram, message);
+      inputsToServer.send(now, std::move(datagram));
+    }
+
+    // Server: queue whatever arrived, apply it on the tick and tell both clients
+    while (inputsToServer.receive(now, bytes)) {
+      ByteReader reader(bytes.data(), bytes.size());
+      PlayerInputMessage message{};
+      if (static_cast<MessageType>(reader.readU8()) != MessageType::PlayerInput || !readPlayerInput(reader, message) ||
+          message.token != TOKEN_A) {
+        std::cerr << "Server could not read an input datagram" << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (const auto &input: message.inputs) {
+        serverInputs.push(input);
+      }
+      if (!message.inputs.empty()) {
+        serverYaw = message.inputs.back().yaw;
+      }
+    }
+    if (now >= nextServerTick) {
+      nextServerTick += SERVER_TICK_MS;
+      ++serverTick;
+      serverInputs.apply(serverState, MAX_INPUTS_PER_SERVER_TICK, isSolid);
+      if (serverTick == overrideTick) {
+        serverState.position.y += OVERRIDE_HEIGHT;
+      }
+      positionsByTick.push_back(serverState.position);
+
+      std::vector<uint8_t> toA;
+      writePlayerStates(toA, {serverTick, serverInputs.getLastApplied(), serverState, {}, {}});
+      statesToA.send(now, std::move(toA));
+
+      // B's own state is not simulated; only A matters to it
+      std::vector<uint8_t> toB;
+      writePlayerStates(toB, {serverTick, 0, spawn, {{ID_A, serverState.position, serverYaw}}, {}});
+      statesToB.send(now, std::move(toB));
+    }
+
+    // Client A: reconcile with every state that arrived
+    while (statesToA.receive(now, bytes)) {
+      PlayerStatesMessage message{};
+      if (!readFramed(bytes, message)) {
+        std::cerr << "Client A could not read a state message" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      predictor.reconcile(message.lastInput, message.state);
+      if (message.tick < overrideTick) {
+        correctionBeforeOverride = std::max(correctionBeforeOverride, predictor.getStats().maxCorrection);
+      }
+      while (!pendingChanges.empty() && static_cast<int32_t>(message.lastInput - pendingChanges.front().first) >= 0) {
+        auto confirmed = now - pendingChanges.front().second;
+        confirmTotal += confirmed;
+        confirmWorst = std::max(confirmWorst, confirmed);
+        ++confirmCount;
+        pendingChanges.pop_front();
+      }
+    }
+
+    // Client B: play A back and compare with where the server had it at the same tick
+    while (statesToB.receive(now, bytes)) {
+      PlayerStatesMessage message{};
+      if (!readFramed(bytes, message)) {
+        std::cerr << "Client B could not read a state message" << std::endl;
+        return EXIT_FAILURE;
+      }
+      remote.addSnapshot(message.tick, message.players, message.removed);
+    }
+    remote.advance(STEP_MS / 1000.0, SERVER_TICK_RATE);
+    if (now >= nextFrame) {
+      nextFrame += FRAME_MS;
+      remote.sample(sampled);
+
+      auto playback = remote.getPlaybackTick();
+      if (!sampled.empty() && playback >= 0.0 && playback + 1.0 < static_cast<double>(positionsByTick.size())) {
+        auto tick = static_cast<size_t>(playback);
+        auto truth = glm::mix(positionsByTick[tick], positionsByTick[tick + 1], static_cast<float>(playback - tick));
+        // The override is a jump, so the frames playing it back are not interpolation errors
+        if (tick + 1 != overrideTick) {
+          auto error = glm::distance(sampled.front().position, truth);
+          interpolationErrorTotal += error;
+          interpolationErrorWorst = std::max(interpolationErrorWorst, error);
+        }
+        displayDelayTotal += now - playback * SERVER_TICK_MS;
+        ++samples;
+      }
+    }
+  }
+
+  const auto &stats = predictor.getStats();
+  auto finalError = glm::distance(predictor.getState().position, serverState.position);
+  std::cout << "client A: " << stats.predicted << " inputs predicted, " << stats.reconciled << " server states, "
+            << stats.corrections << " corrections (largest " << stats.maxCorrection << " blocks, "
+            << correctionBeforeOverride << " before the override), " << inputsToServer.getDropped()
+            << " input datagrams lost" << std::endl;
+  std::cout << "  movement shows at once; without prediction it would wait for the server, "
+            << (confirmCount ? confirmTotal / confirmCount : 0.0) << " ms average, " << confirmWorst << " ms worst"
+            << std::endl;
+  std::cout << "  " << finalError << " blocks from the server once settled" << std::endl;
+  std::cout << "client B: A shown " << (samples ? displayDelayTotal / samples : 0.0) << " ms behind the server on "
+            << "average, interpolation error " << (samples ? interpolationErrorTotal / samples : 0.0)
+            << " blocks average, " << interpolationErrorWorst << " worst, " << remote.getStarvedSamples() << "/"
+            << samples << " samples starved" << std::endl;
+
+  auto passed = finalError <= AGREEMENT_TOLERANCE && stats.maxCorrection >= OVERRIDE_HEIGHT - AGREEMENT_TOLERANCE;
+  // Lost inputs are covered by the redundant copies, so short of long loss bursts only the override corrects
+  if (loss == 0.0 && correctionBeforeOverride > AGREEMENT_TOLERANCE) {
+    passed = false;
+  }
+  std::cout << (passed ? "passed" : "FAILED") << std::endl;
+  return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
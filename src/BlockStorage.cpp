@@ -0,0 +1,259 @@
+#include "BlockStorage.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace {
+  int bitsForPalette(size_t size) {
+    if (size <= 1) {
+      return 0;
+    }
+
+    auto bits = 1;
+    while ((size_t(1) << bits) < size) {
+      bits *= 2;
+    }
+    return bits;
+  }
+
+  size_t wordsForBits(int bits) {
+    return (static_cast<size_t>(CHUNK_VOLUME) * bits + 63) / 64;
+  }
+}
+
+BlockStorage::BlockStorage(BlockId value) : palette{value} {
+}
+
+void BlockStorage::set(int index, BlockId value) {
+  if (bitsPerBlock == 0 && palette[0] == value) {
+    return;
+  }
+
+  setIndex(index, findOrAdd(value));
+
+  // At 16 bits the palette no longer widens, so nothing else would stop it outgrowing the chunk
+  if (palette.size() > CHUNK_VOLUME) {
+    compact();
+  }
+}
+
+void BlockStorage::fill(BlockId value) {
+  palette.assign(1, value);
+  paletteLookup.clear();
+  words.clear();
+  words.shrink_to_fit();
+  bitsPerBlock = 0;
+  indexMask = 0;
+}
+
+void BlockStorage::assign(const BlockId *values) {
+  palette.clear();
+  paletteLookup.clear();
+  for (auto i = 0; i < CHUNK_VOLUME; ++i) {
+    if ((i == 0 || values[i] != values[i - 1]) &&
+        std::find(palette.begin(), palette.end(), values[i]) == palette.end()) {
+      palette.push_back(values[i]);
+      if (palette.size() > LINEAR_PALETTE_LIMIT) {
+        break;
+      }
+    }
+  }
+
+  // Large palettes are rare; gather them exactly once the linear scan stops paying off
+  if (palette.size() > LINEAR_PALETTE_LIMIT) {
+    palette.assign(values, values + CHUNK_VOLUME);
+    std::sort(palette.begin(), palette.end());
+    palette.erase(std::unique(palette.begin(), palette.end()), palette.end());
+  }
+  rebuildLookup();
+
+  bitsPerBlock = bitsForPalette(palette.size());
+  indexMask = bitsPerBlock == 0 ? 0 : (uint64_t(1) << bitsPerBlock) - 1;
+  words.assign(wordsForBits(bitsPerBlock), 0);
+  words.shrink_to_fit();
+  if (bitsPerBlock == 0) {
+    return;
+  }
+
+  // Generated terrain comes in long runs of one value, so remember the last lookup
+  auto lastValue = palette[0];
+  uint16_t lastIndex = 0;
+  for (auto i = 0; i < CHUNK_VOLUME; ++i) {
+    if (values[i] != lastValue) {
+      lastValue = values[i];
+      if (paletteLookup.empty()) {
+        lastIndex = static_cast<uint16_t>(std::find(palette.begin(), palette.end(), lastValue) - palette.begin());
+      } else {
+        lastIndex = paletteLookup.find(lastValue)->second;
+      }
+    }
+    setIndex(i, lastIndex);
+  }
+}
+
+void BlockStorage::compact() {
+  if (bitsPerBlock == 0) {
+    return;
+  }
+
+  std::vector<uint8_t> used(palette.size(), 0);
+  for (auto i = 0; i < CHUNK_VOLUME; ++i) {
+    used[getPaletteIndex(i)] = 1;
+  }
+
+  std::vector<uint16_t> remap(palette.size(), 0);
+  std::vector<BlockId> compacted;
+  for (size_t i = 0; i < palette.size(); ++i) {
+    if (used[i]) {
+      remap[i] = static_cast<uint16_t>(compacted.size());
+      compacted.push_back(palette[i]);
+    }
+  }
+
+  if (compacted.size() == palette.size()) {
+    return;
+  }
+
+  repack(bitsForPalette(compacted.size()), remap.data());
+  palette = std::move(compacted);
+  rebuildLookup();
+}
+
+bool BlockStorage::isUniform() const {
+  return bitsPerBlock == 0;
+}
+
+int BlockStorage::getBitsPerBlock() const {
+  return bitsPerBlock;
+}
+
+size_t BlockStorage::getPaletteSize() const {
+  return palette.size();
+}
+
+size_t BlockStorage::getMemoryUsage() const {
+  auto bytes = sizeof(BlockStorage) + palette.capacity() * sizeof(BlockId) + words.capacity() * sizeof(uint64_t);
+  if (!paletteLookup.empty()) {
+    bytes += paletteLookup.size() * (sizeof(BlockId) + sizeof(uint16_t) + sizeof(void *)) +
+             paletteLookup.bucket_count() * sizeof(void *);
+  }
+  return bytes;
+}
+
+const std::vector<BlockId> &BlockStorage::getPalette() const {
+  return palette;
+}
+
+const std::vector<uint64_t> &BlockStorage::getWords() const {
+  return words;
+}
+
+size_t BlockStorage::getWordCount(size_t paletteSize) {
+  return wordsForBits(bitsForPalette(paletteSize));
+}
+
+bool BlockStorage::load(std::vector<BlockId> newPalette, std::vector<uint64_t> newWords) {
+  if (newPalette.empty() || newPalette.size() > CHUNK_VOLUME) {
+    return false;
+  }
+
+  auto bits = bitsForPalette(newPalette.size());
+  if (newWords.size() != wordsForBits(bits)) {
+    return false;
+  }
+
+  auto mask = bits == 0 ? 0 : (uint64_t(1) << bits) - 1;
+  for (auto i = 0; bits != 0 && i < CHUNK_VOLUME; ++i) {
+    auto bit = static_cast<uint32_t>(i) * bits;
+    if (((newWords[bit >> 6] >> (bit & 63)) & mask) >= newPalette.size()) {
+      return false;
+    }
+  }
+
+  palette = std::move(newPalette);
+  words = std::move(newWords);
+  bitsPerBlock = bits;
+  indexMask = mask;
+  rebuildLookup();
+  return true;
+}
+
+uint16_t BlockStorage::getPaletteIndex(int index) const {
+  if (bitsPerBlock == 0) {
+    return 0;
+  }
+
+  auto bit = static_cast<uint32_t>(index) * bitsPerBlock;
+  return static_cast<uint16_t>((words[bit >> 6] >> (bit & 63)) & indexMask);
+}
+
+void BlockStorage::setIndex(int index, uint16_t paletteIndex) {
+  auto bit = static_cast<uint32_t>(index) * bitsPerBlock;
+  auto &word = words[bit >> 6];
+  word = (word & ~(indexMask << (bit & 63))) | (static_cast<uint64_t>(paletteIndex) << (bit & 63));
+}
+
+uint16_t BlockStorage::findOrAdd(BlockId value) {
+  if (paletteLookup.empty()) {
+    auto it = std::find(palette.begin(), palette.end(), value);
+    if (it != palette.end()) {
+      return static_cast<uint16_t>(it - palette.begin());
+    }
+  } else if (auto it = paletteLookup.find(value); it != paletteLookup.end()) {
+    return it->second;
+  }
+
+  // Widening repacks every block anyway, so first drop the values that were overwritten; a chunk edited
+  // over and over then keeps a palette of what it holds rather than of everything it ever held
+  if (bitsForPalette(palette.size() + 1) != bitsPerBlock) {
+    compact();
+  }
+
+  auto paletteIndex = static_cast<uint16_t>(palette.size());
+  palette.push_back(value);
+  if (palette.size() > LINEAR_PALETTE_LIMIT) {
+    if (paletteLookup.empty()) {
+      rebuildLookup();
+    } else {
+      paletteLookup.emplace(value, paletteIndex);
+    }
+  }
+
+  auto bits = bitsForPalette(palette.size());
+  if (bits != bitsPerBlock) {
+    std::vector<uint16_t> identity(palette.size());
+    std::iota(identity.begin(), identity.end(), uint16_t(0));
+    repack(bits, identity.data());
+  }
+  return paletteIndex;
+}
+
+void BlockStorage::rebuildLookup() {
+  paletteLookup.clear();
+  if (palette.size() <= LINEAR_PALETTE_LIMIT) {
+    return;
+  }
+
+  paletteLookup.reserve(palette.size());
+  for (size_t i = 0; i < palette.size(); ++i) {
+    paletteLookup.emplace(palette[i], static_cast<uint16_t>(i));
+  }
+}
+
+void BlockStorage::repack(int bits, const uint16_t *remap) {
+  std::vector<uint16_t> indices(CHUNK_VOLUME);
+  for (auto i = 0; i < CHUNK_VOLUME; ++i) {
+    indices[i] = remap[getPaletteIndex(i)];
+  }
+
+  bitsPerBlock = bits;
+  indexMask = bits == 0 ? 0 : (uint64_t(1) << bits) - 1;
+  words.assign(wordsForBits(bits), 0);
+  words.shrink_to_fit();
+  if (bits == 0) {
+    return;
+  }
+
+  for (auto i = 0; i < CHUNK_VOLUME; ++i) {
+    setIndex(i, indices[i]);
+  }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "ChunkPos.hpp"
+
+constexpr int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+// Above this many entries the palette keeps a hash lookup so set() stays O(1)
+constexpr size_t LINEAR_PALETTE_LIMIT = 16;
+
+// Blocks of one chunk as a palette plus packed palette indices. The index width is 0, 1, 2, 4, 8 or 16
+// bits, so an index never straddles two words; 0 bits means every block holds palette[0] and no index
+// array exists at all. The width grows as set() adds values and only shrinks on compact() or assign(); set()
+// compacts before widening, so values no block holds any more are dropped instead of piling up.
+class BlockStorage {
+public:
+  explicit BlockStorage(BlockId value = 0);
+
+  [[nodiscard]] static constexpr int index(int x, int y, int z) {
+    return (x * CHUNK_SIZE + y) * CHUNK_SIZE + z;
+  }
+
+  [[nodiscard]] BlockId get(int index) const {
+    if (bitsPerBlock == 0) {
+      return palette[0];
+    }
+
+    auto bit = static_cast<uint32_t>(index) * bitsPerBlock;
+    return palette[(words[bit >> 6] >> (bit & 63)) & indexMask];
+  }
+
+  // Position of the block's value in getPalette()
+  [[nodiscard]] uint16_t getPaletteIndex(int index) const;
+
+  void set(int index, BlockId value);
+
+  void fill(BlockId value);
+
+  // Replaces every block from a dense CHUNK_VOLUME array, with the smallest palette that fits
+  void assign(const BlockId *values);
+
+  // Drops palette entries no block uses any more and narrows the indices to match
+  void compact();
+
+  [[nodiscard]] bool isUniform() const;
+
+  [[nodiscard]] int getBitsPerBlock() const;
+
+  [[nodiscard]] size_t getPaletteSize() const;
+
+  [[nodiscard]] size_t getMemoryUsage() const;
+
+  [[nodiscard]] const std::vector<BlockId> &getPalette() const;
+
+  [[nodiscard]] const std::vector<uint64_t> &getWords() const;
+
+  // Length of getWords() for a palette of this size
+  [[nodiscard]] static size_t getWordCount(size_t paletteSize);
+
+  // Adopts a palette and packed indices as getPalette() and getWords() returned them. Returns false, leaving
+  // the storage untouched, when the sizes do not agree or an index points past the palette.
+  bool load(std::vector<BlockId> newPalette, std::vector<uint64_t> newWords);
+
+private:
+  std::vector<BlockId> palette;
+  std::unordered_map<BlockId, uint16_t> paletteLookup;
+  std::vector<uint64_t> words;
+  int bitsPerBlock = 0;
+  uint64_t indexMask = 0;
+
+  void setIndex(int index, uint16_t paletteIndex);
+
+  [[nodiscard]] uint16_t findOrAdd(BlockId value);
+
+  void rebuildLookup();
+
+  void repack(int bits, const uint16_t *remap);
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Appends little-endian values to a byte vector, independent of the host byte order.
+class ByteWriter {
+public:
+  explicit ByteWriter(std::vector<uint8_t> &out) : out(out) {
+  }
+
+  void writeU8(uint8_t value) {
+    out.push_back(value);
+  }
+
+  void writeU16(uint16_t value) {
+    writeUnsigned(value, 2);
+  }
+
+  void writeU32(uint32_t value) {
+    writeUnsigned(value, 4);
+  }
+
+  void writeU64(uint64_t value) {
+    writeUnsigned(value, 8);
+  }
+
+  void writeI32(int32_t value) {
+    writeU32(static_cast<uint32_t>(value));
+  }
+
+  void writeF32(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeU32(bits);
+  }
+
+  // LEB128: seven bits per byte, low bits first, so small values take a single byte
+  void writeVarU32(uint32_t value) {
+    while (value >= 0x80) {
+      out.push_back(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+  }
+
+  void writeBytes(const void *data, size_t size) {
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    out.insert(out.end(), bytes, bytes + size);
+  }
+
+  [[nodiscard]] size_t size() const {
+    return out.size();
+  }
+
+  // Drops everything written after the first size bytes, for encoders that try one layout and fall back
+  void truncate(size_t size) {
+    out.resize(size);
+  }
+
+private:
+  std::vector<uint8_t> &out;
+
+  void writeUnsigned(uint64_t value, int bytes) {
+    for (auto i = 0; i < bytes; ++i) {
+      out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+    }
+  }
+};
+
+// Reads values written by ByteWriter. Reading past the end yields zeros and marks the reader as failed,
+// so a decoder can read a whole message and check isValid() once at the end.
+class ByteReader {
+public:
+  ByteReader() = default;
+
+  ByteReader(const uint8_t *data, size_t size) : data(data), size(size) {
+  }
+
+  uint8_t readU8() {
+    return static_cast<uint8_t>(readUnsigned(1));
+  }
+
+  uint16_t readU16() {
+    return static_cast<uint16_t>(readUnsigned(2));
+  }
+
+  uint32_t readU32() {
+    return static_cast<uint32_t>(readUnsigned(4));
+  }
+
+  uint64_t readU64() {
+    return readUnsigned(8);
+  }
+
+  int32_t readI32() {
+    return static_cast<int32_t>(readU32());
+  }
+
+  float readF32() {
+    auto bits = readU32();
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  uint32_t readVarU32() {
+    uint32_t value = 0;
+    for (auto shift = 0; shift < 35; shift += 7) {
+      auto byte = readU8();
+      value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+
+    // More than five bytes cannot be a u32
+    failed = true;
+    return 0;
+  }
+
+  bool readBytes(void *destination, size_t count) {
+    if (!require(count)) {
+      return false;
+    }
+
+    std::memcpy(destination, data + offset, count);
+    offset += count;
+    return true;
+  }
+
+  [[nodiscard]] size_t remaining() const {
+    return size - offset;
+  }
+
+  [[nodiscard]] bool isValid() const {
+    return !failed;
+  }
+
+private:
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+  size_t offset = 0;
+  bool failed = false;
+
+  bool require(size_t count) {
+    if (failed || count > size - offset) {
+      failed = true;
+      return false;
+    }
+    return true;
+  }
+
+  uint64_t readUnsigned(int bytes) {
+    if (!require(bytes)) {
+      return 0;
+    }
+
+    uint64_t value = 0;
+    for (auto i = 0; i < bytes; ++i) {
+      value |= static_cast<uint64_t>(data[offset + i]) << (i * 8);
+    }
+    offset += bytes;
+    return value;
+  }
+};
@@ -1,7 +1,7 @@
 #include "Camera.hpp"
 
 Camera::Camera(glm::vec3 startPosition, float startYaw, float startPitch, glm::vec3 startWorldUp) : front(
-  glm::vec3(0.0f, 0.0f, -1.0f)), movementSpeed(5.0f), mouseSensitivity(0.1f), zoom(60.0f) {
+  glm::vec3(0.0f, 0.0f, -1.0f)), mouseSensitivity(0.1f), zoom(60.0f) {
   position = startPosition;
   yaw = startYaw;
   pitch = startPitch;
@@ -21,19 +21,6 @@ void Camera::updateCameraVectors() {
   up = glm::normalize(glm::cross(right, front));
 }
 
-void Camera::processKeyboard(const std::shared_ptr<Input>& input, float deltaTime) {
-  float velocity = movementSpeed * deltaTime;
-
-  if (input->isKey(SDL_SCANCODE_W))
-    position += front * velocity;
-  if (input->isKey(SDL_SCANCODE_S))
-    position -= front * velocity;
-  if (input->isKey(SDL_SCANCODE_A))
-    position -= right * velocity;
-  if (input->isKey(SDL_SCANCODE_D))
-    position += right * velocity;
-}
-
 void Camera::processMouseMovement(const std::shared_ptr<Input>& input, bool constrainPitch) {
   auto xOffset = (float)input->getMouseDeltaX();
   auto yOffset = (float)input->getMouseDeltaY();
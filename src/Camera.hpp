@@ -19,7 +19,6 @@ public:
 
   float yaw;
   float pitch;
-  float movementSpeed;
   float mouseSensitivity;
   float zoom;
 
@@ -35,8 +34,6 @@ public:
 
   void updateCameraVectors();
 
-  void processKeyboard(const std::shared_ptr<Input>& input, float deltaTime);
-
   void processMouseMovement(const std::shared_ptr<Input>& input, bool constrainPitch = true);
 
   void processMouseScroll(float yOffset);
@@ -0,0 +1,23 @@
+#include "CameraUniforms.hpp"
+#include "Shader.hpp"
+
+CameraUniforms::CameraUniforms() : buffer(0) {
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, buffer);
+}
+
+CameraUniforms::~CameraUniforms() {
+  glDeleteBuffers(1, &buffer);
+}
+
+void CameraUniforms::update(const glm::mat4 &view, const glm::mat4 &projection) {
+  CameraBlock block{view, projection, projection * view};
+
+  glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &block);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "gl.hpp"
+
+// std140 layout of the Camera uniform block; mat4 columns are vec4-aligned, so no padding is needed
+struct CameraBlock {
+  glm::mat4 view;
+  glm::mat4 projection;
+  glm::mat4 viewProjection;
+};
+
+// The frame's camera matrices in one uniform buffer bound to CAMERA_BLOCK_BINDING, so every program
+// reads them without any per-program uniform calls
+class CameraUniforms {
+public:
+  CameraUniforms();
+
+  ~CameraUniforms();
+
+  CameraUniforms(const CameraUniforms &) = delete;
+
+  CameraUniforms &operator=(const CameraUniforms &) = delete;
+
+  void update(const glm::mat4 &view, const glm::mat4 &projection);
+
+private:
+  GLuint buffer;
+};
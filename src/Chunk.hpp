@@ -1,37 +1,94 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include "BlockStorage.hpp"
+#include "ChunkArena.hpp"
+#include "ChunkConnectivity.hpp"
+#include "ChunkLight.hpp"
+#include "ChunkPos.hpp"
 #include "Mesh.hpp"
-
-constexpr int CHUNK_SIZE = 16;
-constexpr float NOISE_SCALE = 0.1f;
-constexpr float HEIGHT_SCALE = 8.0f;
+#include "MeshData.hpp"
 
 class Chunk {
 public:
-  Chunk(int worldX, int worldZ, uint32_t seed);
+  explicit Chunk(ChunkPos position);
 
   ~Chunk();
 
-  void updateMesh();
+  // Takes blocks produced by the terrain generator, a server or a save
+  void load(BlockStorage &&loaded);
+
+  [[nodiscard]] bool isGenerated() const;
+
+  void cancel();
+
+  [[nodiscard]] bool isCancelled() const;
+
+  void uploadToGPU(ChunkArena &target, const MeshData &data, const ChunkConnectivity &meshConnectivity);
+
+  [[nodiscard]] uint32_t getDrawSlot() const;
+
+  [[nodiscard]] const ChunkConnectivity &getConnectivity() const;
+
+  [[nodiscard]] const MeshStats &getMeshStats() const;
+
+  // Level the uploaded mesh was built at, which trails getLodLevel() until the remesh lands
+  [[nodiscard]] int getMeshLodLevel() const;
+
+  // Level the next mesh is built at; changing it marks the chunk dirty
+  void setLodLevel(int level);
+
+  [[nodiscard]] int getLodLevel() const;
+
+  bool isLocalSolid(int x, int y, int z) const;
 
-  float getOcclusion(glm::vec3 position) const;
+  [[nodiscard]] BlockId getBlock(int x, int y, int z) const;
 
-  void tryUpdateMesh();
+  // Returns false when the position is outside the chunk or the chunk has not been generated yet
+  bool setBlock(int x, int y, int z, BlockId block);
 
-  void render() const;
+  [[nodiscard]] const BlockStorage &getBlocks() const;
 
-  bool isSolid(int x, int y, int z) const;
+  // Written by the world's LightEngine on the main thread only
+  [[nodiscard]] ChunkLight &getLight();
+
+  [[nodiscard]] const ChunkLight &getLight() const;
+
+  // Set by setBlock() until the chunk has been handed to storage again
+  [[nodiscard]] bool isModified() const;
+
+  void markModified();
+
+  void clearModified();
+
+  void markDirty();
+
+  [[nodiscard]] bool needsMesh() const;
+
+  void setMeshInFlight(bool inFlight);
+
+  [[nodiscard]] ChunkPos getPosition() const;
+
+  [[nodiscard]] glm::ivec3 getOrigin() const;
 
 private:
-  uint8_t data[CHUNK_SIZE][CHUNK_SIZE][CHUNK_SIZE];
+  BlockStorage blocks;
+  ChunkLight light;
   Mesh mesh;
+  MeshStats meshStats;
+  ChunkConnectivity connectivity;
+  ChunkArena *arena = nullptr;
 
-  long long seed;
+  ChunkPos position;
 
-  bool isDirty = true;
-
-  void addFace(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d, glm::vec3 normal, glm::vec3 origin);
+  std::atomic<bool> generated = false;
+  std::atomic<bool> cancelled = false;
 
-  void uploadToGPU();
+  // Only touched on the main thread
+  bool isDirty = true;
+  bool meshInFlight = false;
+  bool modified = false;
+  int lodLevel = 0;
+  int meshLodLevel = 0;
 };
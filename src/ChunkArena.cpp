@@ -0,0 +1,290 @@
+#include "ChunkArena.hpp"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+namespace {
+  uint32_t roundUpToGranularity(uint32_t count) {
+    return (count + ARENA_GRANULARITY - 1) / ARENA_GRANULARITY * ARENA_GRANULARITY;
+  }
+}
+
+ChunkArena::ChunkArena() : vao(0), vertices{0, GL_ARRAY_BUFFER, FreeListAllocator(INITIAL_ARENA_VERTICES)},
+                           indices{0, GL_ELEMENT_ARRAY_BUFFER, FreeListAllocator(INITIAL_ARENA_INDICES)},
+                           uploadedBytes(0), dirtyBegin(0), dirtyEnd(0), drawCalls(0), commandBuffer(0),
+                           originBuffer(0), slotCapacity(0) {
+  glGenVertexArrays(1, &vao);
+  glBindVertexArray(vao);
+
+  for (auto *region: {&vertices, &indices}) {
+    glGenBuffers(1, &region->buffer);
+    glBindBuffer(region->target, region->buffer);
+    glBufferData(region->target, region->allocator.getCapacity() * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+  }
+
+  glBindVertexArray(0);
+  bindVertexLayout();
+
+#ifdef PLATFORM_DESKTOP
+  staging = std::make_unique<StagingRing>(STAGING_RING_SIZE);
+
+  glGenBuffers(1, &commandBuffer);
+  glGenBuffers(1, &originBuffer);
+#endif
+}
+
+ChunkArena::~ChunkArena() {
+  staging.reset();
+  glDeleteVertexArrays(1, &vao);
+  glDeleteBuffers(1, &vertices.buffer);
+  glDeleteBuffers(1, &indices.buffer);
+  glDeleteBuffers(1, &commandBuffer);
+  glDeleteBuffers(1, &originBuffer);
+}
+
+Mesh ChunkArena::upload(const MeshData &data, Mesh previous, glm::ivec3 origin) {
+  auto vertexCount = static_cast<uint32_t>(data.vertices.size());
+  auto indexCount = static_cast<uint32_t>(data.indices.size());
+
+  if (indexCount == 0) {
+    release(previous);
+    return {};
+  }
+
+  // Remeshes usually change size only slightly, so keep the old ranges when they still fit without
+  // wasting more than half of them
+  auto mesh = previous;
+  auto fits = [](uint32_t capacity, uint32_t count) {
+    return capacity >= count && capacity <= roundUpToGranularity(count) * 2;
+  };
+  if (!fits(mesh.vertexCapacity, vertexCount) || !fits(mesh.indexCapacity, indexCount)) {
+    release(mesh);
+    mesh.vertexCapacity = roundUpToGranularity(vertexCount);
+    mesh.vertexOffset = allocate(vertices, mesh.vertexCapacity);
+    mesh.indexCapacity = roundUpToGranularity(indexCount);
+    mesh.indexOffset = allocate(indices, mesh.indexCapacity);
+  }
+
+  write(vertices, mesh.vertexOffset, data.vertices.data(), vertexCount, 0);
+  write(indices, mesh.indexOffset, data.indices.data(), indexCount, mesh.vertexOffset);
+  mesh.indexCount = indexCount;
+
+  if (mesh.drawSlot == NO_DRAW_SLOT) {
+    mesh.drawSlot = acquireSlot();
+  }
+  setSlot(mesh.drawSlot, {indexCount, 1, mesh.indexOffset, 0, mesh.drawSlot}, origin);
+
+  return mesh;
+}
+
+void ChunkArena::release(Mesh &mesh) {
+  if (mesh.drawSlot != NO_DRAW_SLOT) {
+    setSlot(mesh.drawSlot, {0, 0, 0, 0, 0}, glm::ivec3(0));
+    freeSlots.push_back(mesh.drawSlot);
+    std::push_heap(freeSlots.begin(), freeSlots.end(), std::greater<>());
+  }
+
+  vertices.allocator.free(mesh.vertexOffset, mesh.vertexCapacity);
+  indices.allocator.free(mesh.indexOffset, mesh.indexCapacity);
+  mesh = Mesh();
+}
+
+void ChunkArena::bind() const {
+  glBindVertexArray(vao);
+}
+
+void ChunkArena::draw([[maybe_unused]] const Shader &shader, const std::vector<uint32_t> &slots) {
+  drawCalls = 0;
+#ifdef PLATFORM_DESKTOP
+  flushSlots();
+
+  frameCommands.clear();
+  for (auto slot : slots) {
+    if (commands[slot].count != 0) {
+      frameCommands.push_back(commands[slot]);
+    }
+  }
+  if (frameCommands.empty()) {
+    return;
+  }
+
+  // Orphaned every frame; the list is small and rebuilt from scratch anyway
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+  glBufferData(GL_DRAW_INDIRECT_BUFFER, frameCommands.size() * sizeof(DrawCommand), frameCommands.data(),
+               GL_STREAM_DRAW);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CHUNK_ORIGIN_BINDING, originBuffer);
+  glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei) frameCommands.size(), 0);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  drawCalls = 1;
+#else
+  // WebGL2 has neither storage buffers nor a base instance, so each chunk's origin stays a uniform
+  auto originLocation = shader.getUniformLocation("chunkOrigin");
+  for (auto slot : slots) {
+    const auto &command = commands[slot];
+    if (command.count == 0) {
+      continue;
+    }
+
+    shader.setVec3(originLocation, glm::vec3(origins[slot]));
+    glDrawElements(GL_TRIANGLES, (GLsizei) command.count, GL_UNSIGNED_INT,
+                   (GLvoid *) (static_cast<uintptr_t>(command.firstIndex) * sizeof(uint32_t)));
+    ++drawCalls;
+  }
+#endif
+}
+
+void ChunkArena::endFrame() {
+  if (staging) {
+    staging->endFrame();
+  }
+}
+
+ArenaStats ChunkArena::getStats() const {
+  ArenaStats stats{};
+  stats.vertexBytesUsed = vertices.allocator.getUsed() * sizeof(uint32_t);
+  stats.vertexBytesCapacity = vertices.allocator.getCapacity() * sizeof(uint32_t);
+  stats.indexBytesUsed = indices.allocator.getUsed() * sizeof(uint32_t);
+  stats.indexBytesCapacity = indices.allocator.getCapacity() * sizeof(uint32_t);
+  stats.largestFreeVertexBytes = vertices.allocator.getLargestFreeBlock() * sizeof(uint32_t);
+  stats.allocations = vertices.allocator.getAllocationCount();
+  stats.stagingBytesInFlight = staging ? staging->getBytesInFlight() : 0;
+  stats.uploadedBytes = uploadedBytes;
+  stats.drawSlots = commands.size() - freeSlots.size();
+  stats.drawCalls = drawCalls;
+  return stats;
+}
+
+uint32_t ChunkArena::allocate(Region &region, uint32_t count) {
+  uint32_t offset = 0;
+  if (!region.allocator.allocate(count, offset)) {
+    grow(region, region.allocator.getCapacity() + count);
+    auto allocated = region.allocator.allocate(count, offset);
+    (void) allocated;
+  }
+  return offset;
+}
+
+void ChunkArena::grow(Region &region, uint32_t minimumCapacity) {
+  auto oldCapacity = region.allocator.getCapacity();
+  auto newCapacity = std::max(oldCapacity * 2, minimumCapacity);
+
+  GLuint buffer;
+  glGenBuffers(1, &buffer);
+
+  glBindVertexArray(vao);
+  glBindBuffer(region.target, buffer);
+  glBufferData(region.target, newCapacity * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+  glBindVertexArray(0);
+
+  glBindBuffer(GL_COPY_READ_BUFFER, region.buffer);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+  glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldCapacity * sizeof(uint32_t));
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  glDeleteBuffers(1, &region.buffer);
+  region.buffer = buffer;
+  region.allocator.grow(newCapacity);
+
+  bindVertexLayout();
+}
+
+void ChunkArena::write(Region &region, uint32_t offset, const uint32_t *data, uint32_t count, uint32_t rebase) {
+  auto bytes = static_cast<GLsizeiptr>(count * sizeof(uint32_t));
+  uploadedBytes += bytes;
+
+  GLintptr stagingOffset;
+  void *pointer;
+  if (staging && staging->allocate(bytes, stagingOffset, pointer)) {
+    auto *target = static_cast<uint32_t *>(pointer);
+    if (rebase == 0) {
+      std::memcpy(target, data, bytes);
+    } else {
+      for (auto i = 0u; i < count; ++i) {
+        target[i] = data[i] + rebase;
+      }
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, staging->getBuffer());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, region.buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, stagingOffset, offset * sizeof(uint32_t), bytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return;
+  }
+
+  if (rebase != 0) {
+    scratch.resize(count);
+    for (auto i = 0u; i < count; ++i) {
+      scratch[i] = data[i] + rebase;
+    }
+    data = scratch.data();
+  }
+
+  glBindBuffer(GL_COPY_WRITE_BUFFER, region.buffer);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, offset * sizeof(uint32_t), bytes, data);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void ChunkArena::bindVertexLayout() const {
+  glBindVertexArray(vao);
+
+  glBindBuffer(GL_ARRAY_BUFFER, vertices.buffer);
+  glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (GLvoid *) nullptr);
+  glEnableVertexAttribArray(0);
+
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.buffer);
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+uint32_t ChunkArena::acquireSlot() {
+  if (!freeSlots.empty()) {
+    // Lowest free slot first keeps the live draw list dense
+    std::pop_heap(freeSlots.begin(), freeSlots.end(), std::greater<>());
+    auto slot = freeSlots.back();
+    freeSlots.pop_back();
+    return slot;
+  }
+
+  commands.push_back({0, 0, 0, 0, 0});
+  origins.emplace_back(0);
+  return static_cast<uint32_t>(commands.size() - 1);
+}
+
+void ChunkArena::setSlot(uint32_t slot, const DrawCommand &command, glm::ivec3 origin) {
+  commands[slot] = command;
+  origins[slot] = glm::ivec4(origin, 0);
+
+  if (dirtyBegin == dirtyEnd) {
+    dirtyBegin = slot;
+    dirtyEnd = slot + 1;
+  } else {
+    dirtyBegin = std::min(dirtyBegin, slot);
+    dirtyEnd = std::max(dirtyEnd, slot + 1);
+  }
+}
+
+void ChunkArena::flushSlots() {
+#ifdef PLATFORM_DESKTOP
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, originBuffer);
+
+  auto slotCount = static_cast<uint32_t>(origins.size());
+  if (slotCount > slotCapacity) {
+    slotCapacity = std::max({slotCapacity * 2, slotCount, INITIAL_DRAW_SLOTS});
+    glBufferData(GL_SHADER_STORAGE_BUFFER, slotCapacity * sizeof(glm::ivec4), nullptr, GL_DYNAMIC_DRAW);
+    dirtyBegin = 0;
+    dirtyEnd = slotCount;
+  }
+
+  if (dirtyBegin != dirtyEnd) {
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, dirtyBegin * sizeof(glm::ivec4),
+                    (dirtyEnd - dirtyBegin) * sizeof(glm::ivec4), origins.data() + dirtyBegin);
+  }
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+#endif
+
+  dirtyBegin = dirtyEnd = 0;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "gl.hpp"
+#include "FreeListAllocator.hpp"
+#include "Mesh.hpp"
+#include "MeshData.hpp"
+#include "Shader.hpp"
+#include "StagingRing.hpp"
+
+constexpr uint32_t INITIAL_ARENA_VERTICES = 1u << 20;
+constexpr uint32_t INITIAL_ARENA_INDICES = 3u << 19;
+constexpr uint32_t ARENA_GRANULARITY = 64;
+constexpr GLsizeiptr STAGING_RING_SIZE = 8 * 1024 * 1024;
+constexpr uint32_t INITIAL_DRAW_SLOTS = 1024;
+constexpr GLuint CHUNK_ORIGIN_BINDING = 0;
+
+struct ArenaStats {
+  size_t vertexBytesUsed;
+  size_t vertexBytesCapacity;
+  size_t indexBytesUsed;
+  size_t indexBytesCapacity;
+  size_t largestFreeVertexBytes;
+  size_t allocations;
+  size_t stagingBytesInFlight;
+  size_t uploadedBytes;
+  size_t drawSlots;
+  size_t drawCalls;
+};
+
+// One vertex buffer and one index buffer shared by every chunk, sub-allocated with free lists so
+// remeshing never creates or destroys GL objects. Indices are rebased on upload to address the shared
+// vertex buffer directly, which keeps drawing free of base-vertex calls that WebGL2 lacks.
+//
+// Every mesh also owns a slot in a persistent draw list, and a frame draws any subset of slots. On
+// GL 4.6 the chosen commands are packed into an indirect buffer and drawn with a single
+// glMultiDrawElementsIndirect; each command's base instance is its slot, which indexes an SSBO of
+// chunk origins where only slots that changed are re-uploaded. WebGL2 draws the same slots with one
+// origin uniform and one glDrawElements per chunk.
+class ChunkArena {
+public:
+  ChunkArena();
+
+  ~ChunkArena();
+
+  [[nodiscard]] Mesh upload(const MeshData &data, Mesh previous, glm::ivec3 origin);
+
+  void release(Mesh &mesh);
+
+  void bind() const;
+
+  // Only WebGL2 uses the shader, to set each chunk's origin
+  void draw(const Shader &shader, const std::vector<uint32_t> &slots);
+
+  // Fences the staging regions written since the last call; the ring reuses them once the GPU passes it
+  void endFrame();
+
+  [[nodiscard]] ArenaStats getStats() const;
+
+private:
+  struct Region {
+    GLuint buffer;
+    GLenum target;
+    FreeListAllocator allocator;
+  };
+
+  // Matches the layout glMultiDrawElementsIndirect reads
+  struct DrawCommand {
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t baseInstance;
+  };
+
+  GLuint vao;
+  Region vertices;
+  Region indices;
+  std::unique_ptr<StagingRing> staging;
+  std::vector<uint32_t> scratch;
+  size_t uploadedBytes;
+
+  std::vector<DrawCommand> commands;
+  std::vector<DrawCommand> frameCommands;
+  std::vector<glm::ivec4> origins;
+  std::vector<uint32_t> freeSlots;
+  // Origins changed since the last flush
+  uint32_t dirtyBegin;
+  uint32_t dirtyEnd;
+  size_t drawCalls;
+
+  GLuint commandBuffer;
+  GLuint originBuffer;
+  uint32_t slotCapacity;
+
+  [[nodiscard]] uint32_t allocate(Region &region, uint32_t count);
+
+  void grow(Region &region, uint32_t minimumCapacity);
+
+  void write(Region &region, uint32_t offset, const uint32_t *data, uint32_t count, uint32_t rebase);
+
+  void bindVertexLayout() const;
+
+  [[nodiscard]] uint32_t acquireSlot();
+
+  void setSlot(uint32_t slot, const DrawCommand &command, glm::ivec3 origin);
+
+  void flushSlots();
+};
@@ -0,0 +1,198 @@
+#include "ChunkCodec.hpp"
+#include <algorithm>
+
+namespace {
+  size_t varU32Size(uint32_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+      value >>= 7;
+      ++size;
+    }
+    return size;
+  }
+
+  void writePalette(ByteWriter &writer, const std::vector<BlockId> &palette) {
+    writer.writeVarU32(static_cast<uint32_t>(palette.size()));
+    for (auto value: palette) {
+      writer.writeVarU32(value);
+    }
+  }
+
+  bool readPalette(ByteReader &reader, std::vector<BlockId> &palette) {
+    auto size = reader.readVarU32();
+    if (size == 0 || size > CHUNK_VOLUME || size > reader.remaining()) {
+      return false;
+    }
+
+    palette.resize(size);
+    for (auto &value: palette) {
+      auto read = reader.readVarU32();
+      if (read > UINT16_MAX) {
+        return false;
+      }
+      value = static_cast<BlockId>(read);
+    }
+    return reader.isValid();
+  }
+
+  bool decodeRuns(ByteReader &reader, BlockStorage &blocks) {
+    std::vector<BlockId> palette;
+    if (!readPalette(reader, palette)) {
+      return false;
+    }
+
+    BlockId values[CHUNK_VOLUME];
+    auto cursor = 0;
+    while (cursor < CHUNK_VOLUME) {
+      auto length = reader.readVarU32() + 1;
+      auto paletteIndex = reader.readVarU32();
+      if (!reader.isValid() || length > static_cast<uint32_t>(CHUNK_VOLUME - cursor) ||
+          paletteIndex >= palette.size()) {
+        return false;
+      }
+
+      // The cursor walks blocks layer by layer, the order the encoder took them in
+      auto value = palette[paletteIndex];
+      for (auto end = cursor + static_cast<int>(length); cursor < end; ++cursor) {
+        auto z = cursor % CHUNK_SIZE;
+        auto x = (cursor / CHUNK_SIZE) % CHUNK_SIZE;
+        auto y = cursor / (CHUNK_SIZE * CHUNK_SIZE);
+        values[BlockStorage::index(x, y, z)] = value;
+      }
+    }
+
+    blocks.assign(values);
+    return true;
+  }
+}
+
+void encodeBlocks(ByteWriter &writer, const BlockStorage &blocks) {
+  const auto &palette = blocks.getPalette();
+  if (blocks.isUniform()) {
+    writer.writeU8(static_cast<uint8_t>(ChunkEncoding::Uniform));
+    writer.writeVarU32(palette[0]);
+    return;
+  }
+
+  auto start = writer.size();
+  writer.writeU8(static_cast<uint8_t>(ChunkEncoding::Runs));
+  writePalette(writer, palette);
+
+  // Stop as soon as runs cost more than the packed words would
+  auto paletteBytes = writer.size() - start - 1;
+  auto packedBytes = 1 + paletteBytes + blocks.getWords().size() * sizeof(uint64_t);
+
+  uint32_t current = blocks.getPaletteIndex(BlockStorage::index(0, 0, 0));
+  uint32_t length = 0;
+  for (auto y = 0; y < CHUNK_SIZE && writer.size() - start <= packedBytes; ++y) {
+    for (auto x = 0; x < CHUNK_SIZE; ++x) {
+      for (auto z = 0; z < CHUNK_SIZE; ++z) {
+        uint32_t paletteIndex = blocks.getPaletteIndex(BlockStorage::index(x, y, z));
+        if (paletteIndex == current) {
+          ++length;
+          continue;
+        }
+
+        writer.writeVarU32(length - 1);
+        writer.writeVarU32(current);
+        current = paletteIndex;
+        length = 1;
+      }
+    }
+  }
+
+  if (writer.size() - start + varU32Size(length - 1) + varU32Size(current) <= packedBytes) {
+    writer.writeVarU32(length - 1);
+    writer.writeVarU32(current);
+    return;
+  }
+
+  writer.truncate(start);
+  writer.writeU8(static_cast<uint8_t>(ChunkEncoding::Packed));
+  writePalette(writer, palette);
+  for (auto word: blocks.getWords()) {
+    writer.writeU64(word);
+  }
+}
+
+bool decodeBlocks(ByteReader &reader, BlockStorage &blocks) {
+  switch (static_cast<ChunkEncoding>(reader.readU8())) {
+    case ChunkEncoding::Uniform: {
+      auto value = reader.readVarU32();
+      if (!reader.isValid() || value > UINT16_MAX) {
+        return false;
+      }
+
+      blocks.fill(static_cast<BlockId>(value));
+      return true;
+    }
+    case ChunkEncoding::Runs:
+      return decodeRuns(reader, blocks);
+    case ChunkEncoding::Packed: {
+      std::vector<BlockId> palette;
+      if (!readPalette(reader, palette)) {
+        return false;
+      }
+
+      auto wordCount = BlockStorage::getWordCount(palette.size());
+      if (reader.remaining() < wordCount * sizeof(uint64_t)) {
+        return false;
+      }
+
+      std::vector<uint64_t> words(wordCount);
+      for (auto &word: words) {
+        word = reader.readU64();
+      }
+      return blocks.load(std::move(palette), std::move(words));
+    }
+    default:
+      return false;
+  }
+}
+
+void coalesceBlockChanges(std::vector<BlockChange> &changes) {
+  // Stable, so of several changes to one block the one made last stays last
+  std::stable_sort(changes.begin(), changes.end(), [](const BlockChange &a, const BlockChange &b) {
+    return a.index < b.index;
+  });
+
+  auto out = changes.begin();
+  for (auto it = changes.begin(); it != changes.end(); ++it) {
+    if (std::next(it) != changes.end() && std::next(it)->index == it->index) {
+      continue;
+    }
+    *out++ = *it;
+  }
+  changes.erase(out, changes.end());
+}
+
+void encodeBlockChanges(ByteWriter &writer, const std::vector<BlockChange> &changes) {
+  writer.writeVarU32(static_cast<uint32_t>(changes.size()));
+
+  uint32_t previous = 0;
+  for (const auto &change: changes) {
+    writer.writeVarU32(change.index - previous);
+    writer.writeVarU32(change.block);
+    previous = change.index;
+  }
+}
+
+bool decodeBlockChanges(ByteReader &reader, std::vector<BlockChange> &changes) {
+  auto count = reader.readVarU32();
+  if (count > CHUNK_VOLUME || count > reader.remaining()) {
+    return false;
+  }
+
+  changes.resize(count);
+  uint32_t index = 0;
+  for (auto &change: changes) {
+    auto gap = reader.readVarU32();
+    auto block = reader.readVarU32();
+    index += std::min<uint32_t>(gap, CHUNK_VOLUME);
+    if (index >= CHUNK_VOLUME || block > UINT16_MAX) {
+      return false;
+    }
+    change = {static_cast<uint16_t>(index), static_cast<BlockId>(block)};
+  }
+  return reader.isValid();
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "BlockStorage.hpp"
+#include "ByteBuffer.hpp"
+
+enum class ChunkEncoding : uint8_t {
+  // One palette entry and nothing else
+  Uniform,
+  // The palette, then (length - 1, palette index) varint pairs over the blocks layer by layer
+  Runs,
+  // The palette, then BlockStorage's packed index words as they are; wins on noisy chunks
+  Packed
+};
+
+struct BlockChange {
+  uint16_t index;
+  BlockId block;
+};
+
+// Writes blocks in whichever encoding comes out smaller. Runs are taken over horizontal layers, y outermost,
+// because terrain changes far more from one layer to the next than within one.
+void encodeBlocks(ByteWriter &writer, const BlockStorage &blocks);
+
+bool decodeBlocks(ByteReader &reader, BlockStorage &blocks);
+
+// Sorts changes by block index and keeps only the last change to each block, in place
+void coalesceBlockChanges(std::vector<BlockChange> &changes);
+
+// Changes must be coalesced; indices go out as varint gaps from the previous one
+void encodeBlockChanges(ByteWriter &writer, const std::vector<BlockChange> &changes);
+
+bool decodeBlockChanges(ByteReader &reader, std::vector<BlockChange> &changes);
@@ -0,0 +1,84 @@
+#include "ChunkConnectivity.hpp"
+#include <bitset>
+
+namespace {
+  constexpr int CELL_COUNT = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+  constexpr uint8_t ALL_FACES = (1u << FACE_COUNT) - 1;
+
+  constexpr int cellIndex(int x, int y, int z) {
+    return (x * CHUNK_SIZE + y) * CHUNK_SIZE + z;
+  }
+
+  // Faces of the chunk boundary that a cell touches, in FaceMasks order
+  uint8_t boundaryFaces(int x, int y, int z) {
+    uint8_t faces = 0;
+    faces |= (x == CHUNK_SIZE - 1) << 0;
+    faces |= (x == 0) << 1;
+    faces |= (y == CHUNK_SIZE - 1) << 2;
+    faces |= (y == 0) << 3;
+    faces |= (z == CHUNK_SIZE - 1) << 4;
+    faces |= (z == 0) << 5;
+    return faces;
+  }
+}
+
+ChunkConnectivity::ChunkConnectivity() {
+  for (auto &faces : reachable) {
+    faces = ALL_FACES;
+  }
+}
+
+ChunkConnectivity::ChunkConnectivity(const ChunkSnapshot &snapshot) : reachable{} {
+  // Each cell is pushed at most once, so a fixed stack never overflows
+  std::bitset<CELL_COUNT> visited;
+  uint16_t stack[CELL_COUNT];
+  auto stackSize = 0;
+
+  // Flood each air region once; every face it touches can see every other face it touches
+  for (auto x = 0; x < CHUNK_SIZE; ++x) {
+    for (auto y = 0; y < CHUNK_SIZE; ++y) {
+      for (auto z = 0; z < CHUNK_SIZE; ++z) {
+        if (visited[cellIndex(x, y, z)] || snapshot.isSolid(x, y, z)) {
+          continue;
+        }
+
+        uint8_t faces = 0;
+        visited[cellIndex(x, y, z)] = true;
+        stack[stackSize++] = cellIndex(x, y, z);
+
+        while (stackSize > 0) {
+          int cell = stack[--stackSize];
+
+          auto cz = cell % CHUNK_SIZE;
+          auto cy = (cell / CHUNK_SIZE) % CHUNK_SIZE;
+          auto cx = cell / (CHUNK_SIZE * CHUNK_SIZE);
+          faces |= boundaryFaces(cx, cy, cz);
+
+          const glm::ivec3 neighbors[FACE_COUNT] = {
+            {cx + 1, cy, cz}, {cx - 1, cy, cz},
+            {cx, cy + 1, cz}, {cx, cy - 1, cz},
+            {cx, cy, cz + 1}, {cx, cy, cz - 1}
+          };
+          for (const auto &neighbor : neighbors) {
+            if (neighbor.x < 0 || neighbor.x >= CHUNK_SIZE || neighbor.y < 0 || neighbor.y >= CHUNK_SIZE ||
+                neighbor.z < 0 || neighbor.z >= CHUNK_SIZE) {
+              continue;
+            }
+
+            auto index = cellIndex(neighbor.x, neighbor.y, neighbor.z);
+            if (!visited[index] && !snapshot.isSolid(neighbor.x, neighbor.y, neighbor.z)) {
+              visited[index] = true;
+              stack[stackSize++] = static_cast<uint16_t>(index);
+            }
+          }
+        }
+
+        for (auto face = 0; face < FACE_COUNT; ++face) {
+          if ((faces >> face) & 1u) {
+            reachable[face] |= faces;
+          }
+        }
+      }
+    }
+  }
+}
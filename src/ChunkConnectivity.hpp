@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include "ChunkOccupancy.hpp"
+
+// Which pairs of chunk faces are linked by a path through non-solid blocks, for cave culling: a chunk
+// entered through one face can only reveal what lies beyond faces connected to it. Faces follow the
+// FaceMasks order. Default-constructed connectivity links every pair, which is always safe.
+class ChunkConnectivity {
+public:
+  ChunkConnectivity();
+
+  explicit ChunkConnectivity(const ChunkSnapshot &snapshot);
+
+  [[nodiscard]] bool connects(int from, int to) const {
+    return (reachable[from] >> to) & 1u;
+  }
+
+private:
+  uint8_t reachable[FACE_COUNT];
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include "BlockStorage.hpp"
+
+constexpr uint8_t MAX_LIGHT = 15;
+
+// Placed by the player; the only block that gives off light
+constexpr BlockId LAMP_BLOCK = 2;
+
+// Air, terrain and lamps; ids from here on are not blocks the game knows
+constexpr BlockId BLOCK_TYPE_COUNT = LAMP_BLOCK + 1;
+
+[[nodiscard]] constexpr uint8_t getLightEmission(BlockId block) {
+  return block == LAMP_BLOCK ? MAX_LIGHT : 0;
+}
+
+// Every block but air stops light; blocks that stop it hold none, except for what they emit
+[[nodiscard]] constexpr bool isOpaque(BlockId block) {
+  return block != 0;
+}
+
+// Sky light in the high nibble, block light in the low one
+[[nodiscard]] constexpr uint8_t packLight(uint8_t sky, uint8_t block) {
+  return static_cast<uint8_t>(sky << 4 | block);
+}
+
+constexpr uint8_t FULL_SKY_LIGHT = packLight(MAX_LIGHT, 0);
+
+// One packed light byte per block of a chunk, in BlockStorage::index() order
+struct ChunkLight {
+  uint8_t values[CHUNK_VOLUME];
+
+  void fill(uint8_t value) {
+    std::memset(values, value, sizeof(values));
+  }
+};
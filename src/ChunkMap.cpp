@@ -0,0 +1,90 @@
+#include "ChunkMap.hpp"
+#include <bit>
+
+ChunkMap::ChunkMap(size_t initialCapacity) : count(0) {
+  auto capacity = std::bit_ceil(initialCapacity < 8 ? size_t(8) : initialCapacity);
+  slots.resize(capacity);
+  mask = capacity - 1;
+}
+
+size_t ChunkMap::findSlot(ChunkPos position) const {
+  auto index = hashChunkPos(position) & mask;
+  while (slots[index].value && slots[index].key != position) {
+    index = (index + 1) & mask;
+  }
+  return index;
+}
+
+std::shared_ptr<Chunk> ChunkMap::find(ChunkPos position) const {
+  return slots[findSlot(position)].value;
+}
+
+bool ChunkMap::contains(ChunkPos position) const {
+  return slots[findSlot(position)].value != nullptr;
+}
+
+void ChunkMap::insert(ChunkPos position, std::shared_ptr<Chunk> chunk) {
+  if ((count + 1) * 2 > slots.size()) {
+    grow();
+  }
+
+  auto &slot = slots[findSlot(position)];
+  if (!slot.value) {
+    ++count;
+  }
+  slot.key = position;
+  slot.value = std::move(chunk);
+}
+
+bool ChunkMap::erase(ChunkPos position) {
+  auto index = findSlot(position);
+  if (!slots[index].value) {
+    return false;
+  }
+
+  slots[index].value.reset();
+  --count;
+
+  // Shift following entries of the probe run back so lookups never hit a false gap
+  auto hole = index;
+  auto next = (index + 1) & mask;
+  while (slots[next].value) {
+    auto home = hashChunkPos(slots[next].key) & mask;
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      slots[hole] = std::move(slots[next]);
+      slots[next].value.reset();
+      hole = next;
+    }
+    next = (next + 1) & mask;
+  }
+
+  return true;
+}
+
+void ChunkMap::clear() {
+  for (auto &slot: slots) {
+    slot.value.reset();
+  }
+  count = 0;
+}
+
+size_t ChunkMap::size() const {
+  return count;
+}
+
+size_t ChunkMap::capacity() const {
+  return slots.size();
+}
+
+void ChunkMap::grow() {
+  std::vector<Slot> old(slots.size() * 2);
+  old.swap(slots);
+  mask = slots.size() - 1;
+  count = 0;
+
+  for (auto &slot: old) {
+    if (slot.value) {
+      insert(slot.key, std::move(slot.value));
+    }
+  }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "ChunkPos.hpp"
+
+class Chunk;
+
+// Open-addressing hash map from chunk coordinate to chunk, using linear probing
+// and backward-shift deletion so no tombstones accumulate as chunks stream in and out.
+class ChunkMap {
+public:
+  explicit ChunkMap(size_t initialCapacity = 64);
+
+  [[nodiscard]] std::shared_ptr<Chunk> find(ChunkPos position) const;
+
+  [[nodiscard]] bool contains(ChunkPos position) const;
+
+  void insert(ChunkPos position, std::shared_ptr<Chunk> chunk);
+
+  bool erase(ChunkPos position);
+
+  void clear();
+
+  [[nodiscard]] size_t size() const;
+
+  [[nodiscard]] size_t capacity() const;
+
+  template<typename Function>
+  void forEach(Function &&function) const {
+    for (const auto &slot: slots) {
+      if (slot.value) {
+        function(slot.key, slot.value);
+      }
+    }
+  }
+
+private:
+  struct Slot {
+    ChunkPos key;
+    std::shared_ptr<Chunk> value;
+  };
+
+  std::vector<Slot> slots;
+  size_t count;
+  size_t mask;
+
+  [[nodiscard]] size_t findSlot(ChunkPos position) const;
+
+  void grow();
+};
@@ -0,0 +1,487 @@
+#include "ChunkMesher.hpp"
+#include <array>
+#include <bit>
+#include <cstring>
+#include <span>
+
+namespace {
+  // +X, -X, +Y, -Y, +Z, -Z
+  const glm::ivec3 FACE_NORMALS[FACE_COUNT] = {
+    {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+  };
+
+  // Corners a, b, c, d of a unit face, scaled per axis by the quad extent when faces are merged
+  const glm::ivec3 FACE_CORNERS[FACE_COUNT][4] = {
+    {{1, 0, 0}, {1, 1, 0}, {1, 1, 1}, {1, 0, 1}},
+    {{0, 0, 1}, {0, 1, 1}, {0, 1, 0}, {0, 0, 0}},
+    {{0, 1, 1}, {1, 1, 1}, {1, 1, 0}, {0, 1, 0}},
+    {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}},
+    {{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}},
+    {{1, 1, 0}, {0, 1, 0}, {0, 0, 0}, {1, 0, 0}}
+  };
+
+  using OcclusionSamples = std::array<std::array<std::array<glm::ivec3, 3>, 4>, FACE_COUNT>;
+
+  // For each face corner, the two edge neighbours and the diagonal neighbour in the layer the face
+  // looks into, relative to the block that owns the face
+  OcclusionSamples buildOcclusionSamples() {
+    OcclusionSamples samples{};
+    for (auto face = 0; face < FACE_COUNT; ++face) {
+      auto normal = FACE_NORMALS[face];
+      auto n = normal.x != 0 ? 0 : normal.y != 0 ? 1 : 2;
+      auto u = (n + 1) % 3;
+      auto v = (n + 2) % 3;
+
+      for (auto corner = 0; corner < 4; ++corner) {
+        glm::ivec3 sideU(0);
+        glm::ivec3 sideV(0);
+        sideU[u] = FACE_CORNERS[face][corner][u] * 2 - 1;
+        sideV[v] = FACE_CORNERS[face][corner][v] * 2 - 1;
+
+        samples[face][corner] = {normal + sideU, normal + sideV, normal + sideU + sideV};
+      }
+    }
+    return samples;
+  }
+
+  const OcclusionSamples OCCLUSION_SAMPLES = buildOcclusionSamples();
+
+  // Coarse faces skip ambient occlusion, a whole cell would be darkened by a single neighbouring block, and
+  // are lit as if in the open since they are only drawn far away
+  constexpr uint8_t UNOCCLUDED[4] = {3, 3, 3, 3};
+  constexpr uint8_t UNSHADED[4] = {FULL_SKY_LIGHT, FULL_SKY_LIGHT, FULL_SKY_LIGHT, FULL_SKY_LIGHT};
+
+  // Merges runs of equal non-zero keys in the first size x size entries into rectangles, clearing them
+  // as it goes and calling emit(i, j, width, height, key) for each
+  template<typename Emit>
+  void mergeRectangles(BlockId (&keys)[CHUNK_SIZE][CHUNK_SIZE], int size, Emit &&emit) {
+    for (auto j = 0; j < size; ++j) {
+      for (auto i = 0; i < size;) {
+        auto key = keys[i][j];
+        if (key == 0) {
+          ++i;
+          continue;
+        }
+
+        auto width = 1;
+        while (i + width < size && keys[i + width][j] == key) {
+          ++width;
+        }
+
+        auto height = 1;
+        while (j + height < size) {
+          auto rowMatches = true;
+          for (auto k = 0; k < width && rowMatches; ++k) {
+            rowMatches = keys[i + k][j + height] == key;
+          }
+          if (!rowMatches) {
+            break;
+          }
+          ++height;
+        }
+
+        emit(i, j, width, height, key);
+
+        for (auto dj = 0; dj < height; ++dj) {
+          for (auto di = 0; di < width; ++di) {
+            keys[i + di][j + dj] = 0;
+          }
+        }
+
+        i += width;
+      }
+    }
+  }
+}
+
+int chooseLodLevel(int level, float distance, int renderRadius) {
+  auto threshold = [renderRadius](int level) {
+    return LOD_DISTANCE_FRACTIONS[level] * static_cast<float>(renderRadius);
+  };
+
+  while (level < LOD_LEVEL_COUNT - 1 && distance > threshold(level) + LOD_HYSTERESIS) {
+    ++level;
+  }
+  while (level > 0 && distance < threshold(level - 1) - LOD_HYSTERESIS) {
+    --level;
+  }
+  return level;
+}
+
+bool ChunkMesher::FaceKey::operator==(const FaceKey &other) const {
+  return block == other.block && std::memcmp(occlusion, other.occlusion, sizeof(occlusion)) == 0 &&
+         std::memcmp(light, other.light, sizeof(light)) == 0;
+}
+
+ChunkMesher::ChunkMesher(const ChunkSnapshot &snapshot, MeshingMode mode, int lodLevel) : snapshot(snapshot),
+  mode(mode), lodLevel(lodLevel), occupancy(snapshot) {
+}
+
+MeshData ChunkMesher::build() {
+  mesh = MeshData();
+  mesh.lodLevel = lodLevel;
+
+  if (lodLevel > 0) {
+    buildLod();
+    return std::move(mesh);
+  }
+
+  occupancy.computeFaceMasks(faceMasks);
+
+  // The unmerged face count is an upper bound for either mode, so the buffers never regrow
+  size_t faceCount = 0;
+  for (const auto &column: std::span(&faceMasks.faces[0][0][0], FACE_COUNT * CHUNK_SIZE * CHUNK_SIZE)) {
+    faceCount += std::popcount(column);
+  }
+  mesh.vertices.reserve(faceCount * 4);
+  mesh.indices.reserve(faceCount * 6);
+
+  if (mode == MeshingMode::Greedy) {
+    buildGreedy();
+  } else {
+    buildNaive();
+  }
+
+  return std::move(mesh);
+}
+
+void ChunkMesher::buildNaive() {
+  for (auto x = 0; x < CHUNK_SIZE; ++x) {
+    for (auto z = 0; z < CHUNK_SIZE; ++z) {
+      for (auto face = 0; face < FACE_COUNT; ++face) {
+        auto bits = faceMasks.faces[face][x][z];
+        while (bits != 0) {
+          auto y = std::countr_zero(bits);
+          bits &= bits - 1;
+
+          auto key = getFaceKey(face, {x, y, z});
+          addFace(face, {x, y, z}, {1, 1, 1}, key.occlusion, key.light);
+          ++mesh.stats.naiveQuads;
+        }
+      }
+    }
+  }
+}
+
+void ChunkMesher::buildGreedy() {
+  FaceKey mask[CHUNK_SIZE][CHUNK_SIZE];
+  bool present[CHUNK_SIZE][CHUNK_SIZE];
+
+  for (auto face = 0; face < FACE_COUNT; ++face) {
+    auto normal = FACE_NORMALS[face];
+    auto n = normal.x != 0 ? 0 : normal.y != 0 ? 1 : 2;
+    auto u = (n + 1) % 3;
+    auto v = (n + 2) % 3;
+
+    for (auto slice = 0; slice < CHUNK_SIZE; ++slice) {
+      std::memset(present, 0, sizeof(present));
+      auto faceCount = 0;
+
+      // Scatter the set bits of this slice into (i, j) = (position[u], position[v])
+      auto setFace = [&](int i, int j, glm::ivec3 position) {
+        present[i][j] = true;
+        mask[i][j] = getFaceKey(face, position);
+        ++faceCount;
+      };
+
+      if (n == 0) {
+        for (auto z = 0; z < CHUNK_SIZE; ++z) {
+          for (auto bits = faceMasks.faces[face][slice][z]; bits != 0; bits &= bits - 1) {
+            auto y = std::countr_zero(bits);
+            setFace(y, z, {slice, y, z});
+          }
+        }
+      } else if (n == 1) {
+        for (auto x = 0; x < CHUNK_SIZE; ++x) {
+          for (auto z = 0; z < CHUNK_SIZE; ++z) {
+            if ((faceMasks.faces[face][x][z] >> slice) & 1u) {
+              setFace(z, x, {x, slice, z});
+            }
+          }
+        }
+      } else {
+        for (auto x = 0; x < CHUNK_SIZE; ++x) {
+          for (auto bits = faceMasks.faces[face][x][slice]; bits != 0; bits &= bits - 1) {
+            auto y = std::countr_zero(bits);
+            setFace(x, y, {x, y, slice});
+          }
+        }
+      }
+
+      if (faceCount == 0) {
+        continue;
+      }
+      mesh.stats.naiveQuads += faceCount;
+
+      for (auto j = 0; j < CHUNK_SIZE; ++j) {
+        for (auto i = 0; i < CHUNK_SIZE;) {
+          if (!present[i][j]) {
+            ++i;
+            continue;
+          }
+
+          // Neighbouring faces agree on the corners they share, so equal keys mean occlusion and light do not
+          // change along the merge and the merged quad interpolates them exactly as the faces did
+          const auto &key = mask[i][j];
+          auto width = 1;
+          while (i + width < CHUNK_SIZE && present[i + width][j] && mask[i + width][j] == key) {
+            ++width;
+          }
+
+          auto height = 1;
+          while (j + height < CHUNK_SIZE) {
+            auto rowMatches = true;
+            for (auto k = 0; k < width && rowMatches; ++k) {
+              rowMatches = present[i + k][j + height] && mask[i + k][j + height] == key;
+            }
+            if (!rowMatches) {
+              break;
+            }
+            ++height;
+          }
+
+          glm::ivec3 origin;
+          origin[n] = slice;
+          origin[u] = i;
+          origin[v] = j;
+
+          glm::ivec3 extent(1);
+          extent[u] = width;
+          extent[v] = height;
+
+          addFace(face, origin, extent, key.occlusion, key.light);
+
+          for (auto dj = 0; dj < height; ++dj) {
+            for (auto di = 0; di < width; ++di) {
+              present[i + di][j + dj] = false;
+            }
+          }
+
+          i += width;
+        }
+      }
+    }
+  }
+}
+
+void ChunkMesher::buildLod() {
+  auto scale = 1 << lodLevel;
+  auto cellCount = CHUNK_SIZE >> lodLevel;
+
+  // A cell is solid when at least half its blocks are, and shows the highest of them
+  for (auto cx = 0; cx < cellCount; ++cx) {
+    for (auto cy = 0; cy < cellCount; ++cy) {
+      for (auto cz = 0; cz < cellCount; ++cz) {
+        auto solidCount = 0;
+        BlockId top = 0;
+        for (auto y = (cy + 1) * scale - 1; y >= cy * scale; --y) {
+          for (auto x = cx * scale; x < (cx + 1) * scale; ++x) {
+            for (auto z = cz * scale; z < (cz + 1) * scale; ++z) {
+              auto block = snapshot.getBlock(x, y, z);
+              if (block != 0) {
+                ++solidCount;
+                top = top != 0 ? top : block;
+              }
+            }
+          }
+        }
+        lodCells[cx][cy][cz] = solidCount * 2 >= scale * scale * scale ? top : 0;
+      }
+    }
+  }
+
+  BlockId keys[CHUNK_SIZE][CHUNK_SIZE];
+
+  for (auto face = 0; face < FACE_COUNT; ++face) {
+    auto normal = FACE_NORMALS[face];
+    auto n = normal.x != 0 ? 0 : normal.y != 0 ? 1 : 2;
+    auto u = (n + 1) % 3;
+    auto v = (n + 2) % 3;
+
+    // A border cell is hidden only when every neighbour block across from it is solid, since the
+    // neighbour may be drawn at any level
+    auto isBorderCovered = [&](glm::ivec3 cell) {
+      glm::ivec3 position;
+      position[n] = normal[n] > 0 ? CHUNK_SIZE : -1;
+      for (auto a = 0; a < scale; ++a) {
+        for (auto b = 0; b < scale; ++b) {
+          position[u] = cell[u] * scale + a;
+          position[v] = cell[v] * scale + b;
+          if (!occupancy.isSolid(position)) {
+            return false;
+          }
+        }
+      }
+      return true;
+    };
+
+    for (auto slice = 0; slice < cellCount; ++slice) {
+      std::memset(keys, 0, sizeof(keys));
+
+      for (auto i = 0; i < cellCount; ++i) {
+        for (auto j = 0; j < cellCount; ++j) {
+          glm::ivec3 cell;
+          cell[n] = slice;
+          cell[u] = i;
+          cell[v] = j;
+
+          auto block = lodCells[cell.x][cell.y][cell.z];
+          if (block == 0) {
+            continue;
+          }
+
+          auto next = cell + normal;
+          auto hidden = next[n] >= 0 && next[n] < cellCount ? lodCells[next.x][next.y][next.z] != 0
+                                                            : isBorderCovered(cell);
+          if (!hidden) {
+            keys[i][j] = block;
+            ++mesh.stats.naiveQuads;
+          }
+        }
+      }
+
+      mergeRectangles(keys, cellCount, [&](int i, int j, int width, int height, BlockId) {
+        glm::ivec3 origin;
+        origin[n] = slice * scale;
+        origin[u] = i * scale;
+        origin[v] = j * scale;
+
+        glm::ivec3 extent(scale);
+        extent[u] = width * scale;
+        extent[v] = height * scale;
+
+        addFace(face, origin, extent, UNOCCLUDED, UNSHADED);
+      });
+    }
+  }
+
+  addSeams();
+}
+
+void ChunkMesher::addSeams() {
+  // Neighbours hide their faces against this chunk's full-resolution blocks. Where downsampling dropped
+  // one of those border blocks, the hole is closed with the neighbour's face, drawn on the boundary.
+  auto scale = 1 << lodLevel;
+  BlockId keys[CHUNK_SIZE][CHUNK_SIZE];
+
+  for (auto face = 0; face < FACE_COUNT; ++face) {
+    auto normal = FACE_NORMALS[face];
+    auto n = normal.x != 0 ? 0 : normal.y != 0 ? 1 : 2;
+    auto u = (n + 1) % 3;
+    auto v = (n + 2) % 3;
+    auto border = normal[n] > 0 ? CHUNK_SIZE - 1 : 0;
+
+    std::memset(keys, 0, sizeof(keys));
+    for (auto i = 0; i < CHUNK_SIZE; ++i) {
+      for (auto j = 0; j < CHUNK_SIZE; ++j) {
+        glm::ivec3 position;
+        position[n] = border;
+        position[u] = i;
+        position[v] = j;
+
+        auto outside = position + normal;
+        auto cell = position / scale;
+        if (occupancy.isSolid(position) && occupancy.isSolid(outside) && lodCells[cell.x][cell.y][cell.z] == 0) {
+          keys[i][j] = snapshot.getBlock(outside.x, outside.y, outside.z);
+        }
+      }
+    }
+
+    // Faces come in +/- pairs, so face ^ 1 looks back into this chunk
+    mergeRectangles(keys, CHUNK_SIZE, [&](int i, int j, int width, int height, BlockId) {
+      glm::ivec3 origin;
+      origin[n] = border + normal[n];
+      origin[u] = i;
+      origin[v] = j;
+
+      glm::ivec3 extent(1);
+      extent[u] = width;
+      extent[v] = height;
+
+      addFace(face ^ 1, origin, extent, UNOCCLUDED, UNSHADED);
+    });
+  }
+}
+
+ChunkMesher::FaceKey ChunkMesher::getFaceKey(int face, glm::ivec3 position) const {
+  FaceKey key{};
+  key.block = snapshot.getBlock(position.x, position.y, position.z);
+  for (auto corner = 0; corner < 4; ++corner) {
+    key.occlusion[corner] = getOcclusion(face, corner, position);
+    key.light[corner] = getLight(face, corner, position);
+  }
+  return key;
+}
+
+uint8_t ChunkMesher::getOcclusion(int face, int corner, glm::ivec3 position) const {
+  const auto &samples = OCCLUSION_SAMPLES[face][corner];
+  auto side1 = occupancy.isSolid(position + samples[0]);
+  auto side2 = occupancy.isSolid(position + samples[1]);
+  if (side1 && side2) {
+    return 0;
+  }
+
+  auto cornerBlock = occupancy.isSolid(position + samples[2]);
+  return static_cast<uint8_t>(3 - side1 - side2 - cornerBlock);
+}
+
+uint8_t ChunkMesher::getLight(int face, int corner, glm::ivec3 position) const {
+  const auto &samples = OCCLUSION_SAMPLES[face][corner];
+  auto front = position + FACE_NORMALS[face];
+  auto light = snapshot.getLight(front.x, front.y, front.z);
+  auto sky = light >> 4;
+  auto block = light & MAX_LIGHT;
+  auto count = 1;
+
+  // The diagonal is hidden behind two solid sides, as it is for occlusion
+  auto side1 = occupancy.isSolid(position + samples[0]);
+  auto side2 = occupancy.isSolid(position + samples[1]);
+  bool isOpen[3] = {!side1, !side2, (!side1 || !side2) && !occupancy.isSolid(position + samples[2])};
+  for (auto sample = 0; sample < 3; ++sample) {
+    if (isOpen[sample]) {
+      auto at = position + samples[sample];
+      light = snapshot.getLight(at.x, at.y, at.z);
+      sky += light >> 4;
+      block += light & MAX_LIGHT;
+      ++count;
+    }
+  }
+  return packLight(static_cast<uint8_t>(sky / count), static_cast<uint8_t>(block / count));
+}
+
+void ChunkMesher::addFace(int face, glm::ivec3 origin, glm::ivec3 extent, const uint8_t occlusion[4],
+                          const uint8_t light[4]) {
+  uint32_t startIndex = mesh.vertices.size();
+
+  for (auto corner = 0; corner < 4; ++corner) {
+    mesh.vertices.push_back(packVertex(origin + FACE_CORNERS[face][corner] * extent, face, occlusion[corner],
+                                       light[corner]));
+  }
+
+  auto a00 = occlusion[0];
+  auto a01 = occlusion[1];
+  auto a11 = occlusion[2];
+  auto a10 = occlusion[3];
+
+  if (a00 + a11 > a01 + a10) {
+    // Flipped quad
+    mesh.indices.push_back(startIndex);
+    mesh.indices.push_back(startIndex + 1);
+    mesh.indices.push_back(startIndex + 3);
+
+    mesh.indices.push_back(startIndex + 1);
+    mesh.indices.push_back(startIndex + 2);
+    mesh.indices.push_back(startIndex + 3);
+  } else {
+    // Normal quad
+    mesh.indices.push_back(startIndex);
+    mesh.indices.push_back(startIndex + 1);
+    mesh.indices.push_back(startIndex + 2);
+
+    mesh.indices.push_back(startIndex);
+    mesh.indices.push_back(startIndex + 2);
+    mesh.indices.push_back(startIndex + 3);
+  }
+
+  ++mesh.stats.quads;
+}
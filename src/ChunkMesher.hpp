@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include "ChunkOccupancy.hpp"
+#include "ChunkSnapshot.hpp"
+#include "MeshData.hpp"
+
+// Greedy meshing merges faces only where occlusion and light are the same all over, since both are
+// interpolated from the quad corners. That collapses flat, evenly lit ground, but rough or shaded terrain
+// barely shrinks and meshes more slowly than with naive meshing.
+enum class MeshingMode {
+  Naive,
+  Greedy
+};
+
+// Level 0 is full resolution; each level above it merges 2x2x2 cells of the one below
+constexpr int LOD_LEVEL_COUNT = 4;
+
+// Distance from the camera past which chunks switch to each coarser level, as a fraction of the render
+// radius, so every level is in use whatever the view distance
+constexpr float LOD_DISTANCE_FRACTIONS[LOD_LEVEL_COUNT - 1] = {0.4f, 0.6f, 0.8f};
+// A chunk has to move this many chunks past a threshold before it changes level again, so chunks sitting
+// on a threshold are not remeshed back and forth as the camera moves
+constexpr float LOD_HYSTERESIS = 1.0f;
+
+// The level for a chunk at distance chunks from the camera, given the level it is at now
+[[nodiscard]] int chooseLodLevel(int level, float distance, int renderRadius);
+
+class ChunkMesher {
+public:
+  // The mode only applies at level 0, coarser levels are always merged greedily
+  explicit ChunkMesher(const ChunkSnapshot &snapshot, MeshingMode mode = MeshingMode::Naive, int lodLevel = 0);
+
+  MeshData build();
+
+private:
+  // Everything two faces must share to be merged into one quad
+  struct FaceKey {
+    BlockId block;
+    uint8_t occlusion[4];
+    uint8_t light[4];
+
+    bool operator==(const FaceKey &other) const;
+  };
+
+  const ChunkSnapshot &snapshot;
+  MeshingMode mode;
+  int lodLevel;
+  MeshData mesh;
+
+  ChunkOccupancy occupancy;
+  FaceMasks faceMasks;
+
+  // Downsampled blocks for levels above 0, only the first CHUNK_SIZE >> lodLevel entries per axis are used
+  BlockId lodCells[CHUNK_SIZE / 2][CHUNK_SIZE / 2][CHUNK_SIZE / 2];
+
+  void buildNaive();
+
+  void buildGreedy();
+
+  void buildLod();
+
+  void addSeams();
+
+  [[nodiscard]] FaceKey getFaceKey(int face, glm::ivec3 position) const;
+
+  [[nodiscard]] uint8_t getOcclusion(int face, int corner, glm::ivec3 position) const;
+
+  // Smooth light at a face corner: each channel averaged over the open blocks among the ones that also
+  // decide its occlusion, plus the block the face looks into
+  [[nodiscard]] uint8_t getLight(int face, int corner, glm::ivec3 position) const;
+
+  void addFace(int face, glm::ivec3 origin, glm::ivec3 extent, const uint8_t occlusion[4], const uint8_t light[4]);
+};
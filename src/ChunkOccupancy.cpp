@@ -0,0 +1,136 @@
+#include "ChunkOccupancy.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace {
+  constexpr uint32_t CHUNK_COLUMN_MASK = (1u << CHUNK_SIZE) - 1;
+
+  // Minimal lane abstraction over the widest integer SIMD available at compile time
+#if defined(__AVX2__)
+  using Lanes = __m256i;
+  constexpr int LANE_COUNT = 8;
+
+  inline Lanes load(const uint32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+
+  inline void store(uint32_t *p, Lanes v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+
+  inline Lanes splat(uint32_t v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+
+  inline Lanes andNot(Lanes a, Lanes b) { return _mm256_andnot_si256(b, a); }
+
+  inline Lanes bitAnd(Lanes a, Lanes b) { return _mm256_and_si256(a, b); }
+
+  template<int N>
+  inline Lanes shiftLeft(Lanes v) { return _mm256_slli_epi32(v, N); }
+
+  template<int N>
+  inline Lanes shiftRight(Lanes v) { return _mm256_srli_epi32(v, N); }
+#elif defined(__SSE2__) || defined(_M_X64)
+  using Lanes = __m128i;
+  constexpr int LANE_COUNT = 4;
+
+  inline Lanes load(const uint32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+
+  inline void store(uint32_t *p, Lanes v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+
+  inline Lanes splat(uint32_t v) { return _mm_set1_epi32(static_cast<int>(v)); }
+
+  inline Lanes andNot(Lanes a, Lanes b) { return _mm_andnot_si128(b, a); }
+
+  inline Lanes bitAnd(Lanes a, Lanes b) { return _mm_and_si128(a, b); }
+
+  template<int N>
+  inline Lanes shiftLeft(Lanes v) { return _mm_slli_epi32(v, N); }
+
+  template<int N>
+  inline Lanes shiftRight(Lanes v) { return _mm_srli_epi32(v, N); }
+#elif defined(__wasm_simd128__)
+  using Lanes = v128_t;
+  constexpr int LANE_COUNT = 4;
+
+  inline Lanes load(const uint32_t *p) { return wasm_v128_load(p); }
+
+  inline void store(uint32_t *p, Lanes v) { wasm_v128_store(p, v); }
+
+  inline Lanes splat(uint32_t v) { return wasm_u32x4_splat(v); }
+
+  inline Lanes andNot(Lanes a, Lanes b) { return wasm_v128_andnot(a, b); }
+
+  inline Lanes bitAnd(Lanes a, Lanes b) { return wasm_v128_and(a, b); }
+
+  template<int N>
+  inline Lanes shiftLeft(Lanes v) { return wasm_i32x4_shl(v, N); }
+
+  template<int N>
+  inline Lanes shiftRight(Lanes v) { return wasm_u32x4_shr(v, N); }
+#else
+  using Lanes = uint32_t;
+  constexpr int LANE_COUNT = 1;
+
+  inline Lanes load(const uint32_t *p) { return *p; }
+
+  inline void store(uint32_t *p, Lanes v) { *p = v; }
+
+  inline Lanes splat(uint32_t v) { return v; }
+
+  inline Lanes andNot(Lanes a, Lanes b) { return a & ~b; }
+
+  inline Lanes bitAnd(Lanes a, Lanes b) { return a & b; }
+
+  template<int N>
+  inline Lanes shiftLeft(Lanes v) { return v << N; }
+
+  template<int N>
+  inline Lanes shiftRight(Lanes v) { return v >> N; }
+#endif
+
+  static_assert(CHUNK_SIZE % LANE_COUNT == 0);
+}
+
+ChunkOccupancy::ChunkOccupancy(const ChunkSnapshot &snapshot) {
+  for (auto x = 0; x < SNAPSHOT_SIZE; ++x) {
+    for (auto z = 0; z < SNAPSHOT_SIZE; ++z) {
+      columns[x][z] = 0;
+    }
+
+    // z is the contiguous axis in both layouts, so this loop vectorizes
+    for (auto y = 0; y < SNAPSHOT_SIZE; ++y) {
+      for (auto z = 0; z < SNAPSHOT_SIZE; ++z) {
+        columns[x][z] |= static_cast<uint32_t>(snapshot.blocks[x][y][z] != 0) << y;
+      }
+    }
+  }
+}
+
+void ChunkOccupancy::computeFaceMasks(FaceMasks &masks) const {
+  auto chunkMask = splat(CHUNK_COLUMN_MASK);
+
+  for (auto x = 0; x < CHUNK_SIZE; ++x) {
+    const auto *row = &columns[x + SNAPSHOT_PADDING][SNAPSHOT_PADDING];
+    const auto *rowPositiveX = &columns[x + SNAPSHOT_PADDING + 1][SNAPSHOT_PADDING];
+    const auto *rowNegativeX = &columns[x + SNAPSHOT_PADDING - 1][SNAPSHOT_PADDING];
+
+    for (auto z = 0; z < CHUNK_SIZE; z += LANE_COUNT) {
+      auto solid = load(row + z);
+
+      Lanes exposed[FACE_COUNT] = {
+        andNot(solid, load(rowPositiveX + z)),
+        andNot(solid, load(rowNegativeX + z)),
+        andNot(solid, shiftRight<1>(solid)),
+        andNot(solid, shiftLeft<1>(solid)),
+        andNot(solid, load(row + z + 1)),
+        andNot(solid, load(row + z - 1))
+      };
+
+      for (auto face = 0; face < FACE_COUNT; ++face) {
+        store(&masks.faces[face][x][z], bitAnd(shiftRight<SNAPSHOT_PADDING>(exposed[face]), chunkMask));
+      }
+    }
+  }
+}
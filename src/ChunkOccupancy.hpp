@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include "ChunkSnapshot.hpp"
+
+constexpr int FACE_COUNT = 6;
+
+static_assert(SNAPSHOT_SIZE <= 32, "occupancy columns are stored as uint32");
+
+// Per-face exposure bits for the chunk interior, indexed [face][x][z] with bit y set when the block at
+// (x, y, z) is solid and its neighbour in that face's direction is not. Faces are +X, -X, +Y, -Y, +Z, -Z.
+struct FaceMasks {
+  alignas(32) uint32_t faces[FACE_COUNT][CHUNK_SIZE][CHUNK_SIZE];
+};
+
+// Snapshot solidity as one bit column per (x, z), bit y + SNAPSHOT_PADDING set for a solid block.
+class ChunkOccupancy {
+public:
+  explicit ChunkOccupancy(const ChunkSnapshot &snapshot);
+
+  [[nodiscard]] bool isSolid(int x, int y, int z) const {
+    x += SNAPSHOT_PADDING;
+    y += SNAPSHOT_PADDING;
+    z += SNAPSHOT_PADDING;
+    if (x < 0 || x >= SNAPSHOT_SIZE || y < 0 || y >= SNAPSHOT_SIZE || z < 0 || z >= SNAPSHOT_SIZE) {
+      return false;
+    }
+    return (columns[x][z] >> y) & 1u;
+  }
+
+  [[nodiscard]] bool isSolid(glm::ivec3 position) const {
+    return isSolid(position.x, position.y, position.z);
+  }
+
+  void computeFaceMasks(FaceMasks &masks) const;
+
+private:
+  alignas(32) uint32_t columns[SNAPSHOT_SIZE][SNAPSHOT_SIZE];
+};
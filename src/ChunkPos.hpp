@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+constexpr int CHUNK_SIZE = 16;
+
+// The world is a stack of WORLD_HEIGHT_CHUNKS chunks in every column, starting at y = 0
+constexpr int WORLD_HEIGHT_CHUNKS = 16;
+constexpr int WORLD_HEIGHT = WORLD_HEIGHT_CHUNKS * CHUNK_SIZE;
+
+using BlockId = uint16_t;
+
+using ChunkPos = glm::ivec3;
+
+// Horizontal position of a column of chunks, x and z in chunks
+using ColumnPos = glm::ivec2;
+
+constexpr int floorDiv(int value, int divisor) {
+  int quotient = value / divisor;
+  return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+}
+
+constexpr int floorMod(int value, int divisor) {
+  return value - floorDiv(value, divisor) * divisor;
+}
+
+inline ChunkPos chunkContaining(glm::ivec3 block) {
+  return {floorDiv(block.x, CHUNK_SIZE), floorDiv(block.y, CHUNK_SIZE), floorDiv(block.z, CHUNK_SIZE)};
+}
+
+inline ColumnPos columnOf(ChunkPos position) {
+  return {position.x, position.z};
+}
+
+inline size_t hashChunkPos(ChunkPos position) {
+  auto h = static_cast<uint64_t>(static_cast<uint32_t>(position.x)) * 0x9E3779B97F4A7C15ull;
+  h ^= static_cast<uint64_t>(static_cast<uint32_t>(position.y)) * 0xD6E8FEB86659FD93ull;
+  h ^= static_cast<uint64_t>(static_cast<uint32_t>(position.z)) * 0xC2B2AE3D27D4EB4Full;
+  h ^= h >> 29;
+  return static_cast<size_t>(h);
+}
+
+inline size_t hashColumnPos(ColumnPos position) {
+  return hashChunkPos({position.x, 0, position.y});
+}
+
+struct ChunkPosHash {
+  size_t operator()(ChunkPos position) const {
+    return hashChunkPos(position);
+  }
+};
+
+struct ColumnPosHash {
+  size_t operator()(ColumnPos position) const {
+    return hashColumnPos(position);
+  }
+};
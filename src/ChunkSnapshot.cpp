@@ -0,0 +1,47 @@
+#include "ChunkSnapshot.hpp"
+#include <cstring>
+
+void ChunkSnapshot::fill(const BlockStorage *const neighbors[3][3][3]) {
+  for (auto x = 0; x < SNAPSHOT_SIZE; ++x) {
+    auto localX = x - SNAPSHOT_PADDING;
+    auto chunkX = floorDiv(localX, CHUNK_SIZE) + 1;
+    localX = floorMod(localX, CHUNK_SIZE);
+
+    for (auto y = 0; y < SNAPSHOT_SIZE; ++y) {
+      auto localY = y - SNAPSHOT_PADDING;
+      auto chunkY = floorDiv(localY, CHUNK_SIZE) + 1;
+      localY = floorMod(localY, CHUNK_SIZE);
+
+      for (auto z = 0; z < SNAPSHOT_SIZE; ++z) {
+        auto localZ = z - SNAPSHOT_PADDING;
+        const auto *chunk = neighbors[chunkX][chunkY][floorDiv(localZ, CHUNK_SIZE) + 1];
+        localZ = floorMod(localZ, CHUNK_SIZE);
+        blocks[x][y][z] = chunk ? chunk->get(BlockStorage::index(localX, localY, localZ)) : 0;
+      }
+    }
+  }
+  std::memset(light, FULL_SKY_LIGHT, sizeof(light));
+}
+
+void ChunkSnapshot::fillLight(const ChunkLight *const neighbors[3][3][3], const uint8_t missing[3][3][3]) {
+  for (auto x = 0; x < SNAPSHOT_SIZE; ++x) {
+    auto localX = x - SNAPSHOT_PADDING;
+    auto chunkX = floorDiv(localX, CHUNK_SIZE) + 1;
+    localX = floorMod(localX, CHUNK_SIZE);
+
+    for (auto y = 0; y < SNAPSHOT_SIZE; ++y) {
+      auto localY = y - SNAPSHOT_PADDING;
+      auto chunkY = floorDiv(localY, CHUNK_SIZE) + 1;
+      localY = floorMod(localY, CHUNK_SIZE);
+
+      for (auto z = 0; z < SNAPSHOT_SIZE; ++z) {
+        auto localZ = z - SNAPSHOT_PADDING;
+        auto chunkZ = floorDiv(localZ, CHUNK_SIZE) + 1;
+        const auto *chunk = neighbors[chunkX][chunkY][chunkZ];
+        localZ = floorMod(localZ, CHUNK_SIZE);
+        light[x][y][z] = chunk ? chunk->values[BlockStorage::index(localX, localY, localZ)]
+                               : missing[chunkX][chunkY][chunkZ];
+      }
+    }
+  }
+}
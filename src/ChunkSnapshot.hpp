@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include "BlockStorage.hpp"
+#include "ChunkLight.hpp"
+#include "ChunkPos.hpp"
+
+constexpr int SNAPSHOT_PADDING = 1;
+constexpr int SNAPSHOT_SIZE = CHUNK_SIZE + SNAPSHOT_PADDING * 2;
+
+// Copy of a chunk's blocks and light plus a border taken from its neighbours, so meshing can run on a
+// worker thread without touching live chunk data.
+struct ChunkSnapshot {
+  BlockId blocks[SNAPSHOT_SIZE][SNAPSHOT_SIZE][SNAPSHOT_SIZE];
+  uint8_t light[SNAPSHOT_SIZE][SNAPSHOT_SIZE][SNAPSHOT_SIZE];
+
+  // Copies the chunk at neighbors[1][1][1] and the border from the chunks around it, indexed
+  // [dx + 1][dy + 1][dz + 1]; missing neighbours read as air. Light is left at full sky light.
+  void fill(const BlockStorage *const neighbors[3][3][3]);
+
+  // Copies light the same way, with missing neighbours reading as their entry in missing
+  void fillLight(const ChunkLight *const neighbors[3][3][3], const uint8_t missing[3][3][3]);
+
+  [[nodiscard]] BlockId getBlock(int x, int y, int z) const {
+    x += SNAPSHOT_PADDING;
+    y += SNAPSHOT_PADDING;
+    z += SNAPSHOT_PADDING;
+    if (x < 0 || x >= SNAPSHOT_SIZE || y < 0 || y >= SNAPSHOT_SIZE || z < 0 || z >= SNAPSHOT_SIZE) {
+      return 0;
+    }
+    return blocks[x][y][z];
+  }
+
+  // Packed as by packLight()
+  [[nodiscard]] uint8_t getLight(int x, int y, int z) const {
+    x += SNAPSHOT_PADDING;
+    y += SNAPSHOT_PADDING;
+    z += SNAPSHOT_PADDING;
+    if (x < 0 || x >= SNAPSHOT_SIZE || y < 0 || y >= SNAPSHOT_SIZE || z < 0 || z >= SNAPSHOT_SIZE) {
+      return FULL_SKY_LIGHT;
+    }
+    return light[x][y][z];
+  }
+
+  [[nodiscard]] bool isSolid(int x, int y, int z) const {
+    return getBlock(x, y, z) != 0;
+  }
+};
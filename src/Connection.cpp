@@ -0,0 +1,120 @@
+#include "Connection.hpp"
+#include <algorithm>
+
+namespace {
+  constexpr size_t RECEIVE_CHUNK_SIZE = 64 * 1024;
+
+  // Sent bytes are only shifted out of the buffer once this many have piled up at its front
+  constexpr size_t SEND_COMPACT_THRESHOLD = 64 * 1024;
+}
+
+Connection::Connection(Socket socket) : socket(std::move(socket)) {
+}
+
+bool Connection::receive() {
+  if (!socket.isValid() || failed) {
+    return false;
+  }
+
+  // Messages handed out by nextMessage() are done with by now
+  receiveBuffer.erase(receiveBuffer.begin(), receiveBuffer.begin() + static_cast<ptrdiff_t>(receiveOffset));
+  receiveOffset = 0;
+
+  while (true) {
+    auto used = receiveBuffer.size();
+    receiveBuffer.resize(used + RECEIVE_CHUNK_SIZE);
+    auto result = socket.receive(receiveBuffer.data() + used, RECEIVE_CHUNK_SIZE);
+    receiveBuffer.resize(used + std::max(result, ptrdiff_t(0)));
+
+    if (result == SOCKET_WOULD_BLOCK) {
+      return true;
+    }
+    if (result < 0) {
+      failed = true;
+      return false;
+    }
+    bytesReceived += result;
+  }
+}
+
+bool Connection::nextMessage(MessageType &type, ByteReader &payload) {
+  auto available = receiveBuffer.size() - receiveOffset;
+  if (failed || available < MESSAGE_HEADER_SIZE) {
+    return false;
+  }
+
+  ByteReader header(receiveBuffer.data() + receiveOffset, available);
+  auto length = header.readU32();
+  if (length == 0 || length > MAX_MESSAGE_SIZE) {
+    failed = true;
+    return false;
+  }
+  if (available < sizeof(uint32_t) + length) {
+    return false;
+  }
+
+  type = static_cast<MessageType>(header.readU8());
+  payload = ByteReader(receiveBuffer.data() + receiveOffset + MESSAGE_HEADER_SIZE, length - 1);
+  receiveOffset += sizeof(uint32_t) + length;
+  return true;
+}
+
+std::vector<uint8_t> &Connection::getSendBuffer() {
+  return sendBuffer;
+}
+
+void Connection::queue(const uint8_t *data, size_t size) {
+  sendBuffer.insert(sendBuffer.end(), data, data + size);
+}
+
+bool Connection::flush() {
+  if (!socket.isValid() || failed) {
+    return false;
+  }
+
+  while (sendOffset < sendBuffer.size()) {
+    auto result = socket.send(sendBuffer.data() + sendOffset, sendBuffer.size() - sendOffset);
+    if (result == SOCKET_WOULD_BLOCK) {
+      break;
+    }
+    if (result < 0) {
+      failed = true;
+      return false;
+    }
+    sendOffset += result;
+    bytesSent += result;
+  }
+
+  if (sendOffset == sendBuffer.size()) {
+    sendBuffer.clear();
+    sendOffset = 0;
+  } else if (sendOffset >= SEND_COMPACT_THRESHOLD) {
+    sendBuffer.erase(sendBuffer.begin(), sendBuffer.begin() + static_cast<ptrdiff_t>(sendOffset));
+    sendOffset = 0;
+  }
+  return true;
+}
+
+size_t Connection::getQueuedBytes() const {
+  return sendBuffer.size() - sendOffset;
+}
+
+uint64_t Connection::getBytesSent() const {
+  return bytesSent;
+}
+
+uint64_t Connection::getBytesReceived() const {
+  return bytesReceived;
+}
+
+const Socket &Connection::getSocket() const {
+  return socket;
+}
+
+bool Connection::isOpen() const {
+  return socket.isValid() && !failed;
+}
+
+void Connection::close() {
+  socket.close();
+}
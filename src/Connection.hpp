@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "ByteBuffer.hpp"
+#include "Protocol.hpp"
+#include "Socket.hpp"
+
+// A non-blocking TCP stream split into framed messages. Incoming bytes are buffered until a whole message
+// has arrived; outgoing messages are buffered until the socket accepts them, so a slow peer never blocks
+// the caller and getQueuedBytes() tells how far behind it is.
+class Connection {
+public:
+  Connection() = default;
+
+  explicit Connection(Socket socket);
+
+  // Reads everything the socket has; returns false once the peer has gone or sent a malformed frame
+  bool receive();
+
+  // Pops the next complete message. The payload reader stays valid until the next receive().
+  bool nextMessage(MessageType &type, ByteReader &payload);
+
+  // Messages are written straight into this buffer with the write* functions from Protocol.hpp
+  [[nodiscard]] std::vector<uint8_t> &getSendBuffer();
+
+  void queue(const uint8_t *data, size_t size);
+
+  // Writes as much as the socket accepts; returns false once the peer has gone
+  bool flush();
+
+  [[nodiscard]] size_t getQueuedBytes() const;
+
+  [[nodiscard]] uint64_t getBytesSent() const;
+
+  [[nodiscard]] uint64_t getBytesReceived() const;
+
+  [[nodiscard]] const Socket &getSocket() const;
+
+  [[nodiscard]] bool isOpen() const;
+
+  void close();
+
+private:
+  Socket socket;
+
+  std::vector<uint8_t> receiveBuffer;
+  size_t receiveOffset = 0;
+
+  std::vector<uint8_t> sendBuffer;
+  size_t sendOffset = 0;
+
+  uint64_t bytesSent = 0;
+  uint64_t bytesReceived = 0;
+  bool failed = false;
+};
@@ -0,0 +1,132 @@
+#include "FrameGraph.hpp"
+
+#ifdef NETBLOCKS_PROFILER
+
+#include <algorithm>
+
+namespace {
+  struct ZoneColor {
+    const char *name;
+    glm::vec3 color;
+  };
+
+  const ZoneColor ZONE_COLORS[] = {
+    {"red", {0.90f, 0.30f, 0.25f}},
+    {"green", {0.35f, 0.80f, 0.35f}},
+    {"blue", {0.30f, 0.50f, 0.95f}},
+    {"yellow", {0.95f, 0.85f, 0.25f}},
+    {"magenta", {0.85f, 0.35f, 0.85f}},
+    {"cyan", {0.30f, 0.85f, 0.90f}},
+    {"orange", {0.95f, 0.60f, 0.20f}},
+    {"purple", {0.55f, 0.40f, 0.90f}}
+  };
+  constexpr size_t ZONE_COLOR_COUNT = sizeof(ZONE_COLORS) / sizeof(ZONE_COLORS[0]);
+
+  const glm::vec3 BACKGROUND_COLOR(0.08f, 0.08f, 0.10f);
+  const glm::vec3 UNTRACKED_COLOR(0.45f, 0.45f, 0.45f);
+  const glm::vec3 GPU_COLOR(1.0f);
+  const glm::vec3 GUIDE_COLOR(0.7f, 0.7f, 0.7f);
+
+  // Position xy, color rgb
+  constexpr int FLOATS_PER_VERTEX = 5;
+}
+
+FrameGraph::FrameGraph(std::shared_ptr<Shader> shader) : shader(std::move(shader)) {
+  glGenVertexArrays(1, &vao);
+  glGenBuffers(1, &vbo);
+
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), nullptr);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float),
+                        reinterpret_cast<void *>(2 * sizeof(float)));
+  glEnableVertexAttribArray(1);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+}
+
+FrameGraph::~FrameGraph() {
+  glDeleteBuffers(1, &vbo);
+  glDeleteVertexArrays(1, &vao);
+}
+
+void FrameGraph::render(const Profiler &profiler, int windowWidth, int windowHeight) {
+  const auto &history = profiler.getHistory();
+  auto pixelsPerNanosecond = FRAME_GRAPH_HEIGHT / (FRAME_GRAPH_BUDGET_MS * 1e6f);
+  auto barHeight = [pixelsPerNanosecond](uint64_t nanoseconds) {
+    return std::min(static_cast<float>(nanoseconds) * pixelsPerNanosecond, FRAME_GRAPH_HEIGHT);
+  };
+
+  vertices.clear();
+  auto left = FRAME_GRAPH_MARGIN;
+  auto bottom = FRAME_GRAPH_MARGIN;
+  addRect(left, bottom, PROFILER_HISTORY_FRAMES * FRAME_GRAPH_BAR_WIDTH, FRAME_GRAPH_HEIGHT, BACKGROUND_COLOR);
+
+  auto x = left + static_cast<float>(PROFILER_HISTORY_FRAMES - history.size()) * FRAME_GRAPH_BAR_WIDTH;
+  for (const auto &frame: history) {
+    uint64_t tracked = 0;
+    auto y = bottom;
+    for (size_t zone = 0; zone < profiler.getZoneCount() && zone < PROFILER_MAX_ZONES; ++zone) {
+      if (frame.mainThread[zone] == 0) {
+        continue;
+      }
+      auto top = bottom + barHeight(tracked + frame.mainThread[zone]);
+      addRect(x, y, FRAME_GRAPH_BAR_WIDTH, top - y, getZoneColor(zone));
+      tracked += frame.mainThread[zone];
+      y = top;
+    }
+
+    auto frameTop = bottom + barHeight(frame.duration);
+    if (frameTop > y) {
+      addRect(x, y, FRAME_GRAPH_BAR_WIDTH, frameTop - y, UNTRACKED_COLOR);
+    }
+
+    uint64_t gpuTime = 0;
+    for (auto time: frame.gpu) {
+      gpuTime += time;
+    }
+    if (gpuTime > 0) {
+      addRect(x, bottom + barHeight(gpuTime) - 1.0f, FRAME_GRAPH_BAR_WIDTH, 1.0f, GPU_COLOR);
+    }
+
+    x += FRAME_GRAPH_BAR_WIDTH;
+  }
+
+  auto width = PROFILER_HISTORY_FRAMES * FRAME_GRAPH_BAR_WIDTH;
+  addRect(left, bottom + FRAME_GRAPH_HEIGHT / 2.0f, width, 1.0f, GUIDE_COLOR);
+  addRect(left, bottom + FRAME_GRAPH_HEIGHT - 1.0f, width, 1.0f, GUIDE_COLOR);
+
+  glDisable(GL_DEPTH_TEST);
+  shader->use();
+  shader->setVec2("screenSize", glm::vec2(windowWidth, windowHeight));
+
+  glBindVertexArray(vao);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(float)), vertices.data(),
+               GL_STREAM_DRAW);
+  glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices.size() / FLOATS_PER_VERTEX));
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+  glEnable(GL_DEPTH_TEST);
+}
+
+glm::vec3 FrameGraph::getZoneColor(size_t zone) {
+  return ZONE_COLORS[zone % ZONE_COLOR_COUNT].color;
+}
+
+const char *FrameGraph::getZoneColorName(size_t zone) {
+  return ZONE_COLORS[zone % ZONE_COLOR_COUNT].name;
+}
+
+void FrameGraph::addRect(float x, float y, float width, float height, glm::vec3 color) {
+  const glm::vec2 corners[6] = {
+    {x, y}, {x + width, y}, {x + width, y + height},
+    {x, y}, {x + width, y + height}, {x, y + height}
+  };
+  for (auto corner: corners) {
+    vertices.insert(vertices.end(), {corner.x, corner.y, color.r, color.g, color.b});
+  }
+}
+
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#ifdef NETBLOCKS_PROFILER
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "gl.hpp"
+#include "Profiler.hpp"
+#include "Shader.hpp"
+
+// Frame time that fills the graph's full height
+constexpr float FRAME_GRAPH_BUDGET_MS = 1000.0f / 30.0f;
+constexpr float FRAME_GRAPH_HEIGHT = 120.0f;
+constexpr float FRAME_GRAPH_BAR_WIDTH = 2.0f;
+constexpr float FRAME_GRAPH_MARGIN = 8.0f;
+
+// Rolling graph of the profiler's frame history in the bottom-left corner. Each frame is a bar stacked from
+// the main thread's zones in their zone colours, topped in grey up to the full frame time, with a white tick
+// at the frame's GPU time. Lines mark 60 and 30 fps.
+class FrameGraph {
+public:
+  explicit FrameGraph(std::shared_ptr<Shader> shader);
+
+  ~FrameGraph();
+
+  FrameGraph(const FrameGraph &) = delete;
+
+  FrameGraph &operator=(const FrameGraph &) = delete;
+
+  void render(const Profiler &profiler, int windowWidth, int windowHeight);
+
+  [[nodiscard]] static glm::vec3 getZoneColor(size_t zone);
+
+  [[nodiscard]] static const char *getZoneColorName(size_t zone);
+
+private:
+  std::shared_ptr<Shader> shader;
+  GLuint vao = 0;
+  GLuint vbo = 0;
+  std::vector<float> vertices;
+
+  void addRect(float x, float y, float width, float height, glm::vec3 color);
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include "FreeListAllocator.hpp"
+#include <algorithm>
+
+FreeListAllocator::FreeListAllocator(uint32_t capacity) : capacity(capacity), used(0), allocationCount(0) {
+  if (capacity > 0) {
+    freeBlocks.emplace(0, capacity);
+  }
+}
+
+bool FreeListAllocator::allocate(uint32_t size, uint32_t &offset) {
+  if (size == 0) {
+    return false;
+  }
+
+  auto best = freeBlocks.end();
+  for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it) {
+    if (it->second >= size && (best == freeBlocks.end() || it->second < best->second)) {
+      best = it;
+      if (it->second == size) {
+        break;
+      }
+    }
+  }
+
+  if (best == freeBlocks.end()) {
+    return false;
+  }
+
+  offset = best->first;
+  auto remaining = best->second - size;
+  freeBlocks.erase(best);
+  if (remaining > 0) {
+    freeBlocks.emplace(offset + size, remaining);
+  }
+
+  used += size;
+  ++allocationCount;
+  return true;
+}
+
+void FreeListAllocator::free(uint32_t offset, uint32_t size) {
+  if (size == 0) {
+    return;
+  }
+
+  insertFreeBlock(offset, size);
+  used -= size;
+  --allocationCount;
+}
+
+void FreeListAllocator::grow(uint32_t newCapacity) {
+  if (newCapacity <= capacity) {
+    return;
+  }
+
+  insertFreeBlock(capacity, newCapacity - capacity);
+  capacity = newCapacity;
+}
+
+void FreeListAllocator::insertFreeBlock(uint32_t offset, uint32_t size) {
+  auto next = freeBlocks.lower_bound(offset);
+
+  // Merge with the following block
+  if (next != freeBlocks.end() && offset + size == next->first) {
+    size += next->second;
+    next = freeBlocks.erase(next);
+  }
+
+  // Merge with the preceding block
+  if (next != freeBlocks.begin()) {
+    auto previous = std::prev(next);
+    if (previous->first + previous->second == offset) {
+      previous->second += size;
+      return;
+    }
+  }
+
+  freeBlocks.emplace_hint(next, offset, size);
+}
+
+uint32_t FreeListAllocator::getCapacity() const {
+  return capacity;
+}
+
+uint32_t FreeListAllocator::getUsed() const {
+  return used;
+}
+
+uint32_t FreeListAllocator::getLargestFreeBlock() const {
+  uint32_t largest = 0;
+  for (const auto &[offset, size]: freeBlocks) {
+    largest = std::max(largest, size);
+  }
+  return largest;
+}
+
+uint32_t FreeListAllocator::getAllocationCount() const {
+  return allocationCount;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+// Best-fit range allocator with coalescing, used to sub-allocate large GPU buffers. Offsets and sizes
+// are in caller-defined units; it never touches the memory it manages.
+class FreeListAllocator {
+public:
+  explicit FreeListAllocator(uint32_t capacity);
+
+  [[nodiscard]] bool allocate(uint32_t size, uint32_t &offset);
+
+  void free(uint32_t offset, uint32_t size);
+
+  void grow(uint32_t newCapacity);
+
+  [[nodiscard]] uint32_t getCapacity() const;
+
+  [[nodiscard]] uint32_t getUsed() const;
+
+  [[nodiscard]] uint32_t getLargestFreeBlock() const;
+
+  [[nodiscard]] uint32_t getAllocationCount() const;
+
+private:
+  std::map<uint32_t, uint32_t> freeBlocks;
+  uint32_t capacity;
+  uint32_t used;
+  uint32_t allocationCount;
+
+  void insertFreeBlock(uint32_t offset, uint32_t size);
+};
@@ -0,0 +1,163 @@
+#include "Frustum.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace {
+  // Float counterpart of the lane abstraction in ChunkOccupancy.cpp
+#if defined(__AVX2__)
+  using Lanes = __m256;
+  constexpr int LANE_COUNT = 8;
+
+  inline Lanes load(const float *p) { return _mm256_loadu_ps(p); }
+
+  inline Lanes splat(float v) { return _mm256_set1_ps(v); }
+
+  inline Lanes add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+
+  inline Lanes mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+
+  inline Lanes isNonNegative(Lanes v) { return _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GE_OQ); }
+
+  inline Lanes bitAnd(Lanes a, Lanes b) { return _mm256_and_ps(a, b); }
+
+  inline Lanes allSet() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+
+  inline uint32_t laneMask(Lanes v) { return static_cast<uint32_t>(_mm256_movemask_ps(v)); }
+#elif defined(__SSE2__) || defined(_M_X64)
+  using Lanes = __m128;
+  constexpr int LANE_COUNT = 4;
+
+  inline Lanes load(const float *p) { return _mm_loadu_ps(p); }
+
+  inline Lanes splat(float v) { return _mm_set1_ps(v); }
+
+  inline Lanes add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+
+  inline Lanes mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+
+  inline Lanes isNonNegative(Lanes v) { return _mm_cmpge_ps(v, _mm_setzero_ps()); }
+
+  inline Lanes bitAnd(Lanes a, Lanes b) { return _mm_and_ps(a, b); }
+
+  inline Lanes allSet() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+
+  inline uint32_t laneMask(Lanes v) { return static_cast<uint32_t>(_mm_movemask_ps(v)); }
+#elif defined(__wasm_simd128__)
+  using Lanes = v128_t;
+  constexpr int LANE_COUNT = 4;
+
+  inline Lanes load(const float *p) { return wasm_v128_load(p); }
+
+  inline Lanes splat(float v) { return wasm_f32x4_splat(v); }
+
+  inline Lanes add(Lanes a, Lanes b) { return wasm_f32x4_add(a, b); }
+
+  inline Lanes mul(Lanes a, Lanes b) { return wasm_f32x4_mul(a, b); }
+
+  inline Lanes isNonNegative(Lanes v) { return wasm_f32x4_ge(v, wasm_f32x4_splat(0.0f)); }
+
+  inline Lanes bitAnd(Lanes a, Lanes b) { return wasm_v128_and(a, b); }
+
+  inline Lanes allSet() { return wasm_i32x4_splat(-1); }
+
+  inline uint32_t laneMask(Lanes v) { return wasm_i32x4_bitmask(v); }
+#else
+  using Lanes = float;
+  constexpr int LANE_COUNT = 1;
+
+  inline Lanes load(const float *p) { return *p; }
+
+  inline Lanes splat(float v) { return v; }
+
+  inline Lanes add(Lanes a, Lanes b) { return a + b; }
+
+  inline Lanes mul(Lanes a, Lanes b) { return a * b; }
+
+  inline Lanes isNonNegative(Lanes v) { return v >= 0.0f ? 1.0f : 0.0f; }
+
+  inline Lanes bitAnd(Lanes a, Lanes b) { return a != 0.0f && b != 0.0f ? 1.0f : 0.0f; }
+
+  inline Lanes allSet() { return 1.0f; }
+
+  inline uint32_t laneMask(Lanes v) { return v != 0.0f ? 1u : 0u; }
+#endif
+
+  // The corner furthest along the plane normal sits at a fixed offset from the box minimum when every
+  // box has the same extent, so that offset folds into the plane constant
+  float positiveVertexOffset(glm::vec4 plane, glm::vec3 extent) {
+    auto offset = plane.w;
+    offset += plane.x >= 0.0f ? plane.x * extent.x : 0.0f;
+    offset += plane.y >= 0.0f ? plane.y * extent.y : 0.0f;
+    offset += plane.z >= 0.0f ? plane.z * extent.z : 0.0f;
+    return offset;
+  }
+}
+
+Frustum::Frustum(const glm::mat4 &viewProjection) {
+  // Gribb-Hartmann: each plane is the last row of the matrix plus or minus one of the others
+  auto row = [&viewProjection](int i) {
+    return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+  };
+
+  planes[0] = row(3) + row(0);
+  planes[1] = row(3) - row(0);
+  planes[2] = row(3) + row(1);
+  planes[3] = row(3) - row(1);
+  planes[4] = row(3) + row(2);
+  planes[5] = row(3) - row(2);
+}
+
+bool Frustum::intersectsBox(glm::vec3 min, glm::vec3 max) const {
+  for (const auto &plane : planes) {
+    auto corner = glm::vec3(plane.x >= 0.0f ? max.x : min.x,
+                            plane.y >= 0.0f ? max.y : min.y,
+                            plane.z >= 0.0f ? max.z : min.z);
+    if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Frustum::cullBoxes(const float *minX, const float *minY, const float *minZ, size_t count, glm::vec3 extent,
+                        uint8_t *visible) const {
+  float offsets[FRUSTUM_PLANE_COUNT];
+  for (auto i = 0; i < FRUSTUM_PLANE_COUNT; ++i) {
+    offsets[i] = positiveVertexOffset(planes[i], extent);
+  }
+
+  size_t i = 0;
+  for (; i + LANE_COUNT <= count; i += LANE_COUNT) {
+    auto x = load(minX + i);
+    auto y = load(minY + i);
+    auto z = load(minZ + i);
+
+    auto inside = allSet();
+    for (auto p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+      auto distance = add(add(mul(splat(planes[p].x), x), mul(splat(planes[p].y), y)),
+                          add(mul(splat(planes[p].z), z), splat(offsets[p])));
+      inside = bitAnd(inside, isNonNegative(distance));
+    }
+
+    auto mask = laneMask(inside);
+    for (auto lane = 0; lane < LANE_COUNT; ++lane) {
+      visible[i + lane] = (mask >> lane) & 1u;
+    }
+  }
+
+  // Same arithmetic order as the lanes, so a box gets the same answer wherever it falls
+  for (; i < count; ++i) {
+    auto inside = true;
+    for (auto p = 0; p < FRUSTUM_PLANE_COUNT && inside; ++p) {
+      auto distance = (planes[p].x * minX[i] + planes[p].y * minY[i]) + (planes[p].z * minZ[i] + offsets[p]);
+      inside = distance >= 0.0f;
+    }
+    visible[i] = inside;
+  }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+constexpr int FRUSTUM_PLANE_COUNT = 6;
+
+// The six clip planes of a view-projection matrix, pointing inwards.
+class Frustum {
+public:
+  explicit Frustum(const glm::mat4 &viewProjection);
+
+  [[nodiscard]] bool intersectsBox(glm::vec3 min, glm::vec3 max) const;
+
+  // Tests count boxes of the same extent given by their minimum corners in SoA layout, several boxes at
+  // a time, and writes 1 to visible for every box at least partly inside.
+  void cullBoxes(const float *minX, const float *minY, const float *minZ, size_t count, glm::vec3 extent,
+                 uint8_t *visible) const;
+
+private:
+  glm::vec4 planes[FRUSTUM_PLANE_COUNT];
+};
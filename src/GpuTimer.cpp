@@ -0,0 +1,72 @@
+#include "GpuTimer.hpp"
+
+#ifdef NETBLOCKS_PROFILER
+
+GpuTimer::GpuTimer() = default;
+
+GpuTimer::~GpuTimer() {
+#ifdef PLATFORM_DESKTOP
+  if (!allQueries.empty()) {
+    glDeleteQueries(static_cast<GLsizei>(allQueries.size()), allQueries.data());
+  }
+#endif
+}
+
+void GpuTimer::begin(const char *name) {
+#ifdef PLATFORM_DESKTOP
+  if (freeQueries.empty()) {
+    GLuint query;
+    glGenQueries(1, &query);
+    allQueries.push_back(query);
+    freeQueries.push_back(query);
+  }
+
+  activeQuery = freeQueries.back();
+  freeQueries.pop_back();
+  activeName = name;
+  glBeginQuery(GL_TIME_ELAPSED, activeQuery);
+#endif
+}
+
+void GpuTimer::end() {
+#ifdef PLATFORM_DESKTOP
+  if (activeName == nullptr) {
+    return;
+  }
+
+  glEndQuery(GL_TIME_ELAPSED);
+  pending.push_back({activeQuery, activeName});
+  activeName = nullptr;
+#endif
+}
+
+void GpuTimer::collect() {
+#ifdef PLATFORM_DESKTOP
+  // Queries finish in the order they were issued, so the first unfinished one ends the scan
+  while (!pending.empty()) {
+    auto [query, name] = pending.front();
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+      break;
+    }
+
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+    Profiler::get().addGpuTime(name, elapsed);
+
+    freeQueries.push_back(query);
+    pending.pop_front();
+  }
+#endif
+}
+
+GpuZone::GpuZone(GpuTimer &timer, const char *name) : timer(timer) {
+  timer.begin(name);
+}
+
+GpuZone::~GpuZone() {
+  timer.end();
+}
+
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+#ifdef NETBLOCKS_PROFILER
+
+#include <deque>
+#include <vector>
+#include "gl.hpp"
+#include "Profiler.hpp"
+
+// Times GPU passes with GL_TIME_ELAPSED queries and hands the results to the Profiler once they are
+// available, a few frames later, without ever waiting on them. Passes may not nest, since GL allows only
+// one elapsed-time query at a time. WebGL2 only offers timer queries through an extension, so on the web
+// build passes are not timed.
+class GpuTimer {
+public:
+  GpuTimer();
+
+  ~GpuTimer();
+
+  GpuTimer(const GpuTimer &) = delete;
+
+  GpuTimer &operator=(const GpuTimer &) = delete;
+
+  void begin(const char *name);
+
+  void end();
+
+  // Reports every query that has finished, oldest first
+  void collect();
+
+private:
+  struct PendingQuery {
+    GLuint query;
+    const char *name;
+  };
+
+  std::vector<GLuint> freeQueries;
+  std::vector<GLuint> allQueries;
+  std::deque<PendingQuery> pending;
+  const char *activeName = nullptr;
+  GLuint activeQuery = 0;
+};
+
+// Times the rest of the enclosing scope as a GPU pass
+class GpuZone {
+public:
+  GpuZone(GpuTimer &timer, const char *name);
+
+  ~GpuZone();
+
+  GpuZone(const GpuZone &) = delete;
+
+  GpuZone &operator=(const GpuZone &) = delete;
+
+private:
+  GpuTimer &timer;
+};
+
+#define PROFILE_GPU_ZONE(timer, name) GpuZone PROFILE_CONCAT(gpuZone, __LINE__)(timer, name)
+
+#else
+
+#define PROFILE_GPU_ZONE(timer, name)
+
+#endif
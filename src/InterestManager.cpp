@@ -0,0 +1,205 @@
+#include "InterestManager.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  constexpr int CELL_SIZE = INTEREST_CELL_COLUMNS * CHUNK_SIZE;
+
+  // Orders a schedule's heap with the earliest due on top
+  constexpr auto earliestDue = [](const auto &a, const auto &b) {
+    return a.due > b.due;
+  };
+}
+
+void InterestManager::setPlayer(uint32_t id, glm::vec3 position, int viewRadius) {
+  auto &player = players[id];
+  player.position = position;
+  player.viewRadius = viewRadius;
+}
+
+void InterestManager::removePlayer(uint32_t id) {
+  if (players.erase(id) > 0) {
+    departures.push_back({id, ticks});
+  }
+}
+
+void InterestManager::rebuildGrid() {
+  ++ticks;
+  std::erase_if(departures, [this](const Departure &departure) {
+    return departure.tick + INTEREST_REFRESH_TICKS < ticks;
+  });
+
+  // Cells keep their storage from tick to tick; only the ones left empty are dropped
+  for (auto &[position, entries]: cells) {
+    entries.clear();
+  }
+  for (const auto &[id, player]: players) {
+    cells[cellOf(player.position)].push_back({id, player.position});
+  }
+  std::erase_if(cells, [](const auto &cell) {
+    return cell.second.empty();
+  });
+
+  // Sorted by id, so what a query takes from each cell only needs merging
+  for (auto &[position, entries]: cells) {
+    std::sort(entries.begin(), entries.end(), [](const GridEntry &a, const GridEntry &b) {
+      return a.id < b.id;
+    });
+  }
+}
+
+void InterestManager::selectPlayers(uint32_t id, size_t maxPlayers, std::vector<uint32_t> &selected,
+                                    std::vector<uint32_t> &removed) {
+  selected.clear();
+  removed.clear();
+  auto it = players.find(id);
+  if (it == players.end()) {
+    return;
+  }
+
+  auto &player = it->second;
+  if ((ticks + id) % INTEREST_REFRESH_TICKS == 0) {
+    refreshVisible(id, player, removed);
+  } else {
+    dropDeparted(player, removed);
+  }
+
+  // The earliest due come off the heap together, so none goes out twice, then go back in line
+  auto &schedule = player.schedule;
+  auto count = std::min(maxPlayers, schedule.size());
+  auto taken = schedule.end();
+  for (size_t i = 0; i < count; ++i, --taken) {
+    std::pop_heap(schedule.begin(), taken, earliestDue);
+  }
+  for (auto update = taken; update != schedule.end(); ++update) {
+    auto &chosen = player.visible[update->index];
+    chosen.due += chosen.interval;
+    update->due = chosen.due;
+    std::push_heap(schedule.begin(), update + 1, earliestDue);
+    selected.push_back(chosen.id);
+  }
+
+  stats.candidates += schedule.size();
+  stats.selected += selected.size();
+  stats.deferred += schedule.size() - selected.size();
+}
+
+void InterestManager::refreshVisible(uint32_t id, Player &player, std::vector<uint32_t> &removed) {
+  auto range = static_cast<float>(player.viewRadius * CHUNK_SIZE);
+  auto low = cellOf(player.position - glm::vec3(range));
+  auto high = cellOf(player.position + glm::vec3(range));
+
+  // The nearer a player, the more often it is due
+  candidates.clear();
+  for (auto x = low.x; x <= high.x; ++x) {
+    for (auto z = low.y; z <= high.y; ++z) {
+      auto cell = cells.find({x, z});
+      if (cell == cells.end()) {
+        continue;
+      }
+
+      auto runStart = candidates.size();
+      for (const auto &other: cell->second) {
+        auto offset = glm::vec2(other.position.x - player.position.x, other.position.z - player.position.z);
+        auto distanceSquared = glm::dot(offset, offset);
+        if (other.id != id && distanceSquared <= range * range) {
+          candidates.push_back({other.id, 1.0f + std::sqrt(distanceSquared) / CHUNK_SIZE});
+        }
+      }
+
+      auto middle = candidates.begin() + static_cast<ptrdiff_t>(runStart);
+      if (runStart > 0 && middle != candidates.end() && (middle - 1)->id > middle->id) {
+        std::inplace_merge(candidates.begin(), middle, candidates.end(), [](const Candidate &a, const Candidate &b) {
+          return a.id < b.id;
+        });
+      }
+    }
+  }
+
+  // Players still in view keep their place, counted from the earliest due so times stay small; new ones
+  // go ahead of everyone and the rest have left
+  auto now = player.schedule.empty() ? 0.0f : player.schedule.front().due;
+  merged.clear();
+  auto visible = player.visible.begin();
+  for (const auto &candidate: candidates) {
+    for (; visible != player.visible.end() && visible->id < candidate.id; ++visible) {
+      removed.push_back(visible->id);
+    }
+    auto known = visible != player.visible.end() && visible->id == candidate.id;
+    merged.push_back({candidate.id, known ? visible->due - now : -1.0f, candidate.interval});
+    if (known) {
+      ++visible;
+    }
+  }
+  for (; visible != player.visible.end(); ++visible) {
+    removed.push_back(visible->id);
+  }
+  player.visible.swap(merged);
+  rebuildSchedule(player);
+}
+
+void InterestManager::dropDeparted(Player &player, std::vector<uint32_t> &removed) {
+  auto dropped = false;
+  for (const auto &departure: departures) {
+    auto found = std::lower_bound(player.visible.begin(), player.visible.end(), departure.id,
+                                  [](const VisiblePlayer &visible, uint32_t id) {
+                                    return visible.id < id;
+                                  });
+    if (found != player.visible.end() && found->id == departure.id) {
+      removed.push_back(departure.id);
+      player.visible.erase(found);
+      dropped = true;
+    }
+  }
+
+  // Erasing moved the indices the schedule holds
+  if (dropped) {
+    rebuildSchedule(player);
+  }
+}
+
+void InterestManager::rebuildSchedule(Player &player) {
+  player.schedule.clear();
+  for (uint32_t i = 0; i < player.visible.size(); ++i) {
+    player.schedule.push_back({i, player.visible[i].due});
+  }
+  std::make_heap(player.schedule.begin(), player.schedule.end(), earliestDue);
+}
+
+void InterestManager::subscribe(uint32_t id, ColumnPos column) {
+  subscribers[column].push_back(id);
+}
+
+void InterestManager::unsubscribe(uint32_t id, ColumnPos column) {
+  auto it = subscribers.find(column);
+  if (it == subscribers.end()) {
+    return;
+  }
+
+  auto &ids = it->second;
+  if (auto found = std::find(ids.begin(), ids.end(), id); found != ids.end()) {
+    *found = ids.back();
+    ids.pop_back();
+  }
+  if (ids.empty()) {
+    subscribers.erase(it);
+  }
+}
+
+const std::vector<uint32_t> &InterestManager::getSubscribers(ColumnPos column) const {
+  static const std::vector<uint32_t> none;
+  auto it = subscribers.find(column);
+  return it == subscribers.end() ? none : it->second;
+}
+
+InterestStats InterestManager::getStats() const {
+  auto result = stats;
+  result.players = players.size();
+  result.cells = cells.size();
+  return result;
+}
+
+ColumnPos InterestManager::cellOf(glm::vec3 position) {
+  return {floorDiv(static_cast<int>(std::floor(position.x)), CELL_SIZE),
+          floorDiv(static_cast<int>(std::floor(position.z)), CELL_SIZE)};
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "ChunkPos.hpp"
+
+// Players are bucketed into square cells of this many columns, about a view radius across, so a query
+// visits a handful of cells; smaller cells cost more lookups than they save in players skipped
+constexpr int INTEREST_CELL_COLUMNS = 8;
+
+// Who is in a player's view is looked up again this often, a different share of the players every tick;
+// in between a tick only takes the updates due off each player's schedule, whatever the size of a crowd
+constexpr uint64_t INTEREST_REFRESH_TICKS = 4;
+
+struct InterestStats {
+  size_t players;
+  size_t cells;
+  uint64_t candidates;
+  uint64_t selected;
+  // Candidates that stayed behind because a client's budget was used up; they keep their place in line
+  uint64_t deferred;
+};
+
+// Decides who hears about what. Players are kept in a uniform grid over the columns, so finding everyone
+// within a view radius costs the players nearby rather than everyone on the server. Every player also
+// keeps a schedule of the other players it can see: each is due again a distance-dependent interval after
+// its last update, so when there are more players in view than fit in a tick the earliest due go out,
+// the nearest as often as every tick and the rest taking turns in proportion to closeness. Columns keep the
+// list of players subscribed to them, so changes inside a column only reach the players that have it.
+class InterestManager {
+public:
+  // Adds the player or moves it; the grid follows on the next rebuildGrid()
+  void setPlayer(uint32_t id, glm::vec3 position, int viewRadius);
+
+  // Its column subscriptions stay until each is unsubscribed
+  void removePlayer(uint32_t id);
+
+  // Re-buckets every player after they have all moved this tick, and starts the next tick
+  void rebuildGrid();
+
+  // The players to update id about this tick, the maxPlayers due soonest, and the ones it
+  // knew about that have left its view. Players come into and leave view up to INTEREST_REFRESH_TICKS
+  // late, except those removed, who leave on the next tick
+  void selectPlayers(uint32_t id, size_t maxPlayers, std::vector<uint32_t> &selected, std::vector<uint32_t> &removed);
+
+  void subscribe(uint32_t id, ColumnPos column);
+
+  void unsubscribe(uint32_t id, ColumnPos column);
+
+  [[nodiscard]] const std::vector<uint32_t> &getSubscribers(ColumnPos column) const;
+
+  [[nodiscard]] InterestStats getStats() const;
+
+private:
+  struct Candidate {
+    uint32_t id;
+    float interval;
+  };
+
+  // Positions are copied into the grid so queries do not have to look every player up
+  struct GridEntry {
+    uint32_t id;
+    glm::vec3 position;
+  };
+
+  // Due and interval are in ticks, the interval as of the last lookup
+  struct VisiblePlayer {
+    uint32_t id;
+    float due;
+    float interval;
+  };
+
+  struct ScheduledUpdate {
+    uint32_t index;
+    float due;
+  };
+
+  struct Departure {
+    uint32_t id;
+    uint64_t tick;
+  };
+
+  struct Player {
+    glm::vec3 position;
+    int viewRadius;
+    // Sorted by id, so a lookup's candidates merge into it in one pass
+    std::vector<VisiblePlayer> visible;
+    // A heap of indices into visible, the earliest due on top
+    std::vector<ScheduledUpdate> schedule;
+  };
+
+  std::unordered_map<uint32_t, Player> players;
+  std::unordered_map<ColumnPos, std::vector<GridEntry>, ColumnPosHash> cells;
+  std::unordered_map<ColumnPos, std::vector<uint32_t>, ColumnPosHash> subscribers;
+  std::vector<Candidate> candidates;
+  std::vector<VisiblePlayer> merged;
+  // Removed players stay here until everyone has looked up their view since
+  std::vector<Departure> departures;
+  uint64_t ticks = 0;
+  InterestStats stats{};
+
+  // Finds who is in view now, keeping the place in line of those still in it
+  void refreshVisible(uint32_t id, Player &player, std::vector<uint32_t> &removed);
+
+  void dropDeparted(Player &player, std::vector<uint32_t> &removed);
+
+  static void rebuildSchedule(Player &player);
+
+  static ColumnPos cellOf(glm::vec3 position);
+};
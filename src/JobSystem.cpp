@@ -0,0 +1,155 @@
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <string>
+#include "Profiler.hpp"
+
+namespace {
+  // std heap functions build a max-heap, so "less" means "runs later"
+  struct JobOrder {
+    template<typename T>
+    bool operator()(const T &a, const T &b) const {
+      if (a.priority != b.priority) {
+        return a.priority > b.priority;
+      }
+      return a.sequence > b.sequence;
+    }
+  };
+}
+
+JobSystem::JobSystem(unsigned workerCount) : running(true), pending(0), nextSequence(0) {
+  auto queueCount = std::max(workerCount, 1u);
+  for (auto i = 0u; i < queueCount; ++i) {
+    queues.push_back(std::make_unique<WorkerQueue>());
+  }
+
+  for (auto i = 0u; i < workerCount; ++i) {
+    workers.emplace_back(&JobSystem::workerLoop, this, i);
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard lock(sleepMutex);
+    running = false;
+  }
+  wake.notify_all();
+
+  for (auto &worker: workers) {
+    worker.join();
+  }
+}
+
+void JobSystem::submit(int priority, JobFunction function) {
+  auto sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+  auto &queue = *queues[sequence % queues.size()];
+
+  pending.fetch_add(1, std::memory_order_release);
+  {
+    std::lock_guard lock(queue.mutex);
+    queue.heap.push_back({priority, sequence, std::move(function)});
+    std::push_heap(queue.heap.begin(), queue.heap.end(), JobOrder());
+  }
+
+  {
+    std::lock_guard lock(sleepMutex);
+  }
+  wake.notify_one();
+}
+
+size_t JobSystem::runPending(size_t maxJobs) {
+  size_t executed = 0;
+  Job job;
+  while (executed < maxJobs && tryPop(0, job)) {
+    job.function();
+    ++executed;
+  }
+  return executed;
+}
+
+unsigned JobSystem::getWorkerCount() const {
+  return static_cast<unsigned>(workers.size());
+}
+
+size_t JobSystem::getPendingCount() const {
+  return pending.load(std::memory_order_relaxed);
+}
+
+unsigned JobSystem::defaultWorkerCount() {
+#if defined(PLATFORM_WEB) && !defined(__EMSCRIPTEN_PTHREADS__)
+  return 0;
+#else
+  auto hardware = std::thread::hardware_concurrency();
+  return hardware > 1 ? hardware - 1 : 1;
+#endif
+}
+
+void JobSystem::workerLoop(unsigned index) {
+  PROFILE_THREAD_NAME("worker " + std::to_string(index));
+  Job job;
+  while (true) {
+    if (tryPop(index, job)) {
+      job.function();
+      job.function = nullptr;
+      continue;
+    }
+
+    std::unique_lock lock(sleepMutex);
+    wake.wait(lock, [this] { return !running || pending.load(std::memory_order_acquire) > 0; });
+    if (!running) {
+      return;
+    }
+  }
+}
+
+bool JobSystem::tryPop(unsigned index, Job &job) {
+  struct Front {
+    int priority;
+    uint64_t sequence;
+  };
+
+  if (popFrom(*queues[index], job)) {
+    pending.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Own queue ran dry: steal the best job at the front of a peer's queue. Another worker may take it
+  // first, in which case look again.
+  auto count = static_cast<unsigned>(queues.size());
+  while (true) {
+    WorkerQueue *best = nullptr;
+    Front bestFront{};
+    for (auto i = 1u; i < count; ++i) {
+      auto &queue = *queues[(index + i) % count];
+      std::lock_guard lock(queue.mutex);
+      if (queue.heap.empty()) {
+        continue;
+      }
+
+      Front front{queue.heap.front().priority, queue.heap.front().sequence};
+      if (best == nullptr || JobOrder()(bestFront, front)) {
+        best = &queue;
+        bestFront = front;
+      }
+    }
+
+    if (best == nullptr) {
+      return false;
+    }
+    if (popFrom(*best, job)) {
+      pending.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+}
+
+bool JobSystem::popFrom(WorkerQueue &queue, Job &job) {
+  std::lock_guard lock(queue.mutex);
+  if (queue.heap.empty()) {
+    return false;
+  }
+
+  std::pop_heap(queue.heap.begin(), queue.heap.end(), JobOrder());
+  job = std::move(queue.heap.back());
+  queue.heap.pop_back();
+  return true;
+}
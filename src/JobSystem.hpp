@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using JobFunction = std::function<void()>;
+
+// Work-stealing pool: every worker owns a priority queue (lower value runs first) and steals the best
+// job from its peers when its own queue runs dry. Submits are spread over the queues, so each worker runs
+// its share in priority order, and the pool as a whole only roughly. With zero workers, jobs only run when
+// the owning thread calls runPending(), which is how single-threaded builds (WebGL without pthreads) work.
+class JobSystem {
+public:
+  explicit JobSystem(unsigned workerCount = defaultWorkerCount());
+
+  ~JobSystem();
+
+  void submit(int priority, JobFunction function);
+
+  size_t runPending(size_t maxJobs);
+
+  [[nodiscard]] unsigned getWorkerCount() const;
+
+  [[nodiscard]] size_t getPendingCount() const;
+
+  static unsigned defaultWorkerCount();
+
+private:
+  struct Job {
+    int priority;
+    uint64_t sequence;
+    JobFunction function;
+  };
+
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::vector<Job> heap;
+  };
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues;
+  std::vector<std::thread> workers;
+
+  std::atomic<bool> running;
+  std::atomic<size_t> pending;
+  std::atomic<uint64_t> nextSequence;
+
+  std::mutex sleepMutex;
+  std::condition_variable wake;
+
+  void workerLoop(unsigned index);
+
+  bool tryPop(unsigned index, Job &job);
+
+  static bool popFrom(WorkerQueue &queue, Job &job);
+};
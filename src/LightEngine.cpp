@@ -0,0 +1,316 @@
+#include "LightEngine.hpp"
+#include <algorithm>
+#include <tuple>
+
+namespace {
+  // +X, -X, +Y, -Y, +Z, -Z
+  const glm::ivec3 DIRECTIONS[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+  constexpr int UP = 2;
+  constexpr int DOWN = 3;
+  constexpr int SIDE_FACES[4] = {0, 1, 4, 5};
+
+  // Channel 0 is sky light in the high nibble, channel 1 block light in the low one
+  constexpr int SKY_CHANNEL = 0;
+  constexpr int CHANNEL_SHIFTS[2] = {4, 0};
+
+  uint8_t getLevel(uint8_t value, int channel) {
+    return (value >> CHANNEL_SHIFTS[channel]) & MAX_LIGHT;
+  }
+
+  // The level light at level reaches the next block with, going down or any other way
+  uint8_t spread(uint8_t level, int channel, bool downwards) {
+    if (channel == SKY_CHANNEL && downwards && level == MAX_LIGHT) {
+      return MAX_LIGHT;
+    }
+    return level > 0 ? level - 1 : 0;
+  }
+}
+
+LightEngine::LightEngine(LightChunkLookup lookup) : lookup(std::move(lookup)) {
+}
+
+bool LightEngine::locate(glm::ivec3 position, LightChunk &chunk, int &index) {
+  auto chunkPosition = chunkContaining(position);
+  auto &entry = cache[(chunkPosition.x & 1) | (chunkPosition.y & 1) << 1 | (chunkPosition.z & 1) << 2];
+  if (!entry.isValid || entry.position != chunkPosition) {
+    entry = {chunkPosition, lookup(chunkPosition), true};
+  }
+
+  auto local = position - chunkPosition * CHUNK_SIZE;
+  chunk = entry.chunk;
+  index = BlockStorage::index(local.x, local.y, local.z);
+  return chunk.light != nullptr;
+}
+
+void LightEngine::clearCache() {
+  for (auto &entry: cache) {
+    entry.isValid = false;
+  }
+}
+
+void LightEngine::setLevel(const LightChunk &chunk, int index, glm::ivec3 position, int channel, uint8_t level) {
+  auto &value = chunk.light->values[index];
+  value = channel == SKY ? packLight(level, value & MAX_LIGHT) : packLight(value >> 4, level);
+  ++stats.changed;
+  markDirty(position);
+}
+
+void LightEngine::clearLight(const LightChunk &chunk, int index, glm::ivec3 position) {
+  for (auto channel = 0; channel < CHANNEL_COUNT; ++channel) {
+    auto level = getLevel(chunk.light->values[index], channel);
+    if (level > 0) {
+      setLevel(chunk, index, position, channel, 0);
+      removals[channel].push_back({position, level});
+    }
+  }
+  pulls.push_back(position);
+}
+
+uint8_t LightEngine::pullLevel(glm::ivec3 position, const LightChunk &chunk, int index, int channel) {
+  auto block = chunk.blocks->get(index);
+  uint8_t level = channel == BLOCK ? getLightEmission(block) : 0;
+  if (isOpaque(block)) {
+    return level;
+  }
+
+  for (auto direction = 0; direction < 6; ++direction) {
+    LightChunk neighbor;
+    int neighborIndex;
+    uint8_t from = 0;
+    if (locate(position + DIRECTIONS[direction], neighbor, neighborIndex)) {
+      from = getLevel(neighbor.light->values[neighborIndex], channel);
+    } else if (channel == SKY && neighbor.isOpenSky) {
+      from = MAX_LIGHT;
+    }
+    level = std::max(level, spread(from, channel, direction == UP));
+  }
+  return level;
+}
+
+void LightEngine::markDirty(glm::ivec3 position) {
+  auto chunkPosition = chunkContaining(position);
+  auto local = position - chunkPosition * CHUNK_SIZE;
+  if (lastDirtyMask == nullptr || chunkPosition != lastDirty) {
+    lastDirtyMask = &dirtyMasks[chunkPosition];
+    lastDirty = chunkPosition;
+  }
+
+  // Blocks on a border are sampled by the meshes on the other side of it too
+  auto low = glm::ivec3(glm::equal(local, glm::ivec3(0)));
+  auto high = glm::ivec3(glm::equal(local, glm::ivec3(CHUNK_SIZE - 1)));
+  for (auto dx = -low.x; dx <= high.x; ++dx) {
+    for (auto dy = -low.y; dy <= high.y; ++dy) {
+      for (auto dz = -low.z; dz <= high.z; ++dz) {
+        *lastDirtyMask |= 1u << ((dx + 1) * 9 + (dy + 1) * 3 + dz + 1);
+      }
+    }
+  }
+}
+
+void LightEngine::removeLight(int channel) {
+  auto &queue = removals[channel];
+  for (size_t head = 0; head < queue.size(); ++head) {
+    auto node = queue[head];
+    ++stats.visited;
+    for (auto direction = 0; direction < 6; ++direction) {
+      auto position = node.position + DIRECTIONS[direction];
+      LightChunk chunk;
+      int index;
+      if (!locate(position, chunk, index)) {
+        // Open sky next to a block that went dark may light it again
+        if (channel == SKY && chunk.isOpenSky) {
+          pulls.push_back(node.position);
+        }
+        continue;
+      }
+
+      auto level = getLevel(chunk.light->values[index], channel);
+      if (level == 0) {
+        continue;
+      }
+
+      // Dimmer light came from the removed block, as did full sky light straight below it; anything else,
+      // and emitters, have another source and spread back into the gap
+      auto isDependent = level < node.level ||
+                         (channel == SKY && direction == DOWN && node.level == MAX_LIGHT && level == MAX_LIGHT);
+      if (isDependent && !(channel == BLOCK && getLightEmission(chunk.blocks->get(index)) >= level)) {
+        setLevel(chunk, index, position, channel, 0);
+        queue.push_back({position, level});
+      } else {
+        additions[channel].push_back(position);
+      }
+    }
+  }
+  queue.clear();
+}
+
+void LightEngine::addLight(int channel) {
+  auto &queue = additions[channel];
+  for (size_t head = 0; head < queue.size(); ++head) {
+    auto position = queue[head];
+    ++stats.visited;
+    LightChunk chunk;
+    int index;
+    if (!locate(position, chunk, index)) {
+      continue;
+    }
+    auto level = getLevel(chunk.light->values[index], channel);
+    if (level <= 1) {
+      continue;
+    }
+
+    for (auto direction = 0; direction < 6; ++direction) {
+      auto next = position + DIRECTIONS[direction];
+      LightChunk neighbor;
+      int neighborIndex;
+      if (!locate(next, neighbor, neighborIndex) || isOpaque(neighbor.blocks->get(neighborIndex))) {
+        continue;
+      }
+      auto reached = spread(level, channel, direction == DOWN);
+      if (getLevel(neighbor.light->values[neighborIndex], channel) < reached) {
+        setLevel(neighbor, neighborIndex, next, channel, reached);
+        queue.push_back(next);
+      }
+    }
+  }
+  queue.clear();
+}
+
+void LightEngine::addChunk(ChunkPos position, bool wasOpenSky) {
+  clearCache();
+  auto origin = position * CHUNK_SIZE;
+  LightChunk chunk;
+  int index;
+  if (!locate(origin, chunk, index)) {
+    return;
+  }
+  chunk.light->fill(wasOpenSky ? FULL_SKY_LIGHT : 0);
+  markDirty(origin + CHUNK_SIZE / 2);
+
+  // A uniform chunk that matches what was assumed has nothing to queue but its borders
+  auto wasOpaque = !wasOpenSky;
+  auto first = chunk.blocks->get(0);
+  if (!chunk.blocks->isUniform() || isOpaque(first) != wasOpaque || getLightEmission(first) > 0) {
+    for (auto x = 0; x < CHUNK_SIZE; ++x) {
+      for (auto y = 0; y < CHUNK_SIZE; ++y) {
+        for (auto z = 0; z < CHUNK_SIZE; ++z) {
+          auto blockIndex = BlockStorage::index(x, y, z);
+          auto block = chunk.blocks->get(blockIndex);
+          if (isOpaque(block) != wasOpaque || getLightEmission(block) > 0) {
+            clearLight(chunk, blockIndex, origin + glm::ivec3(x, y, z));
+          }
+        }
+      }
+    }
+  }
+
+  for (auto face = 0; face < 6; ++face) {
+    seedFace(position, face);
+  }
+}
+
+void LightEngine::seedFace(ChunkPos position, int face) {
+  auto normal = DIRECTIONS[face];
+  auto axis = normal.x != 0 ? 0 : normal.y != 0 ? 1 : 2;
+  auto u = (axis + 1) % 3;
+  auto v = (axis + 2) % 3;
+
+  glm::ivec3 local;
+  local[axis] = normal[axis] > 0 ? CHUNK_SIZE - 1 : 0;
+  for (local[u] = 0; local[u] < CHUNK_SIZE; ++local[u]) {
+    for (local[v] = 0; local[v] < CHUNK_SIZE; ++local[v]) {
+      auto inside = position * CHUNK_SIZE + local;
+      auto outside = inside + normal;
+      LightChunk neighbor;
+      int neighborIndex;
+      if (locate(outside, neighbor, neighborIndex)) {
+        for (auto channel = 0; channel < CHANNEL_COUNT; ++channel) {
+          additions[channel].push_back(inside);
+          additions[channel].push_back(outside);
+        }
+      } else if (neighbor.isOpenSky) {
+        pulls.push_back(inside);
+      }
+    }
+  }
+}
+
+void LightEngine::seedColumnBorders(ColumnPos column) {
+  clearCache();
+  for (auto y = 0; y < WORLD_HEIGHT_CHUNKS; ++y) {
+    ChunkPos position(column.x, y, column.y);
+    LightChunk chunk;
+    int index;
+    if (locate(position * CHUNK_SIZE, chunk, index)) {
+      for (auto face = 0; face < 6; ++face) {
+        seedFace(position, face);
+      }
+    }
+    for (auto face: SIDE_FACES) {
+      auto neighborPosition = position + DIRECTIONS[face];
+      if (locate(neighborPosition * CHUNK_SIZE, chunk, index)) {
+        seedFace(neighborPosition, face ^ 1);
+      }
+    }
+  }
+}
+
+void LightEngine::changeBlock(glm::ivec3 position) {
+  clearCache();
+  LightChunk chunk;
+  int index;
+  if (locate(position, chunk, index)) {
+    clearLight(chunk, index, position);
+  }
+}
+
+void LightEngine::propagate() {
+  clearCache();
+  ++stats.propagations;
+  for (auto channel = 0; channel < CHANNEL_COUNT; ++channel) {
+    removeLight(channel);
+  }
+
+  // Only now is every block lit by something that still exists, so what the pulled blocks see is right
+  for (auto position: pulls) {
+    ++stats.visited;
+    LightChunk chunk;
+    int index;
+    if (!locate(position, chunk, index)) {
+      continue;
+    }
+    for (auto channel = 0; channel < CHANNEL_COUNT; ++channel) {
+      auto level = pullLevel(position, chunk, index, channel);
+      if (level > getLevel(chunk.light->values[index], channel)) {
+        setLevel(chunk, index, position, channel, level);
+        additions[channel].push_back(position);
+      }
+    }
+  }
+  pulls.clear();
+
+  for (auto channel = 0; channel < CHANNEL_COUNT; ++channel) {
+    addLight(channel);
+  }
+}
+
+void LightEngine::takeDirtyChunks(std::vector<ChunkPos> &dirty) {
+  dirty.clear();
+  for (const auto &[position, mask]: dirtyMasks) {
+    for (auto bit = 0; bit < 27; ++bit) {
+      if (mask >> bit & 1) {
+        dirty.push_back(position + ChunkPos(bit / 9 - 1, bit / 3 % 3 - 1, bit % 3 - 1));
+      }
+    }
+  }
+  std::sort(dirty.begin(), dirty.end(), [](ChunkPos a, ChunkPos b) {
+    return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+  });
+  dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+  dirtyMasks.clear();
+  lastDirtyMask = nullptr;
+}
+
+const LightStats &LightEngine::getStats() const {
+  return stats;
+}
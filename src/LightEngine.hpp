@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "ChunkLight.hpp"
+#include "ChunkPos.hpp"
+
+// A chunk position as the engine sees it. Chunks that exist bring their blocks and light. The others are
+// never written and stand for what the world assumes is there: open sky above a column's surface and above
+// the world, which shines into its neighbours, or ground below the surface and terrain that is not loaded,
+// which is dark and lets nothing through.
+struct LightChunk {
+  const BlockStorage *blocks = nullptr;
+  ChunkLight *light = nullptr;
+  bool isOpenSky = false;
+};
+
+using LightChunkLookup = std::function<LightChunk(ChunkPos position)>;
+
+struct LightStats {
+  uint64_t propagations;
+  // Blocks taken off a queue, which is what an update costs
+  uint64_t visited;
+  uint64_t changed;
+};
+
+// Flood-fill light in two channels. Sky light pours straight down at full strength and loses a level per
+// block in every other direction; block light spreads from emitting blocks, losing a level per block in
+// every direction. Changes only queue work. propagate() first takes light back breadth-first from wherever
+// it no longer reaches, then spreads it again from the edges of what was taken and from the changed blocks,
+// so an edit visits the blocks within reach of it rather than relighting its chunk.
+class LightEngine {
+public:
+  explicit LightEngine(LightChunkLookup lookup);
+
+  // A chunk that has just taken the place of a missing one, with its blocks and light storage in place. Its
+  // light starts as the missing chunk's was, full sky for open sky and dark otherwise, and every block that
+  // differs from that is queued as an edit, so light it gave its neighbours while missing is taken back too.
+  void addChunk(ChunkPos position, bool wasOpenSky);
+
+  // Lets light across every face of a column's chunks once the column is known, and back from the chunks
+  // beside it, since an unknown column blocks all light
+  void seedColumnBorders(ColumnPos column);
+
+  // The block at position has already changed; its light is worked out again from its neighbours
+  void changeBlock(glm::ivec3 position);
+
+  void propagate();
+
+  // Chunks whose light changed since the last call, plus the neighbours whose meshes sample it across a
+  // border, each once
+  void takeDirtyChunks(std::vector<ChunkPos> &dirty);
+
+  [[nodiscard]] const LightStats &getStats() const;
+
+private:
+  struct Node {
+    glm::ivec3 position;
+    uint8_t level;
+  };
+
+  enum Channel {
+    SKY,
+    BLOCK,
+    CHANNEL_COUNT
+  };
+
+  struct CachedChunk {
+    ChunkPos position;
+    LightChunk chunk;
+    bool isValid;
+  };
+
+  LightChunkLookup lookup;
+
+  // Recent lookups, one slot per parity of the chunk position, so a flood running along a border keeps
+  // both sides of it. Cleared on every public call, as chunks may have come or gone in between.
+  CachedChunk cache[8]{};
+
+  std::vector<Node> removals[CHANNEL_COUNT];
+  std::vector<glm::ivec3> additions[CHANNEL_COUNT];
+  // Blocks that recompute their light from their neighbours once removals are done
+  std::vector<glm::ivec3> pulls;
+
+  // Bit (dx + 1) * 9 + (dy + 1) * 3 + dz + 1 for every neighbour that samples a changed block
+  std::unordered_map<ChunkPos, uint32_t, ChunkPosHash> dirtyMasks;
+  ChunkPos lastDirty{0};
+  uint32_t *lastDirtyMask = nullptr;
+
+  LightStats stats{};
+
+  // Finds the chunk holding position and the block's index in it; false when the chunk does not exist
+  bool locate(glm::ivec3 position, LightChunk &chunk, int &index);
+
+  void clearCache();
+
+  // Zeroes the block's light and queues its removal
+  void clearLight(const LightChunk &chunk, int index, glm::ivec3 position);
+
+  void setLevel(const LightChunk &chunk, int index, glm::ivec3 position, int channel, uint8_t level);
+
+  // What the block would be lit to by its neighbours and itself
+  uint8_t pullLevel(glm::ivec3 position, const LightChunk &chunk, int index, int channel);
+
+  void seedFace(ChunkPos position, int face);
+
+  void markDirty(glm::ivec3 position);
+
+  void removeLight(int channel);
+
+  void addLight(int channel);
+};
@@ -0,0 +1,227 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+#else
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::filesystem::path &path) {
+  close();
+
+  file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                     FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    file = nullptr;
+    return false;
+  }
+
+  LARGE_INTEGER length;
+  if (!GetFileSizeEx(file, &length)) {
+    close();
+    return false;
+  }
+
+  fileSize = static_cast<uint64_t>(length.QuadPart);
+  return map();
+}
+
+bool MappedFile::reserve(uint64_t size) {
+  if (size <= fileSize) {
+    return true;
+  }
+
+  // A file cannot be resized while a view of it is open
+  unmap();
+
+  LARGE_INTEGER length;
+  length.QuadPart = static_cast<LONGLONG>(size);
+  if (!SetFilePointerEx(file, length, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+    map();
+    return false;
+  }
+
+  fileSize = size;
+  return map();
+}
+
+bool MappedFile::write(uint64_t offset, const void *data, size_t size) {
+  if (offset + size > fileSize) {
+    return false;
+  }
+
+  OVERLAPPED position{};
+  position.Offset = static_cast<DWORD>(offset);
+  position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+  DWORD written = 0;
+  return WriteFile(file, data, static_cast<DWORD>(size), &written, &position) && written == size;
+}
+
+void MappedFile::sync() {
+  if (view != nullptr) {
+    FlushViewOfFile(view, 0);
+  }
+  if (file != nullptr) {
+    FlushFileBuffers(file);
+  }
+}
+
+bool MappedFile::isOpen() const {
+  return file != nullptr;
+}
+
+void MappedFile::close() {
+  unmap();
+  if (file != nullptr) {
+    CloseHandle(file);
+    file = nullptr;
+  }
+  fileSize = 0;
+}
+
+bool MappedFile::map() {
+  // Empty files cannot be mapped; data() stays null until something is reserved
+  if (fileSize == 0) {
+    return true;
+  }
+
+  mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr) {
+    return false;
+  }
+
+  view = static_cast<uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (view == nullptr) {
+    CloseHandle(mapping);
+    mapping = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void MappedFile::unmap() {
+  if (view != nullptr) {
+    UnmapViewOfFile(view);
+    view = nullptr;
+  }
+  if (mapping != nullptr) {
+    CloseHandle(mapping);
+    mapping = nullptr;
+  }
+}
+
+#else
+
+bool MappedFile::open(const std::filesystem::path &path) {
+  close();
+
+  file = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (file < 0) {
+    return false;
+  }
+
+  struct stat status{};
+  if (fstat(file, &status) != 0) {
+    close();
+    return false;
+  }
+
+  fileSize = static_cast<uint64_t>(status.st_size);
+  return map();
+}
+
+bool MappedFile::reserve(uint64_t size) {
+  if (size <= fileSize) {
+    return true;
+  }
+
+  if (ftruncate(file, static_cast<off_t>(size)) != 0) {
+    return false;
+  }
+
+  unmap();
+  fileSize = size;
+  return map();
+}
+
+bool MappedFile::write(uint64_t offset, const void *data, size_t size) {
+  if (offset + size > fileSize) {
+    return false;
+  }
+
+  const auto *bytes = static_cast<const uint8_t *>(data);
+  while (size > 0) {
+    auto written = pwrite(file, bytes, size, static_cast<off_t>(offset));
+    if (written <= 0) {
+      return false;
+    }
+    bytes += written;
+    offset += written;
+    size -= written;
+  }
+  return true;
+}
+
+void MappedFile::sync() {
+  if (file >= 0) {
+    fdatasync(file);
+  }
+}
+
+bool MappedFile::isOpen() const {
+  return file >= 0;
+}
+
+void MappedFile::close() {
+  unmap();
+  if (file >= 0) {
+    ::close(file);
+    file = -1;
+  }
+  fileSize = 0;
+}
+
+bool MappedFile::map() {
+  if (fileSize == 0) {
+    return true;
+  }
+
+  auto *mapped = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, file, 0);
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+
+  view = static_cast<uint8_t *>(mapped);
+  return true;
+}
+
+void MappedFile::unmap() {
+  if (view != nullptr) {
+    munmap(view, fileSize);
+    view = nullptr;
+  }
+}
+
+#endif
+
+const uint8_t *MappedFile::data() const {
+  return view;
+}
+
+uint64_t MappedFile::size() const {
+  return fileSize;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// A file opened for reading and writing whose whole length is also mapped into memory read-only, so reads
+// are plain loads that fault pages in on demand. Writes go through the file handle at explicit offsets and
+// show up in the mapping straight away, as both share the page cache; growing the file remaps it.
+class MappedFile {
+public:
+  MappedFile() = default;
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // Creates the file when it does not exist
+  bool open(const std::filesystem::path &path);
+
+  // Extends the file with zeros to at least size bytes and maps the new length
+  bool reserve(uint64_t size);
+
+  // The range must lie within the current size; call reserve() first to write past the end
+  bool write(uint64_t offset, const void *data, size_t size);
+
+  // Asks the system to write dirty pages back to disk
+  void sync();
+
+  [[nodiscard]] const uint8_t *data() const;
+
+  [[nodiscard]] uint64_t size() const;
+
+  [[nodiscard]] bool isOpen() const;
+
+  void close();
+
+private:
+#ifdef _WIN32
+  // HANDLEs, kept as void * so this header does not drag in windows.h
+  void *file = nullptr;
+  void *mapping = nullptr;
+#else
+  int file = -1;
+#endif
+
+  uint8_t *view = nullptr;
+  uint64_t fileSize = 0;
+
+  bool map();
+
+  void unmap();
+};
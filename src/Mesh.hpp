@@ -1,16 +1,20 @@
 #pragma once
 
-#include <vector>
-#include <glm/glm.hpp>
-#include "gl.hpp"
+#include <cstdint>
 
-struct Mesh {
-  std::vector<glm::vec3> vertices;
-  std::vector<glm::vec3> normals;
-  std::vector<float> occlusion;
-  std::vector<GLuint> indices;
+constexpr uint32_t NO_DRAW_SLOT = UINT32_MAX;
 
-  GLuint vao, vbo, ebo;
+// Location of a chunk's geometry inside the shared ChunkArena, in uint32 elements, and the slot of its
+// draw command
+struct Mesh {
+  uint32_t vertexOffset = 0;
+  uint32_t vertexCapacity = 0;
+  uint32_t indexOffset = 0;
+  uint32_t indexCapacity = 0;
+  uint32_t indexCount = 0;
+  uint32_t drawSlot = NO_DRAW_SLOT;
 
-  Mesh() : vao(0), vbo(0), ebo(0) {}
+  [[nodiscard]] bool isEmpty() const {
+    return indexCount == 0;
+  }
 };
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Chunk vertices are packed into a single uint32, decoded in the standard vertex shaders:
+//   bits  0-14  chunk-local position, 5 bits per axis (0..16)
+//   bits 15-17  face normal index (+X, -X, +Y, -Y, +Z, -Z)
+//   bits 18-19  ambient occlusion level (0 = darkest, 3 = unoccluded)
+//   bits 20-27  light as packed by packLight(), block light in 20-23 and sky light in 24-27
+constexpr uint32_t VERTEX_POSITION_BITS = 5;
+constexpr uint32_t VERTEX_NORMAL_SHIFT = 15;
+constexpr uint32_t VERTEX_OCCLUSION_SHIFT = 18;
+constexpr uint32_t VERTEX_LIGHT_SHIFT = 20;
+
+constexpr uint32_t packVertex(glm::ivec3 position, uint32_t normal, uint32_t occlusion, uint32_t light) {
+  return static_cast<uint32_t>(position.x) |
+         static_cast<uint32_t>(position.y) << VERTEX_POSITION_BITS |
+         static_cast<uint32_t>(position.z) << (VERTEX_POSITION_BITS * 2) |
+         normal << VERTEX_NORMAL_SHIFT |
+         occlusion << VERTEX_OCCLUSION_SHIFT |
+         light << VERTEX_LIGHT_SHIFT;
+}
+
+struct MeshStats {
+  size_t quads = 0;
+  size_t naiveQuads = 0;
+
+  MeshStats &operator+=(const MeshStats &other) {
+    quads += other.quads;
+    naiveQuads += other.naiveQuads;
+    return *this;
+  }
+};
+
+struct MeshData {
+  std::vector<uint32_t> vertices;
+  std::vector<uint32_t> indices;
+  MeshStats stats;
+  int lodLevel = 0;
+
+  [[nodiscard]] size_t byteSize() const {
+    return vertices.size() * sizeof(uint32_t) + indices.size() * sizeof(uint32_t);
+  }
+};
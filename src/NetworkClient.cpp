@@ -0,0 +1,212 @@
+#include "NetworkClient.hpp"
+#include <algorithm>
+#include <iostream>
+
+bool NetworkClient::connect(const std::string &host, uint16_t port, int viewRadius, glm::vec3 position) {
+  if (!SocketAddress::resolve(host, port, serverAddress)) {
+    std::cerr << "Could not resolve server " << host << std::endl;
+    return false;
+  }
+
+  auto socket = Socket::connectTcp(serverAddress);
+  if (!socket.isValid()) {
+    return false;
+  }
+  socket.setNoDelay(true);
+
+  datagrams = Socket::bindUdp(0);
+  connection = Connection(std::move(socket));
+  welcomed = false;
+  chunkVersions.clear();
+
+  HelloMessage hello{};
+  hello.version = PROTOCOL_VERSION;
+  hello.viewRadius = static_cast<uint8_t>(std::clamp(viewRadius, 1, 255));
+  hello.position = position;
+  writeHello(connection.getSendBuffer(), hello);
+  return connection.flush();
+}
+
+bool NetworkClient::poll() {
+  if (!connection.receive()) {
+    return false;
+  }
+
+  MessageType type;
+  ByteReader payload;
+  while (connection.nextMessage(type, payload)) {
+    if (!handleMessage(type, payload)) {
+      std::cerr << "Malformed message of type " << static_cast<int>(type) << " from the server" << std::endl;
+      connection.close();
+      return false;
+    }
+  }
+
+  return connection.flush();
+}
+
+void NetworkClient::sendInputs(const std::vector<PlayerInput> &inputs) {
+  if (!welcomed || !datagrams.isValid() || inputs.empty()) {
+    return;
+  }
+
+  PlayerInputMessage message{welcome.token, {}};
+  auto first = inputs.size() > INPUTS_PER_DATAGRAM ? inputs.end() - INPUTS_PER_DATAGRAM : inputs.begin();
+  message.inputs.assign(first, inputs.end());
+
+  std::vector<uint8_t> datagram;
+  writePlayerInput(datagram, message);
+  if (datagrams.sendTo(datagram.data(), datagram.size(), serverAddress) > 0) {
+    datagramBytesSent += datagram.size();
+  }
+}
+
+void NetworkClient::sendSetBlock(glm::ivec3 position, BlockId block) {
+  if (welcomed) {
+    writeSetBlock(connection.getSendBuffer(), {position, block});
+  }
+}
+
+void NetworkClient::setColumnReceivedHandler(ColumnReceivedHandler handler) {
+  columnReceived = std::move(handler);
+}
+
+void NetworkClient::setChunkReceivedHandler(ChunkReceivedHandler handler) {
+  chunkReceived = std::move(handler);
+}
+
+void NetworkClient::setColumnUnloadedHandler(ColumnUnloadedHandler handler) {
+  columnUnloaded = std::move(handler);
+}
+
+void NetworkClient::setBlockChangesHandler(BlockChangesHandler handler) {
+  blockChanges = std::move(handler);
+}
+
+void NetworkClient::setPlayerStatesHandler(PlayerStatesHandler handler) {
+  playerStatesReceived = std::move(handler);
+}
+
+bool NetworkClient::isConnected() const {
+  return connection.isOpen();
+}
+
+bool NetworkClient::isWelcomed() const {
+  return welcomed;
+}
+
+const WelcomeMessage &NetworkClient::getWelcome() const {
+  return welcome;
+}
+
+NetworkClientStats NetworkClient::getStats() const {
+  return {connection.getBytesReceived(), connection.getBytesSent() + datagramBytesSent, columnsReceived,
+          chunksReceived, columnsUnloaded, blockChangeBatches, resyncs, playerStates, serverTick};
+}
+
+bool NetworkClient::handleMessage(MessageType type, ByteReader &payload) {
+  switch (type) {
+    case MessageType::Welcome: {
+      if (!readWelcome(payload, welcome)) {
+        return false;
+      }
+
+      // Inputs go to the UDP port the server announced, on the host we reached it at
+      welcomed = true;
+      serverAddress.setPort(welcome.udpPort);
+      return true;
+    }
+    case MessageType::ColumnData: {
+      ColumnDataMessage message{};
+      if (!readColumnData(payload, message)) {
+        return false;
+      }
+
+      ++columnsReceived;
+      if (columnReceived) {
+        columnReceived(message.position, message.firstSurfaceChunk);
+      }
+      return true;
+    }
+    case MessageType::ChunkData: {
+      ChunkPos position;
+      uint32_t version;
+      BlockStorage blocks;
+      if (!readChunkData(payload, position, version, blocks)) {
+        return false;
+      }
+
+      ++chunksReceived;
+      chunkVersions[position] = version;
+      if (chunkReceived) {
+        chunkReceived(position, std::move(blocks));
+      }
+      return true;
+    }
+    case MessageType::ColumnUnload: {
+      ColumnPos position;
+      if (!readColumnUnload(payload, position)) {
+        return false;
+      }
+
+      ++columnsUnloaded;
+      for (auto y = 0; y < WORLD_HEIGHT_CHUNKS; ++y) {
+        chunkVersions.erase({position.x, y, position.y});
+      }
+      if (columnUnloaded) {
+        columnUnloaded(position);
+      }
+      return true;
+    }
+    case MessageType::BlockChanges: {
+      BlockChangesMessage message;
+      if (!readBlockChanges(payload, message)) {
+        return false;
+      }
+
+      auto version = chunkVersions.find(message.position);
+      if (version == chunkVersions.end()) {
+        return true;
+      }
+
+      // A gap means a batch went missing or arrived for an older copy; only a full chunk can fix that
+      if (version->second != message.baseVersion) {
+        chunkVersions.erase(version);
+        writeChunkResync(connection.getSendBuffer(), message.position);
+        ++resyncs;
+        return true;
+      }
+
+      version->second = message.version;
+      ++blockChangeBatches;
+      if (blockChanges) {
+        blockChanges(message.position, message.changes);
+      }
+      return true;
+    }
+    case MessageType::ServerTick: {
+      ServerTickMessage tick{};
+      if (!readServerTick(payload, tick)) {
+        return false;
+      }
+
+      serverTick = tick.tick;
+      return true;
+    }
+    case MessageType::PlayerStates: {
+      PlayerStatesMessage message{};
+      if (!readPlayerStates(payload, message)) {
+        return false;
+      }
+
+      ++playerStates;
+      if (playerStatesReceived) {
+        playerStatesReceived(message);
+      }
+      return true;
+    }
+    default:
+      // Unknown messages are skipped so newer servers can add them
+      return true;
+  }
+}
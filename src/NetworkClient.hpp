@@ -0,0 +1,90 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include "BlockStorage.hpp"
+#include "Connection.hpp"
+#include "Protocol.hpp"
+
+using ColumnReceivedHandler = std::function<void(ColumnPos position, int firstSurfaceChunk)>;
+using ChunkReceivedHandler = std::function<void(ChunkPos position, BlockStorage &&blocks)>;
+using ColumnUnloadedHandler = std::function<void(ColumnPos position)>;
+using BlockChangesHandler = std::function<void(ChunkPos position, const std::vector<BlockChange> &changes)>;
+using PlayerStatesHandler = std::function<void(const PlayerStatesMessage &message)>;
+
+struct NetworkClientStats {
+  uint64_t bytesReceived;
+  uint64_t bytesSent;
+  uint64_t columnsReceived;
+  uint64_t chunksReceived;
+  uint64_t columnsUnloaded;
+  uint64_t blockChangeBatches;
+  uint64_t resyncs;
+  uint64_t playerStates;
+  uint32_t serverTick;
+};
+
+// Client side of the server protocol. Nothing happens in the background: poll() reads whatever arrived
+// and calls the handlers on the calling thread, so it can be driven from the game loop or, many
+// instances at once, from a load test.
+class NetworkClient {
+public:
+  // Connects and sends the hello; returns false when the server cannot be reached
+  bool connect(const std::string &host, uint16_t port, int viewRadius, glm::vec3 position);
+
+  // Returns false once the connection has been lost
+  bool poll();
+
+  // Sent unreliably in one datagram, so callers resend recent inputs along with the new one; dropped silently
+  // until the server has welcomed us
+  void sendInputs(const std::vector<PlayerInput> &inputs);
+
+  // Asks the server to change a block; the world only changes once the server's BlockChanges come back
+  void sendSetBlock(glm::ivec3 position, BlockId block);
+
+  void setColumnReceivedHandler(ColumnReceivedHandler handler);
+
+  void setChunkReceivedHandler(ChunkReceivedHandler handler);
+
+  void setColumnUnloadedHandler(ColumnUnloadedHandler handler);
+
+  void setBlockChangesHandler(BlockChangesHandler handler);
+
+  void setPlayerStatesHandler(PlayerStatesHandler handler);
+
+  [[nodiscard]] bool isConnected() const;
+
+  [[nodiscard]] bool isWelcomed() const;
+
+  [[nodiscard]] const WelcomeMessage &getWelcome() const;
+
+  [[nodiscard]] NetworkClientStats getStats() const;
+
+private:
+  Connection connection;
+  Socket datagrams;
+  SocketAddress serverAddress;
+
+  bool welcomed = false;
+  WelcomeMessage welcome{};
+  uint64_t datagramBytesSent = 0;
+  uint64_t columnsReceived = 0;
+  uint64_t chunksReceived = 0;
+  uint64_t columnsUnloaded = 0;
+  uint64_t blockChangeBatches = 0;
+  uint64_t resyncs = 0;
+  uint64_t playerStates = 0;
+  uint32_t serverTick = 0;
+
+  // Version of every loaded chunk; a chunk waiting on a resync has no entry and ignores changes until then
+  std::unordered_map<ChunkPos, uint32_t, ChunkPosHash> chunkVersions;
+
+  ColumnReceivedHandler columnReceived;
+  ChunkReceivedHandler chunkReceived;
+  ColumnUnloadedHandler columnUnloaded;
+  BlockChangesHandler blockChanges;
+  PlayerStatesHandler playerStatesReceived;
+
+  bool handleMessage(MessageType type, ByteReader &payload);
+};
@@ -0,0 +1,532 @@
+#include "Noise.hpp"
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+// The kernels below are written once against a lane backend and instantiated for plain floats and for
+// SIMD registers. Both backends perform the same IEEE operations in the same order, and nothing may be
+// contracted into fused multiply-adds, which is what keeps the batched results bit-identical.
+
+namespace {
+  constexpr float F2 = 0.36602540378f;
+  constexpr float G2 = 0.2113248654f;
+  constexpr float F3 = 1.0f / 3.0f;
+  constexpr float G3 = 1.0f / 6.0f;
+
+  constexpr uint32_t PRIME_X = 0x27d4eb2du;
+  constexpr uint32_t PRIME_Y = 0x165667b1u;
+  constexpr uint32_t PRIME_Z = 0x9e3779b1u;
+  constexpr uint32_t MIX = 0x2c1b3c6du;
+
+  struct ScalarLanes {
+    using Float = float;
+    using Int = uint32_t;
+    using Mask = bool;
+
+    static constexpr int LANE_COUNT = 1;
+
+    static Float load(const float *p) { return *p; }
+
+    static void store(float *p, Float v) { *p = v; }
+
+    static Float splat(float v) { return v; }
+
+    static Int splatInt(uint32_t v) { return v; }
+
+    static Float add(Float a, Float b) { return a + b; }
+
+    static Float sub(Float a, Float b) { return a - b; }
+
+    static Float mul(Float a, Float b) { return a * b; }
+
+    static Float div(Float a, Float b) { return a / b; }
+
+    static Float negate(Float v) { return -v; }
+
+    static Int floorToInt(Float v) {
+      auto truncated = static_cast<int32_t>(v);
+      return static_cast<uint32_t>(static_cast<float>(truncated) > v ? truncated - 1 : truncated);
+    }
+
+    static Float toFloat(Int v) { return static_cast<float>(static_cast<int32_t>(v)); }
+
+    static Int addInt(Int a, Int b) { return a + b; }
+
+    static Int mulInt(Int a, Int b) { return a * b; }
+
+    static Int xorInt(Int a, Int b) { return a ^ b; }
+
+    static Int andInt(Int a, Int b) { return a & b; }
+
+    template<int N>
+    static Int shiftRight(Int v) { return v >> N; }
+
+    static Mask greater(Float a, Float b) { return a > b; }
+
+    static Mask greaterEqual(Float a, Float b) { return a >= b; }
+
+    static Mask isZero(Int v) { return v == 0; }
+
+    static Mask maskAnd(Mask a, Mask b) { return a && b; }
+
+    static Mask maskOr(Mask a, Mask b) { return a || b; }
+
+    static Float select(Mask mask, Float a, Float b) { return mask ? a : b; }
+
+    static Int selectInt(Mask mask, Int a, Int b) { return mask ? a : b; }
+  };
+
+#if defined(__AVX2__)
+  struct SimdLanes {
+    using Float = __m256;
+    using Int = __m256i;
+    using Mask = __m256;
+
+    static constexpr int LANE_COUNT = 8;
+
+    static Float load(const float *p) { return _mm256_loadu_ps(p); }
+
+    static void store(float *p, Float v) { _mm256_storeu_ps(p, v); }
+
+    static Float splat(float v) { return _mm256_set1_ps(v); }
+
+    static Int splatInt(uint32_t v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+
+    static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+
+    static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+
+    static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+
+    static Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+
+    static Float negate(Float v) { return _mm256_xor_ps(v, _mm256_set1_ps(-0.0f)); }
+
+    static Int floorToInt(Float v) {
+      auto truncated = _mm256_cvttps_epi32(v);
+      auto adjust = _mm256_castps_si256(_mm256_cmp_ps(_mm256_cvtepi32_ps(truncated), v, _CMP_GT_OQ));
+      return _mm256_add_epi32(truncated, adjust);
+    }
+
+    static Float toFloat(Int v) { return _mm256_cvtepi32_ps(v); }
+
+    static Int addInt(Int a, Int b) { return _mm256_add_epi32(a, b); }
+
+    static Int mulInt(Int a, Int b) { return _mm256_mullo_epi32(a, b); }
+
+    static Int xorInt(Int a, Int b) { return _mm256_xor_si256(a, b); }
+
+    static Int andInt(Int a, Int b) { return _mm256_and_si256(a, b); }
+
+    template<int N>
+    static Int shiftRight(Int v) { return _mm256_srli_epi32(v, N); }
+
+    static Mask greater(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+
+    static Mask greaterEqual(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+
+    static Mask isZero(Int v) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(v, _mm256_setzero_si256())); }
+
+    static Mask maskAnd(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+
+    static Mask maskOr(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+
+    static Float select(Mask mask, Float a, Float b) {
+      return _mm256_or_ps(_mm256_and_ps(mask, a), _mm256_andnot_ps(mask, b));
+    }
+
+    static Int selectInt(Mask mask, Int a, Int b) {
+      return _mm256_castps_si256(select(mask, _mm256_castsi256_ps(a), _mm256_castsi256_ps(b)));
+    }
+  };
+#elif defined(__SSE2__) || defined(_M_X64)
+  struct SimdLanes {
+    using Float = __m128;
+    using Int = __m128i;
+    using Mask = __m128;
+
+    static constexpr int LANE_COUNT = 4;
+
+    static Float load(const float *p) { return _mm_loadu_ps(p); }
+
+    static void store(float *p, Float v) { _mm_storeu_ps(p, v); }
+
+    static Float splat(float v) { return _mm_set1_ps(v); }
+
+    static Int splatInt(uint32_t v) { return _mm_set1_epi32(static_cast<int>(v)); }
+
+    static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+
+    static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+
+    static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+
+    static Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+
+    static Float negate(Float v) { return _mm_xor_ps(v, _mm_set1_ps(-0.0f)); }
+
+    static Int floorToInt(Float v) {
+      auto truncated = _mm_cvttps_epi32(v);
+      auto adjust = _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(truncated), v));
+      return _mm_add_epi32(truncated, adjust);
+    }
+
+    static Float toFloat(Int v) { return _mm_cvtepi32_ps(v); }
+
+    static Int addInt(Int a, Int b) { return _mm_add_epi32(a, b); }
+
+    // SSE2 has no 32-bit low multiply, so multiply even and odd lanes separately and interleave
+    static Int mulInt(Int a, Int b) {
+      auto even = _mm_mul_epu32(a, b);
+      auto odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+      return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+
+    static Int xorInt(Int a, Int b) { return _mm_xor_si128(a, b); }
+
+    static Int andInt(Int a, Int b) { return _mm_and_si128(a, b); }
+
+    template<int N>
+    static Int shiftRight(Int v) { return _mm_srli_epi32(v, N); }
+
+    static Mask greater(Float a, Float b) { return _mm_cmpgt_ps(a, b); }
+
+    static Mask greaterEqual(Float a, Float b) { return _mm_cmpge_ps(a, b); }
+
+    static Mask isZero(Int v) { return _mm_castsi128_ps(_mm_cmpeq_epi32(v, _mm_setzero_si128())); }
+
+    static Mask maskAnd(Mask a, Mask b) { return _mm_and_ps(a, b); }
+
+    static Mask maskOr(Mask a, Mask b) { return _mm_or_ps(a, b); }
+
+    static Float select(Mask mask, Float a, Float b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+
+    static Int selectInt(Mask mask, Int a, Int b) {
+      return _mm_castps_si128(select(mask, _mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+    }
+  };
+#elif defined(__wasm_simd128__)
+  struct SimdLanes {
+    using Float = v128_t;
+    using Int = v128_t;
+    using Mask = v128_t;
+
+    static constexpr int LANE_COUNT = 4;
+
+    static Float load(const float *p) { return wasm_v128_load(p); }
+
+    static void store(float *p, Float v) { wasm_v128_store(p, v); }
+
+    static Float splat(float v) { return wasm_f32x4_splat(v); }
+
+    static Int splatInt(uint32_t v) { return wasm_u32x4_splat(v); }
+
+    static Float add(Float a, Float b) { return wasm_f32x4_add(a, b); }
+
+    static Float sub(Float a, Float b) { return wasm_f32x4_sub(a, b); }
+
+    static Float mul(Float a, Float b) { return wasm_f32x4_mul(a, b); }
+
+    static Float div(Float a, Float b) { return wasm_f32x4_div(a, b); }
+
+    static Float negate(Float v) { return wasm_f32x4_neg(v); }
+
+    static Int floorToInt(Float v) {
+      auto truncated = wasm_i32x4_trunc_sat_f32x4(v);
+      return wasm_i32x4_add(truncated, wasm_f32x4_gt(wasm_f32x4_convert_i32x4(truncated), v));
+    }
+
+    static Float toFloat(Int v) { return wasm_f32x4_convert_i32x4(v); }
+
+    static Int addInt(Int a, Int b) { return wasm_i32x4_add(a, b); }
+
+    static Int mulInt(Int a, Int b) { return wasm_i32x4_mul(a, b); }
+
+    static Int xorInt(Int a, Int b) { return wasm_v128_xor(a, b); }
+
+    static Int andInt(Int a, Int b) { return wasm_v128_and(a, b); }
+
+    template<int N>
+    static Int shiftRight(Int v) { return wasm_u32x4_shr(v, N); }
+
+    static Mask greater(Float a, Float b) { return wasm_f32x4_gt(a, b); }
+
+    static Mask greaterEqual(Float a, Float b) { return wasm_f32x4_ge(a, b); }
+
+    static Mask isZero(Int v) { return wasm_i32x4_eq(v, wasm_i32x4_splat(0)); }
+
+    static Mask maskAnd(Mask a, Mask b) { return wasm_v128_and(a, b); }
+
+    static Mask maskOr(Mask a, Mask b) { return wasm_v128_or(a, b); }
+
+    static Float select(Mask mask, Float a, Float b) { return wasm_v128_bitselect(a, b, mask); }
+
+    static Int selectInt(Mask mask, Int a, Int b) { return wasm_v128_bitselect(a, b, mask); }
+  };
+#else
+  using SimdLanes = ScalarLanes;
+#endif
+
+  template<typename L>
+  typename L::Int hash(typename L::Int seed, typename L::Int i, typename L::Int j) {
+    auto h = L::xorInt(seed, L::mulInt(i, L::splatInt(PRIME_X)));
+    h = L::xorInt(h, L::mulInt(j, L::splatInt(PRIME_Y)));
+    h = L::xorInt(h, L::template shiftRight<15>(h));
+    h = L::mulInt(h, L::splatInt(MIX));
+    return L::xorInt(h, L::template shiftRight<12>(h));
+  }
+
+  template<typename L>
+  typename L::Int hash(typename L::Int seed, typename L::Int i, typename L::Int j, typename L::Int k) {
+    return hash<L>(L::xorInt(seed, L::mulInt(k, L::splatInt(PRIME_Z))), i, j);
+  }
+
+  // Eight gradients (±1, ±2) and (±2, ±1), chosen by the low three hash bits
+  template<typename L>
+  typename L::Float gradient(typename L::Int h, typename L::Float x, typename L::Float y) {
+    auto low = L::isZero(L::andInt(h, L::splatInt(4)));
+    auto u = L::select(low, x, y);
+    auto v = L::mul(L::select(low, y, x), L::splat(2.0f));
+    u = L::select(L::isZero(L::andInt(h, L::splatInt(1))), u, L::negate(u));
+    v = L::select(L::isZero(L::andInt(h, L::splatInt(2))), v, L::negate(v));
+    return L::add(u, v);
+  }
+
+  // The twelve cube edge gradients, padded to sixteen, chosen by the low four hash bits
+  template<typename L>
+  typename L::Float gradient(typename L::Int h, typename L::Float x, typename L::Float y, typename L::Float z) {
+    auto bits = L::andInt(h, L::splatInt(15));
+    auto u = L::select(L::isZero(L::andInt(h, L::splatInt(8))), x, y);
+    auto xPlane = L::maskOr(L::isZero(L::xorInt(bits, L::splatInt(12))), L::isZero(L::xorInt(bits, L::splatInt(14))));
+    auto v = L::select(L::isZero(L::andInt(h, L::splatInt(12))), y, L::select(xPlane, x, z));
+    u = L::select(L::isZero(L::andInt(h, L::splatInt(1))), u, L::negate(u));
+    v = L::select(L::isZero(L::andInt(h, L::splatInt(2))), v, L::negate(v));
+    return L::add(u, v);
+  }
+
+  template<typename L>
+  typename L::Float corner(typename L::Int h, typename L::Float x, typename L::Float y) {
+    auto t = L::sub(L::sub(L::splat(0.5f), L::mul(x, x)), L::mul(y, y));
+    auto t2 = L::mul(t, t);
+    return L::select(L::greater(t, L::splat(0.0f)), L::mul(L::mul(t2, t2), gradient<L>(h, x, y)), L::splat(0.0f));
+  }
+
+  template<typename L>
+  typename L::Float corner(typename L::Int h, typename L::Float x, typename L::Float y, typename L::Float z) {
+    auto t = L::sub(L::sub(L::sub(L::splat(0.6f), L::mul(x, x)), L::mul(y, y)), L::mul(z, z));
+    auto t2 = L::mul(t, t);
+    return L::select(L::greater(t, L::splat(0.0f)), L::mul(L::mul(t2, t2), gradient<L>(h, x, y, z)),
+                     L::splat(0.0f));
+  }
+
+  template<typename L>
+  typename L::Float simplex(typename L::Float x, typename L::Float y, typename L::Int seed) {
+    auto s = L::mul(L::add(x, y), L::splat(F2));
+    auto i = L::floorToInt(L::add(x, s));
+    auto j = L::floorToInt(L::add(y, s));
+    auto t = L::mul(L::toFloat(L::addInt(i, j)), L::splat(G2));
+    auto x0 = L::sub(x, L::sub(L::toFloat(i), t));
+    auto y0 = L::sub(y, L::sub(L::toFloat(j), t));
+
+    // Which of the two triangles in the skewed cell the point falls in
+    auto lower = L::greater(x0, y0);
+    auto one = L::splat(1.0f);
+    auto zero = L::splat(0.0f);
+    auto i1 = L::select(lower, one, zero);
+    auto j1 = L::select(lower, zero, one);
+
+    auto x1 = L::add(L::sub(x0, i1), L::splat(G2));
+    auto y1 = L::add(L::sub(y0, j1), L::splat(G2));
+    auto x2 = L::add(L::sub(x0, one), L::splat(2.0f * G2));
+    auto y2 = L::add(L::sub(y0, one), L::splat(2.0f * G2));
+
+    auto oneInt = L::splatInt(1);
+    auto zeroInt = L::splatInt(0);
+    auto n0 = corner<L>(hash<L>(seed, i, j), x0, y0);
+    auto n1 = corner<L>(hash<L>(seed, L::addInt(i, L::selectInt(lower, oneInt, zeroInt)),
+                                L::addInt(j, L::selectInt(lower, zeroInt, oneInt))), x1, y1);
+    auto n2 = corner<L>(hash<L>(seed, L::addInt(i, oneInt), L::addInt(j, oneInt)), x2, y2);
+    // Scaled for the (±1, ±2) gradient set, whose extremes are half as large again as unit gradients
+    return L::mul(L::splat(45.23f), L::add(L::add(n0, n1), n2));
+  }
+
+  template<typename L>
+  typename L::Float simplex(typename L::Float x, typename L::Float y, typename L::Float z, typename L::Int seed) {
+    auto s = L::mul(L::add(L::add(x, y), z), L::splat(F3));
+    auto i = L::floorToInt(L::add(x, s));
+    auto j = L::floorToInt(L::add(y, s));
+    auto k = L::floorToInt(L::add(z, s));
+    auto t = L::mul(L::toFloat(L::addInt(L::addInt(i, j), k)), L::splat(G3));
+    auto x0 = L::sub(x, L::sub(L::toFloat(i), t));
+    auto y0 = L::sub(y, L::sub(L::toFloat(j), t));
+    auto z0 = L::sub(z, L::sub(L::toFloat(k), t));
+
+    // Rank the offsets to find the simplex, without branches
+    auto xy = L::greaterEqual(x0, y0);
+    auto xz = L::greaterEqual(x0, z0);
+    auto yx = L::greater(y0, x0);
+    auto yz = L::greaterEqual(y0, z0);
+    auto zx = L::greater(z0, x0);
+    auto zy = L::greater(z0, y0);
+
+    auto one = L::splat(1.0f);
+    auto zero = L::splat(0.0f);
+    auto oneInt = L::splatInt(1);
+    auto zeroInt = L::splatInt(0);
+
+    typename L::Mask offsets[2][3] = {
+      {L::maskAnd(xy, xz), L::maskAnd(yx, yz), L::maskAnd(zx, zy)},
+      {L::maskOr(xy, xz), L::maskOr(yx, yz), L::maskOr(zx, zy)}
+    };
+
+    auto n = corner<L>(hash<L>(seed, i, j, k), x0, y0, z0);
+    for (auto step = 0; step < 2; ++step) {
+      const auto &offset = offsets[step];
+      auto bias = L::splat(static_cast<float>(step + 1) * G3);
+      auto cx = L::add(L::sub(x0, L::select(offset[0], one, zero)), bias);
+      auto cy = L::add(L::sub(y0, L::select(offset[1], one, zero)), bias);
+      auto cz = L::add(L::sub(z0, L::select(offset[2], one, zero)), bias);
+      auto h = hash<L>(seed, L::addInt(i, L::selectInt(offset[0], oneInt, zeroInt)),
+                       L::addInt(j, L::selectInt(offset[1], oneInt, zeroInt)),
+                       L::addInt(k, L::selectInt(offset[2], oneInt, zeroInt)));
+      n = L::add(n, corner<L>(h, cx, cy, cz));
+    }
+
+    auto bias = L::splat(3.0f * G3);
+    auto cx = L::add(L::sub(x0, one), bias);
+    auto cy = L::add(L::sub(y0, one), bias);
+    auto cz = L::add(L::sub(z0, one), bias);
+    n = L::add(n, corner<L>(hash<L>(seed, L::addInt(i, oneInt), L::addInt(j, oneInt), L::addInt(k, oneInt)),
+                            cx, cy, cz));
+    return L::mul(L::splat(32.0f), n);
+  }
+
+  float amplitudeSum(const FractalSettings &settings) {
+    auto sum = 0.0f;
+    auto amplitude = 1.0f;
+    for (auto octave = 0; octave < settings.octaves; ++octave) {
+      sum += amplitude;
+      amplitude *= settings.gain;
+    }
+    return sum;
+  }
+
+  template<typename L>
+  typename L::Float fractal(typename L::Float x, typename L::Float y, uint32_t seed, const FractalSettings &settings,
+                            float normalisation) {
+    auto sum = L::splat(0.0f);
+    auto amplitude = 1.0f;
+    auto frequency = 1.0f;
+    for (auto octave = 0; octave < settings.octaves; ++octave) {
+      auto f = L::splat(frequency);
+      auto value = simplex<L>(L::mul(x, f), L::mul(y, f), L::splatInt(seed + static_cast<uint32_t>(octave)));
+      sum = L::add(sum, L::mul(L::splat(amplitude), value));
+      amplitude *= settings.gain;
+      frequency *= settings.lacunarity;
+    }
+    return L::div(sum, L::splat(normalisation));
+  }
+
+  template<typename L>
+  typename L::Float fractal(typename L::Float x, typename L::Float y, typename L::Float z, uint32_t seed,
+                            const FractalSettings &settings, float normalisation) {
+    auto sum = L::splat(0.0f);
+    auto amplitude = 1.0f;
+    auto frequency = 1.0f;
+    for (auto octave = 0; octave < settings.octaves; ++octave) {
+      auto f = L::splat(frequency);
+      auto value = simplex<L>(L::mul(x, f), L::mul(y, f), L::mul(z, f),
+                              L::splatInt(seed + static_cast<uint32_t>(octave)));
+      sum = L::add(sum, L::mul(L::splat(amplitude), value));
+      amplitude *= settings.gain;
+      frequency *= settings.lacunarity;
+    }
+    return L::div(sum, L::splat(normalisation));
+  }
+}
+
+float simplexNoise2(float x, float y, uint32_t seed) {
+  return simplex<ScalarLanes>(x, y, seed);
+}
+
+float simplexNoise3(float x, float y, float z, uint32_t seed) {
+  return simplex<ScalarLanes>(x, y, z, seed);
+}
+
+float fractalNoise2(float x, float y, uint32_t seed, const FractalSettings &settings) {
+  return fractal<ScalarLanes>(x, y, seed, settings, amplitudeSum(settings));
+}
+
+float fractalNoise3(float x, float y, float z, uint32_t seed, const FractalSettings &settings) {
+  return fractal<ScalarLanes>(x, y, z, seed, settings, amplitudeSum(settings));
+}
+
+void fractalNoise2(const float *xs, const float *ys, size_t count, uint32_t seed, const FractalSettings &settings,
+                   float *out) {
+  auto normalisation = amplitudeSum(settings);
+
+  size_t i = 0;
+  for (; i + SimdLanes::LANE_COUNT <= count; i += SimdLanes::LANE_COUNT) {
+    SimdLanes::store(out + i, fractal<SimdLanes>(SimdLanes::load(xs + i), SimdLanes::load(ys + i), seed, settings,
+                                                 normalisation));
+  }
+  for (; i < count; ++i) {
+    out[i] = fractal<ScalarLanes>(xs[i], ys[i], seed, settings, normalisation);
+  }
+}
+
+void fractalNoise3(const float *xs, const float *ys, const float *zs, size_t count, uint32_t seed,
+                   const FractalSettings &settings, float *out) {
+  auto normalisation = amplitudeSum(settings);
+
+  size_t i = 0;
+  for (; i + SimdLanes::LANE_COUNT <= count; i += SimdLanes::LANE_COUNT) {
+    SimdLanes::store(out + i, fractal<SimdLanes>(SimdLanes::load(xs + i), SimdLanes::load(ys + i),
+                                                 SimdLanes::load(zs + i), seed, settings, normalisation));
+  }
+  for (; i < count; ++i) {
+    out[i] = fractal<ScalarLanes>(xs[i], ys[i], zs[i], seed, settings, normalisation);
+  }
+}
+
+void fractalNoiseGrid2(glm::vec2 origin, float step, int width, int height, uint32_t seed,
+                       const FractalSettings &settings, float *out) {
+  auto count = static_cast<size_t>(width) * height;
+  std::vector<float> xs(count);
+  std::vector<float> ys(count);
+  for (auto x = 0; x < width; ++x) {
+    for (auto y = 0; y < height; ++y) {
+      xs[x * height + y] = origin.x + static_cast<float>(x) * step;
+      ys[x * height + y] = origin.y + static_cast<float>(y) * step;
+    }
+  }
+
+  fractalNoise2(xs.data(), ys.data(), count, seed, settings, out);
+}
+
+void fractalNoiseGrid3(glm::vec3 origin, float step, glm::ivec3 size, uint32_t seed, const FractalSettings &settings,
+                       float *out) {
+  auto count = static_cast<size_t>(size.x) * size.y * size.z;
+  std::vector<float> xs(count);
+  std::vector<float> ys(count);
+  std::vector<float> zs(count);
+  for (auto x = 0; x < size.x; ++x) {
+    for (auto y = 0; y < size.y; ++y) {
+      for (auto z = 0; z < size.z; ++z) {
+        auto i = (static_cast<size_t>(x) * size.y + y) * size.z + z;
+        xs[i] = origin.x + static_cast<float>(x) * step;
+        ys[i] = origin.y + static_cast<float>(y) * step;
+        zs[i] = origin.z + static_cast<float>(z) * step;
+      }
+    }
+  }
+
+  fractalNoise3(xs.data(), ys.data(), zs.data(), count, seed, settings, out);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+struct FractalSettings {
+  int octaves = 1;
+  float lacunarity = 2.0f;
+  float gain = 0.5f;
+};
+
+// Scalar reference simplex noise in [-1, 1], hashed from integer lattice coordinates and a seed
+float simplexNoise2(float x, float y, uint32_t seed);
+
+float simplexNoise3(float x, float y, float z, uint32_t seed);
+
+// Octaves of simplex noise, each at lacunarity times the previous frequency and gain times its amplitude,
+// normalised back to [-1, 1]. Every octave hashes with its own seed.
+float fractalNoise2(float x, float y, uint32_t seed, const FractalSettings &settings);
+
+float fractalNoise3(float x, float y, float z, uint32_t seed, const FractalSettings &settings);
+
+// Batched versions over SoA points, evaluated several at a time with SIMD lanes and bit-identical to the
+// scalar functions above
+void fractalNoise2(const float *xs, const float *ys, size_t count, uint32_t seed, const FractalSettings &settings,
+                   float *out);
+
+void fractalNoise3(const float *xs, const float *ys, const float *zs, size_t count, uint32_t seed,
+                   const FractalSettings &settings, float *out);
+
+// Samples origin + index * step over a grid, written to out[x * height + y] in 2D and
+// out[(x * size.y + y) * size.z + z] in 3D to match chunk block order
+void fractalNoiseGrid2(glm::vec2 origin, float step, int width, int height, uint32_t seed,
+                       const FractalSettings &settings, float *out);
+
+void fractalNoiseGrid3(glm::vec3 origin, float step, glm::ivec3 size, uint32_t seed, const FractalSettings &settings,
+                       float *out);
@@ -0,0 +1,313 @@
+#include "PlayerMovement.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  const glm::vec3 MOVEMENT_UP(0.0f, 1.0f, 0.0f);
+
+  // Slack that keeps a box resting against a face from counting as inside the block behind it
+  constexpr float CONTACT_EPSILON = 1e-4f;
+
+  // Sequence numbers compared so that wrapping around still counts as newer
+  bool isNewer(uint32_t sequence, uint32_t than) {
+    return static_cast<int32_t>(sequence - than) > 0;
+  }
+
+  int floorToInt(float value) {
+    return static_cast<int>(std::floor(value));
+  }
+
+  // How far the box can move along one axis before its leading face meets a solid block, checking one
+  // layer of blocks at a time across the box's cross-section. Blocks the box already overlaps are ignored,
+  // so a player who ends up inside one can still walk out.
+  float sweepAxis(const PlayerBox &box, int axis, float delta, const SolidBlockQuery &isSolid) {
+    if (delta == 0.0f) {
+      return 0.0f;
+    }
+
+    auto u = (axis + 1) % 3;
+    auto v = (axis + 2) % 3;
+    auto uLow = floorToInt(box.min[u] + CONTACT_EPSILON);
+    auto uHigh = floorToInt(box.max[u] - CONTACT_EPSILON);
+    auto vLow = floorToInt(box.min[v] + CONTACT_EPSILON);
+    auto vHigh = floorToInt(box.max[v] - CONTACT_EPSILON);
+
+    auto isLayerBlocked = [&](int layer) {
+      glm::ivec3 block;
+      block[axis] = layer;
+      for (block[u] = uLow; block[u] <= uHigh; ++block[u]) {
+        for (block[v] = vLow; block[v] <= vHigh; ++block[v]) {
+          if (isSolid(block)) {
+            return true;
+          }
+        }
+      }
+      return false;
+    };
+
+    if (delta > 0.0f) {
+      auto last = floorToInt(box.max[axis] + delta - CONTACT_EPSILON);
+      for (auto layer = floorToInt(box.max[axis] - CONTACT_EPSILON) + 1; layer <= last; ++layer) {
+        if (isLayerBlocked(layer)) {
+          return std::min(delta, static_cast<float>(layer) - box.max[axis]);
+        }
+      }
+    } else {
+      auto last = floorToInt(box.min[axis] + delta + CONTACT_EPSILON);
+      for (auto layer = floorToInt(box.min[axis] + CONTACT_EPSILON) - 1; layer >= last; --layer) {
+        if (isLayerBlocked(layer)) {
+          return std::max(delta, static_cast<float>(layer + 1) - box.min[axis]);
+        }
+      }
+    }
+    return delta;
+  }
+}
+
+PlayerBox getPlayerBox(glm::vec3 position) {
+  return {position - glm::vec3(PLAYER_HALF_WIDTH, PLAYER_EYE_HEIGHT, PLAYER_HALF_WIDTH),
+          position + glm::vec3(PLAYER_HALF_WIDTH, PLAYER_HEIGHT - PLAYER_EYE_HEIGHT, PLAYER_HALF_WIDTH)};
+}
+
+bool overlapsPlayer(glm::vec3 position, glm::ivec3 block) {
+  auto box = getPlayerBox(position);
+  auto low = glm::vec3(block);
+  return glm::all(glm::lessThan(box.min, low + 1.0f - CONTACT_EPSILON)) &&
+         glm::all(glm::greaterThan(box.max, low + CONTACT_EPSILON));
+}
+
+glm::vec3 sweepPlayerBox(PlayerBox &box, glm::vec3 delta, const SolidBlockQuery &isSolid) {
+  glm::vec3 moved(0.0f);
+  for (auto axis: {1, 0, 2}) {
+    moved[axis] = sweepAxis(box, axis, delta[axis], isSolid);
+    box.min[axis] += moved[axis];
+    box.max[axis] += moved[axis];
+  }
+  return moved;
+}
+
+PlayerState simulateMovement(const PlayerState &state, const PlayerInput &input, const SolidBlockQuery &isSolid) {
+  auto flying = (input.buttons & INPUT_FLY) != 0;
+  auto yaw = glm::radians(input.yaw);
+  // Walking ignores the pitch, so looking down does not slow the player
+  auto pitch = flying ? glm::radians(input.pitch) : 0.0f;
+  auto front = glm::normalize(glm::vec3(std::cos(yaw) * std::cos(pitch), std::sin(pitch),
+                                        std::sin(yaw) * std::cos(pitch)));
+  auto right = glm::normalize(glm::cross(front, MOVEMENT_UP));
+
+  glm::vec3 direction(0.0f);
+  if (input.buttons & INPUT_FORWARD) {
+    direction += front;
+  }
+  if (input.buttons & INPUT_BACK) {
+    direction -= front;
+  }
+  if (input.buttons & INPUT_LEFT) {
+    direction -= right;
+  }
+  if (input.buttons & INPUT_RIGHT) {
+    direction += right;
+  }
+  if (flying && (input.buttons & INPUT_JUMP)) {
+    direction += MOVEMENT_UP;
+  }
+  if (glm::dot(direction, direction) > 0.0f) {
+    direction = glm::normalize(direction);
+  }
+
+  auto speed = PLAYER_SPEED * (input.buttons & INPUT_SPRINT ? PLAYER_SPRINT_MULTIPLIER : 1.0f);
+  auto next = state;
+  if (flying) {
+    next.velocity = direction * speed;
+  } else {
+    next.velocity.x = direction.x * speed;
+    next.velocity.z = direction.z * speed;
+    if (state.onGround && (input.buttons & INPUT_JUMP)) {
+      next.velocity.y = JUMP_SPEED;
+    }
+    next.velocity.y = std::max(next.velocity.y - GRAVITY * MOVEMENT_TICK_SECONDS, -TERMINAL_VELOCITY);
+  }
+
+  auto box = getPlayerBox(state.position);
+  auto wanted = next.velocity * MOVEMENT_TICK_SECONDS;
+  auto moved = sweepPlayerBox(box, wanted, isSolid);
+  next.position = state.position + moved;
+
+  // A blocked axis loses its speed, and a blocked fall is a landing
+  for (auto axis = 0; axis < 3; ++axis) {
+    if (moved[axis] != wanted[axis]) {
+      next.velocity[axis] = 0.0f;
+    }
+  }
+  next.onGround = wanted.y < 0.0f && moved.y != wanted.y;
+  return next;
+}
+
+void InputQueue::push(const PlayerInput &input) {
+  if (!isNewer(input.sequence, lastApplied)) {
+    return;
+  }
+
+  // Redundant copies mostly arrive right behind the original, so search from the back
+  auto it = pending.end();
+  while (it != pending.begin() && isNewer((it - 1)->sequence, input.sequence)) {
+    --it;
+  }
+  if (it != pending.begin() && (it - 1)->sequence == input.sequence) {
+    return;
+  }
+  pending.insert(it, input);
+}
+
+size_t InputQueue::apply(PlayerState &state, size_t maxInputs, const SolidBlockQuery &isSolid) {
+  size_t applied = 0;
+  while (applied < maxInputs && !pending.empty()) {
+    state = simulateMovement(state, pending.front(), isSolid);
+    lastApplied = pending.front().sequence;
+    pending.pop_front();
+    ++applied;
+  }
+  return applied;
+}
+
+uint32_t InputQueue::getLastApplied() const {
+  return lastApplied;
+}
+
+size_t InputQueue::getPendingCount() const {
+  return pending.size();
+}
+
+MovementPredictor::MovementPredictor(SolidBlockQuery isSolid, const PlayerState &initial)
+  : isSolid(std::move(isSolid)), state(initial), acknowledged(initial) {
+}
+
+PlayerInput MovementPredictor::predict(uint8_t buttons, float yaw, float pitch) {
+  PlayerInput input{nextSequence++, buttons, yaw, pitch};
+  state = simulateMovement(state, input, isSolid);
+  history.push_back({input, state});
+  if (history.size() > PREDICTION_HISTORY_SIZE) {
+    history.pop_front();
+  }
+  ++stats.predicted;
+  return input;
+}
+
+void MovementPredictor::reconcile(uint32_t lastApplied, const PlayerState &authoritative) {
+  // An older state arriving after a newer one; the same input again still counts, since the server may
+  // have moved the player without any new input
+  if (isNewer(lastReconciled, lastApplied)) {
+    return;
+  }
+  lastReconciled = lastApplied;
+
+  // What was predicted for the acknowledged input, or for a repeated one what the last state settled on
+  auto predicted = acknowledged;
+  while (!history.empty() && !isNewer(history.front().input.sequence, lastApplied)) {
+    if (history.front().input.sequence == lastApplied) {
+      predicted = history.front().state;
+    }
+    history.pop_front();
+  }
+
+  // Identical simulation on both sides only disagrees when the server overrides the client
+  auto error = glm::distance(predicted.position, authoritative.position);
+  stats.lastCorrection = error;
+  stats.maxCorrection = std::max(stats.maxCorrection, error);
+  if (error > 0.0f) {
+    ++stats.corrections;
+  }
+  ++stats.reconciled;
+  acknowledged = authoritative;
+
+  state = authoritative;
+  for (auto &step: history) {
+    state = simulateMovement(state, step.input, isSolid);
+    step.state = state;
+  }
+}
+
+const PlayerState &MovementPredictor::getState() const {
+  return state;
+}
+
+void MovementPredictor::getRecentInputs(size_t count, std::vector<PlayerInput> &inputs) const {
+  inputs.clear();
+  auto first = history.size() > count ? history.size() - count : 0;
+  for (auto i = first; i < history.size(); ++i) {
+    inputs.push_back(history[i].input);
+  }
+}
+
+const PredictionStats &MovementPredictor::getStats() const {
+  return stats;
+}
+
+void RemotePlayers::addSnapshot(uint32_t tick, const std::vector<RemotePlayer> &snapshot,
+                                const std::vector<uint32_t> &removed) {
+  if (started && !isNewer(tick, newestTick)) {
+    return;
+  }
+  newestTick = tick;
+
+  for (auto id: removed) {
+    players.erase(id);
+  }
+
+  for (const auto &player: snapshot) {
+    auto &snapshots = players[player.id];
+    snapshots.push_back({tick, player.position, player.yaw});
+    if (snapshots.size() > MAX_SNAPSHOTS_PER_PLAYER) {
+      snapshots.pop_front();
+    }
+  }
+
+  if (!started) {
+    playbackTick = tick - INTERPOLATION_DELAY_TICKS;
+    started = true;
+  }
+}
+
+void RemotePlayers::advance(double seconds, int tickRate) {
+  if (!started) {
+    return;
+  }
+
+  // Follow the local clock, then ease towards the target so jitter in when snapshots arrive does not show;
+  // a clock far off, after a stall or a pause, jumps instead
+  playbackTick += seconds * tickRate;
+  auto target = static_cast<double>(newestTick) - INTERPOLATION_DELAY_TICKS;
+  if (std::abs(target - playbackTick) > INTERPOLATION_DELAY_TICKS * 2.0) {
+    playbackTick = target;
+  } else {
+    playbackTick += (target - playbackTick) * 0.05;
+  }
+}
+
+void RemotePlayers::sample(std::vector<RemotePlayer> &sampled) const {
+  sampled.clear();
+  for (const auto &[id, snapshots]: players) {
+    auto next = std::find_if(snapshots.begin(), snapshots.end(), [this](const Snapshot &snapshot) {
+      return static_cast<double>(snapshot.tick) > playbackTick;
+    });
+
+    if (next == snapshots.begin()) {
+      sampled.push_back({id, next->position, next->yaw});
+    } else if (next == snapshots.end()) {
+      ++starvedSamples;
+      sampled.push_back({id, snapshots.back().position, snapshots.back().yaw});
+    } else {
+      const auto &previous = *(next - 1);
+      auto t = static_cast<float>((playbackTick - previous.tick) / static_cast<double>(next->tick - previous.tick));
+      sampled.push_back({id, glm::mix(previous.position, next->position, t), glm::mix(previous.yaw, next->yaw, t)});
+    }
+  }
+}
+
+double RemotePlayers::getPlaybackTick() const {
+  return playbackTick;
+}
+
+uint64_t RemotePlayers::getStarvedSamples() const {
+  return starvedSamples;
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Movement runs in fixed steps on both sides, so a client replaying its inputs lands exactly where the
+// server does
+constexpr int MOVEMENT_TICK_RATE = 60;
+constexpr float MOVEMENT_TICK_SECONDS = 1.0f / MOVEMENT_TICK_RATE;
+constexpr float PLAYER_SPEED = 5.0f;
+constexpr float PLAYER_SPRINT_MULTIPLIER = 2.0f;
+
+// Blocks per second squared and per second; a jump clears a little over one block
+constexpr float GRAVITY = 28.0f;
+constexpr float TERMINAL_VELOCITY = 60.0f;
+constexpr float JUMP_SPEED = 8.5f;
+
+// The player's box around its eye position, which is where the camera sits
+constexpr float PLAYER_HALF_WIDTH = 0.3f;
+constexpr float PLAYER_EYE_HEIGHT = 1.62f;
+constexpr float PLAYER_HEIGHT = 1.8f;
+
+// Inputs the server applies per player and tick: its own share plus as much again to catch up after a
+// burst, but never enough to let a client move faster by sending more
+constexpr size_t MAX_INPUTS_PER_SERVER_TICK = 6;
+
+// Predicted steps kept for replay; older ones are dropped when the server falls this far behind
+constexpr size_t PREDICTION_HISTORY_SIZE = 256;
+
+// Remote players are drawn this far behind the newest snapshot, so there is nearly always a later one to
+// interpolate towards
+constexpr double INTERPOLATION_DELAY_TICKS = 2.0;
+constexpr size_t MAX_SNAPSHOTS_PER_PLAYER = 32;
+
+enum InputButton : uint8_t {
+  INPUT_FORWARD = 1 << 0,
+  INPUT_BACK = 1 << 1,
+  INPUT_LEFT = 1 << 2,
+  INPUT_RIGHT = 1 << 3,
+  INPUT_SPRINT = 1 << 4,
+  // Rises when flying
+  INPUT_JUMP = 1 << 5,
+  // Moves along the view direction without gravity, still colliding
+  INPUT_FLY = 1 << 6
+};
+
+// One movement step's worth of input; sequence numbers start at 1 and increase by one per step
+struct PlayerInput {
+  uint32_t sequence;
+  uint8_t buttons;
+  float yaw;
+  float pitch;
+};
+
+struct PlayerState {
+  // Eye position
+  glm::vec3 position;
+  glm::vec3 velocity;
+  bool onGround;
+};
+
+// Whether a block stops movement. The server and the client each answer from their own copy of the world,
+// and both treat terrain they do not have yet as solid, so nobody falls through the world before it loads.
+using SolidBlockQuery = std::function<bool(glm::ivec3 block)>;
+
+struct PlayerBox {
+  glm::vec3 min;
+  glm::vec3 max;
+};
+
+[[nodiscard]] PlayerBox getPlayerBox(glm::vec3 position);
+
+// Whether placing the block would put it inside the player
+[[nodiscard]] bool overlapsPlayer(glm::vec3 position, glm::ivec3 block);
+
+// Moves the box by delta one axis at a time, Y first, stopping each axis at the first solid block in its
+// path. Only the blocks the box sweeps through are queried, a handful per axis at walking speeds. Returns
+// the distance actually moved, with any blocked axis shorter than asked for.
+glm::vec3 sweepPlayerBox(PlayerBox &box, glm::vec3 delta, const SolidBlockQuery &isSolid);
+
+// Advances a player by one MOVEMENT_TICK_SECONDS step: walking on the ground under gravity, or flying
+// along the view direction with INPUT_FLY
+PlayerState simulateMovement(const PlayerState &state, const PlayerInput &input, const SolidBlockQuery &isSolid);
+
+// Server side: inputs waiting for a player's next tick. Clients send each input several times to ride out
+// lost datagrams, so duplicates and inputs that were already applied are ignored.
+class InputQueue {
+public:
+  void push(const PlayerInput &input);
+
+  // Applies at most maxInputs queued inputs in sequence order and returns how many were applied
+  size_t apply(PlayerState &state, size_t maxInputs, const SolidBlockQuery &isSolid);
+
+  // Sequence of the last applied input; 0 before the first
+  [[nodiscard]] uint32_t getLastApplied() const;
+
+  [[nodiscard]] size_t getPendingCount() const;
+
+private:
+  std::deque<PlayerInput> pending;
+  uint32_t lastApplied = 0;
+};
+
+struct PredictionStats {
+  uint64_t predicted;
+  uint64_t reconciled;
+  // Reconciliations where the server disagreed with what was predicted for the same input
+  uint64_t corrections;
+  float lastCorrection;
+  float maxCorrection;
+};
+
+// Client side: applies every input locally the moment it is made, remembering each one with the state it
+// produced. When the server's authoritative state for an input arrives, everything up to it is dropped and
+// the inputs the server has not seen yet are replayed on top of its state.
+class MovementPredictor {
+public:
+  // Replays use the world as it is when they happen, which is what the server will have seen too unless
+  // blocks changed in between
+  MovementPredictor(SolidBlockQuery isSolid, const PlayerState &initial);
+
+  // Returns the input with its sequence number filled in
+  PlayerInput predict(uint8_t buttons, float yaw, float pitch);
+
+  void reconcile(uint32_t lastApplied, const PlayerState &authoritative);
+
+  [[nodiscard]] const PlayerState &getState() const;
+
+  // The newest inputs, oldest first, at most count of them; what goes into each input datagram
+  void getRecentInputs(size_t count, std::vector<PlayerInput> &inputs) const;
+
+  [[nodiscard]] const PredictionStats &getStats() const;
+
+private:
+  struct PredictedStep {
+    PlayerInput input;
+    PlayerState state;
+  };
+
+  SolidBlockQuery isSolid;
+  PlayerState state;
+  // The server's state as of the last reconcile
+  PlayerState acknowledged;
+  std::deque<PredictedStep> history;
+  uint32_t nextSequence = 1;
+  uint32_t lastReconciled = 0;
+  PredictionStats stats{};
+};
+
+struct RemotePlayer {
+  uint32_t id;
+  glm::vec3 position;
+  float yaw;
+};
+
+// Plays back the other players from the server's per-tick snapshots on a clock held
+// INTERPOLATION_DELAY_TICKS behind the newest one, blending between the two snapshots around it. A snapshot
+// need not hold everyone in view: players the server had no room for keep their earlier snapshots.
+class RemotePlayers {
+public:
+  // Removed players have left view and are dropped
+  void addSnapshot(uint32_t tick, const std::vector<RemotePlayer> &players, const std::vector<uint32_t> &removed);
+
+  void advance(double seconds, int tickRate);
+
+  void sample(std::vector<RemotePlayer> &players) const;
+
+  [[nodiscard]] double getPlaybackTick() const;
+
+  // Samples that found no later snapshot and had to hold the newest one
+  [[nodiscard]] uint64_t getStarvedSamples() const;
+
+private:
+  struct Snapshot {
+    uint32_t tick;
+    glm::vec3 position;
+    float yaw;
+  };
+
+  std::unordered_map<uint32_t, std::deque<Snapshot>> players;
+  uint32_t newestTick = 0;
+  double playbackTick = 0.0;
+  bool started = false;
+  mutable uint64_t starvedSamples = 0;
+};
@@ -0,0 +1,178 @@
+#include "Poller.hpp"
+
+#ifdef __linux__
+
+#include <cerrno>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#elif !defined(_WIN32)
+
+#include <poll.h>
+
+#endif
+
+namespace {
+  constexpr size_t MAX_EVENTS_PER_WAIT = 1024;
+}
+
+#ifdef __linux__
+
+namespace {
+  uint32_t epollEvents(uint8_t interest) {
+    uint32_t events = 0;
+    if (interest & POLL_READABLE) {
+      events |= EPOLLIN;
+    }
+    if (interest & POLL_WRITABLE) {
+      events |= EPOLLOUT;
+    }
+    return events;
+  }
+}
+
+Poller::Poller() : epoll(epoll_create1(EPOLL_CLOEXEC)), buffer(MAX_EVENTS_PER_WAIT * sizeof(epoll_event)) {
+}
+
+Poller::~Poller() {
+  if (epoll >= 0) {
+    close(epoll);
+  }
+}
+
+bool Poller::add(const Socket &socket, uint64_t id, uint8_t interest) {
+  epoll_event event{};
+  event.events = epollEvents(interest);
+  event.data.u64 = id;
+  if (epoll_ctl(epoll, EPOLL_CTL_ADD, socket.getHandle(), &event) != 0) {
+    return false;
+  }
+
+  ++count;
+  return true;
+}
+
+bool Poller::modify(const Socket &socket, uint64_t id, uint8_t interest) {
+  epoll_event event{};
+  event.events = epollEvents(interest);
+  event.data.u64 = id;
+  return epoll_ctl(epoll, EPOLL_CTL_MOD, socket.getHandle(), &event) == 0;
+}
+
+void Poller::remove(const Socket &socket) {
+  if (epoll_ctl(epoll, EPOLL_CTL_DEL, socket.getHandle(), nullptr) == 0) {
+    --count;
+  }
+}
+
+size_t Poller::wait(int timeoutMs, std::vector<PollEvent> &events) {
+  events.clear();
+
+  auto *ready = reinterpret_cast<epoll_event *>(buffer.data());
+  auto readyCount = epoll_wait(epoll, ready, MAX_EVENTS_PER_WAIT, timeoutMs);
+  for (auto i = 0; i < readyCount; ++i) {
+    events.push_back({ready[i].data.u64, (ready[i].events & EPOLLIN) != 0, (ready[i].events & EPOLLOUT) != 0,
+                      (ready[i].events & (EPOLLERR | EPOLLHUP)) != 0});
+  }
+  return events.size();
+}
+
+#else
+
+namespace {
+#ifdef _WIN32
+  using PollDescriptor = WSAPOLLFD;
+
+  int pollDescriptors(PollDescriptor *descriptors, size_t count, int timeoutMs) {
+    return WSAPoll(descriptors, static_cast<ULONG>(count), timeoutMs);
+  }
+#else
+  using PollDescriptor = pollfd;
+
+  int pollDescriptors(PollDescriptor *descriptors, size_t count, int timeoutMs) {
+    return poll(descriptors, static_cast<nfds_t>(count), timeoutMs);
+  }
+#endif
+
+  short pollEvents(uint8_t interest) {
+    short events = 0;
+    if (interest & POLL_READABLE) {
+      events |= POLLIN;
+    }
+    if (interest & POLL_WRITABLE) {
+      events |= POLLOUT;
+    }
+    return events;
+  }
+}
+
+Poller::Poller() = default;
+
+Poller::~Poller() = default;
+
+bool Poller::add(const Socket &socket, uint64_t id, uint8_t interest) {
+  if (indices.contains(socket.getHandle())) {
+    return false;
+  }
+
+  indices.emplace(socket.getHandle(), registrations.size());
+  registrations.push_back({socket.getHandle(), id, interest});
+  ++count;
+  return true;
+}
+
+bool Poller::modify(const Socket &socket, uint64_t id, uint8_t interest) {
+  auto it = indices.find(socket.getHandle());
+  if (it == indices.end()) {
+    return false;
+  }
+
+  registrations[it->second] = {socket.getHandle(), id, interest};
+  return true;
+}
+
+void Poller::remove(const Socket &socket) {
+  auto it = indices.find(socket.getHandle());
+  if (it == indices.end()) {
+    return;
+  }
+
+  // Swap-remove so registrations stays dense
+  auto index = it->second;
+  indices.erase(it);
+  if (index != registrations.size() - 1) {
+    registrations[index] = registrations.back();
+    indices[registrations[index].handle] = index;
+  }
+  registrations.pop_back();
+  --count;
+}
+
+size_t Poller::wait(int timeoutMs, std::vector<PollEvent> &events) {
+  events.clear();
+
+  std::vector<PollDescriptor> descriptors(registrations.size());
+  for (size_t i = 0; i < registrations.size(); ++i) {
+    descriptors[i].fd = registrations[i].handle;
+    descriptors[i].events = pollEvents(registrations[i].interest);
+  }
+
+  if (pollDescriptors(descriptors.data(), descriptors.size(), timeoutMs) <= 0) {
+    return 0;
+  }
+
+  for (size_t i = 0; i < descriptors.size() && events.size() < MAX_EVENTS_PER_WAIT; ++i) {
+    auto revents = descriptors[i].revents;
+    if (revents != 0) {
+      events.push_back({registrations[i].id, (revents & POLLIN) != 0, (revents & POLLOUT) != 0,
+                        (revents & (POLLERR | POLLHUP | POLLNVAL)) != 0});
+    }
+  }
+  return events.size();
+}
+
+#endif
+
+size_t Poller::getCount() const {
+  return count;
+}
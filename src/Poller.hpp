@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Socket.hpp"
+
+#ifndef __linux__
+
+#include <unordered_map>
+
+#endif
+
+constexpr uint8_t POLL_READABLE = 1;
+constexpr uint8_t POLL_WRITABLE = 2;
+
+struct PollEvent {
+  uint64_t id;
+  bool readable;
+  bool writable;
+  // Hang-up or socket error; the owner should read once more to drain, then close
+  bool failed;
+};
+
+// Readiness notification for many non-blocking sockets. Uses level-triggered epoll on Linux, so the cost
+// of a wait scales with the number of ready sockets rather than registered ones, and falls back to
+// poll()/WSAPoll() elsewhere.
+class Poller {
+public:
+  Poller();
+
+  ~Poller();
+
+  Poller(const Poller &) = delete;
+
+  Poller &operator=(const Poller &) = delete;
+
+  bool add(const Socket &socket, uint64_t id, uint8_t interest);
+
+  bool modify(const Socket &socket, uint64_t id, uint8_t interest);
+
+  void remove(const Socket &socket);
+
+  // Waits at most timeoutMs (0 polls, -1 blocks) and replaces events with whatever became ready
+  size_t wait(int timeoutMs, std::vector<PollEvent> &events);
+
+  [[nodiscard]] size_t getCount() const;
+
+private:
+  size_t count = 0;
+
+#ifdef __linux__
+  int epoll = -1;
+  std::vector<uint8_t> buffer;
+#else
+  struct Registration {
+    SocketHandle handle;
+    uint64_t id;
+    uint8_t interest;
+  };
+
+  std::vector<Registration> registrations;
+  std::unordered_map<SocketHandle, size_t> indices;
+#endif
+};
@@ -0,0 +1,228 @@
+#include "Profiler.hpp"
+
+#ifdef NETBLOCKS_PROFILER
+
+#include <algorithm>
+#include <fstream>
+
+namespace {
+  thread_local uint32_t zoneDepth = 0;
+
+  void writeJsonString(std::ofstream &file, std::string_view text) {
+    file << '"';
+    for (auto c: text) {
+      if (c == '"' || c == '\\') {
+        file << '\\';
+      }
+      file << c;
+    }
+    file << '"';
+  }
+}
+
+Profiler &Profiler::get() {
+  static Profiler profiler;
+  return profiler;
+}
+
+Profiler::Profiler() : epoch(std::chrono::steady_clock::now()) {
+}
+
+uint64_t Profiler::now() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::record(const char *name, uint64_t start, uint64_t end, uint32_t depth) {
+  auto &ring = getThreadRing();
+  auto head = ring.head.load(std::memory_order_relaxed);
+  if (head - ring.tail.load(std::memory_order_acquire) >= PROFILER_RING_SIZE) {
+    droppedEvents.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  ring.events[head & (PROFILER_RING_SIZE - 1)] = {name, start, end, depth};
+  ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(std::string name) {
+  auto &ring = getThreadRing();
+  std::lock_guard lock(ringsMutex);
+  ring.name = std::move(name);
+}
+
+void Profiler::addGpuTime(const char *name, uint64_t nanoseconds) {
+  auto zone = getZoneIndex(name);
+  if (zone < PROFILER_MAX_ZONES) {
+    frameGpu[zone] += nanoseconds;
+  }
+
+  if (capturing && captured.size() < PROFILER_MAX_CAPTURE_EVENTS) {
+    // Placed at the start of the frame that read it back, on a track of its own
+    captured.push_back({{name, frameStart, frameStart + nanoseconds, 0}, UINT32_MAX});
+  }
+}
+
+void Profiler::endFrame() {
+  auto frameEnd = now();
+  if (mainRing == nullptr) {
+    mainRing = &getThreadRing();
+  }
+
+  FrameRecord frame;
+  frame.start = frameStart;
+  frame.duration = frameEnd - frameStart;
+  frame.gpu = frameGpu;
+  frameGpu = {};
+
+  std::vector<ThreadRing *> snapshot;
+  {
+    std::lock_guard lock(ringsMutex);
+    for (const auto &ring: rings) {
+      snapshot.push_back(ring.get());
+    }
+  }
+
+  for (auto *ring: snapshot) {
+    auto isMain = ring == mainRing;
+    auto tail = ring->tail.load(std::memory_order_relaxed);
+    auto head = ring->head.load(std::memory_order_acquire);
+
+    for (; tail != head; ++tail) {
+      const auto &event = ring->events[tail & (PROFILER_RING_SIZE - 1)];
+      auto duration = event.end - event.start;
+      auto zone = getZoneIndex(event.name);
+
+      if (isMain) {
+        // Zones end before the zone around them, so a zone's children are all in by the time it arrives
+        if (childTime.size() < event.depth + 2) {
+          childTime.resize(event.depth + 2);
+        }
+        auto self = duration - std::min(childTime[event.depth + 1], duration);
+        childTime[event.depth + 1] = 0;
+        childTime[event.depth] += duration;
+        if (zone < PROFILER_MAX_ZONES) {
+          frame.mainThread[zone] += self;
+        }
+      } else if (zone < PROFILER_MAX_ZONES) {
+        frame.workers[zone] += duration;
+      }
+
+      if (capturing && captured.size() < PROFILER_MAX_CAPTURE_EVENTS) {
+        captured.push_back({event, ring->index});
+      }
+    }
+
+    ring->tail.store(tail, std::memory_order_release);
+  }
+  std::fill(childTime.begin(), childTime.end(), 0);
+
+  history.push_back(frame);
+  if (history.size() > PROFILER_HISTORY_FRAMES) {
+    history.pop_front();
+  }
+  frameStart = frameEnd;
+}
+
+void Profiler::startCapture() {
+  captured.clear();
+  capturing = true;
+}
+
+bool Profiler::stopCapture(const std::filesystem::path &path) {
+  capturing = false;
+
+  std::ofstream file(path);
+  if (!file) {
+    return false;
+  }
+
+  // Trace timestamps are microseconds
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << UINT32_MAX
+       << ",\"args\":{\"name\":\"GPU\"}}";
+  {
+    std::lock_guard lock(ringsMutex);
+    for (const auto &ring: rings) {
+      auto name = ring.get() == mainRing ? std::string("main") : ring->name;
+      if (name.empty()) {
+        name = "thread " + std::to_string(ring->index);
+      }
+      file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->index
+           << ",\"args\":{\"name\":";
+      writeJsonString(file, name);
+      file << "}}";
+    }
+  }
+
+  file.setf(std::ios::fixed);
+  file.precision(3);
+  for (const auto &[event, thread]: captured) {
+    file << ",\n{\"name\":";
+    writeJsonString(file, event.name);
+    file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread << ",\"ts\":" << event.start / 1000.0 << ",\"dur\":"
+         << (event.end - event.start) / 1000.0 << "}";
+  }
+  file << "\n]}\n";
+
+  captured.clear();
+  captured.shrink_to_fit();
+  return static_cast<bool>(file);
+}
+
+bool Profiler::isCapturing() const {
+  return capturing;
+}
+
+const std::deque<FrameRecord> &Profiler::getHistory() const {
+  return history;
+}
+
+size_t Profiler::getZoneCount() const {
+  return zoneNames.size();
+}
+
+const std::string &Profiler::getZoneName(size_t zone) const {
+  return zoneNames[zone];
+}
+
+uint64_t Profiler::getDroppedEvents() const {
+  return droppedEvents.load(std::memory_order_relaxed);
+}
+
+Profiler::ThreadRing &Profiler::getThreadRing() {
+  thread_local ThreadRing *ring = nullptr;
+  if (ring == nullptr) {
+    auto created = std::make_unique<ThreadRing>();
+    ring = created.get();
+
+    std::lock_guard lock(ringsMutex);
+    created->index = static_cast<uint32_t>(rings.size());
+    rings.push_back(std::move(created));
+  }
+  return *ring;
+}
+
+size_t Profiler::getZoneIndex(const char *name) {
+  if (auto found = zoneIndices.find(name); found != zoneIndices.end()) {
+    return found->second;
+  }
+  if (zoneNames.size() >= PROFILER_MAX_ZONES) {
+    return PROFILER_MAX_ZONES;
+  }
+
+  // The names are string literals, so the view stays valid
+  zoneIndices.emplace(name, zoneNames.size());
+  zoneNames.emplace_back(name);
+  return zoneNames.size() - 1;
+}
+
+ProfileZone::ProfileZone(const char *name) : name(name), start(Profiler::get().now()), depth(zoneDepth++) {
+}
+
+ProfileZone::~ProfileZone() {
+  --zoneDepth;
+  auto &profiler = Profiler::get();
+  profiler.record(name, start, profiler.now(), depth);
+}
+
+#endif
@@ -0,0 +1,156 @@
+#pragma once
+
+// Scoped CPU zones, GPU pass timings and Chrome trace capture. Everything here only exists when the build
+// defines NETBLOCKS_PROFILER; otherwise the macros below expand to nothing.
+
+#ifdef NETBLOCKS_PROFILER
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Events each thread can have waiting before endFrame() drains them; further events are dropped
+constexpr size_t PROFILER_RING_SIZE = 8192;
+constexpr size_t PROFILER_HISTORY_FRAMES = 240;
+// Distinct zone names tracked per frame; later names still reach captures but not the history
+constexpr size_t PROFILER_MAX_ZONES = 32;
+constexpr size_t PROFILER_MAX_CAPTURE_EVENTS = 4 * 1024 * 1024;
+
+static_assert((PROFILER_RING_SIZE & (PROFILER_RING_SIZE - 1)) == 0, "ring indices wrap with a mask");
+
+struct ProfileEvent {
+  // Zone names are string literals, so events only carry the pointer
+  const char *name;
+  uint64_t start;
+  uint64_t end;
+  uint32_t depth;
+};
+
+// Nanoseconds per zone for one frame, indexed like Profiler::getZoneName()
+struct FrameRecord {
+  uint64_t start = 0;
+  uint64_t duration = 0;
+  // Main thread time not spent in a nested zone, so the entries add up to the instrumented part of the frame
+  std::array<uint64_t, PROFILER_MAX_ZONES> mainThread{};
+  // Summed over every other thread
+  std::array<uint64_t, PROFILER_MAX_ZONES> workers{};
+  std::array<uint64_t, PROFILER_MAX_ZONES> gpu{};
+};
+
+// Each thread records into its own single-producer ring, so zones never take a lock; the main thread
+// drains every ring once per frame in endFrame().
+class Profiler {
+public:
+  static Profiler &get();
+
+  // Nanoseconds since the profiler was created
+  [[nodiscard]] uint64_t now() const;
+
+  void record(const char *name, uint64_t start, uint64_t end, uint32_t depth);
+
+  // Names the calling thread in captures
+  void setThreadName(std::string name);
+
+  // GPU time for a pass of the frame in progress; GPU timings arrive a few frames late, so they are
+  // attributed to the frame that reads them back
+  void addGpuTime(const char *name, uint64_t nanoseconds);
+
+  // Closes the frame on the main thread; the first thread to call it is taken to be the main thread
+  void endFrame();
+
+  void startCapture();
+
+  // Writes everything recorded since startCapture() as Chrome trace event JSON, readable by
+  // chrome://tracing and Perfetto
+  bool stopCapture(const std::filesystem::path &path);
+
+  [[nodiscard]] bool isCapturing() const;
+
+  [[nodiscard]] const std::deque<FrameRecord> &getHistory() const;
+
+  [[nodiscard]] size_t getZoneCount() const;
+
+  [[nodiscard]] const std::string &getZoneName(size_t zone) const;
+
+  [[nodiscard]] uint64_t getDroppedEvents() const;
+
+private:
+  struct ThreadRing {
+    std::array<ProfileEvent, PROFILER_RING_SIZE> events;
+    std::atomic<uint64_t> head = 0;
+    std::atomic<uint64_t> tail = 0;
+    uint32_t index;
+    std::string name;
+  };
+
+  struct CapturedEvent {
+    ProfileEvent event;
+    uint32_t thread;
+  };
+
+  std::chrono::steady_clock::time_point epoch;
+
+  // Rings are only added, under ringsMutex; each lives until exit since its thread may still hold it
+  mutable std::mutex ringsMutex;
+  std::vector<std::unique_ptr<ThreadRing>> rings;
+  std::atomic<uint64_t> droppedEvents = 0;
+
+  // Everything below is only touched by the main thread
+  ThreadRing *mainRing = nullptr;
+  uint64_t frameStart = 0;
+  std::array<uint64_t, PROFILER_MAX_ZONES> frameGpu{};
+  std::deque<FrameRecord> history;
+  std::vector<std::string> zoneNames;
+  std::unordered_map<std::string_view, size_t> zoneIndices;
+  std::vector<uint64_t> childTime;
+
+  bool capturing = false;
+  std::vector<CapturedEvent> captured;
+
+  Profiler();
+
+  ThreadRing &getThreadRing();
+
+  // Returns PROFILER_MAX_ZONES once the table is full
+  size_t getZoneIndex(const char *name);
+};
+
+// Times its own lifetime as a zone on the calling thread
+class ProfileZone {
+public:
+  explicit ProfileZone(const char *name);
+
+  ~ProfileZone();
+
+  ProfileZone(const ProfileZone &) = delete;
+
+  ProfileZone &operator=(const ProfileZone &) = delete;
+
+private:
+  const char *name;
+  uint64_t start;
+  uint32_t depth;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_THREAD_NAME(name) Profiler::get().setThreadName(name)
+#define PROFILE_END_FRAME() Profiler::get().endFrame()
+
+#else
+
+#define PROFILE_ZONE(name)
+#define PROFILE_THREAD_NAME(name)
+#define PROFILE_END_FRAME()
+
+#endif
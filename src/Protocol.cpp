@@ -0,0 +1,277 @@
+#include "Protocol.hpp"
+
+namespace {
+  void writeVec3(ByteWriter &writer, glm::vec3 value) {
+    writer.writeF32(value.x);
+    writer.writeF32(value.y);
+    writer.writeF32(value.z);
+  }
+
+  glm::vec3 readVec3(ByteReader &reader) {
+    auto x = reader.readF32();
+    auto y = reader.readF32();
+    auto z = reader.readF32();
+    return {x, y, z};
+  }
+
+  void writeChunkPos(ByteWriter &writer, ChunkPos position) {
+    writer.writeI32(position.x);
+    writer.writeI32(position.y);
+    writer.writeI32(position.z);
+  }
+
+  ChunkPos readChunkPos(ByteReader &reader) {
+    auto x = reader.readI32();
+    auto y = reader.readI32();
+    auto z = reader.readI32();
+    return {x, y, z};
+  }
+
+  void writeColumnPos(ByteWriter &writer, ColumnPos position) {
+    writer.writeI32(position.x);
+    writer.writeI32(position.y);
+  }
+
+  ColumnPos readColumnPos(ByteReader &reader) {
+    auto x = reader.readI32();
+    auto z = reader.readI32();
+    return {x, z};
+  }
+}
+
+size_t beginMessage(std::vector<uint8_t> &out, MessageType type) {
+  auto start = out.size();
+  ByteWriter writer(out);
+  writer.writeU32(0);
+  writer.writeU8(static_cast<uint8_t>(type));
+  return start;
+}
+
+void endMessage(std::vector<uint8_t> &out, size_t start) {
+  auto length = static_cast<uint32_t>(out.size() - start - sizeof(uint32_t));
+  for (auto i = 0; i < 4; ++i) {
+    out[start + i] = static_cast<uint8_t>(length >> (i * 8));
+  }
+}
+
+void writeHello(std::vector<uint8_t> &out, const HelloMessage &message) {
+  auto start = beginMessage(out, MessageType::Hello);
+  ByteWriter writer(out);
+  writer.writeU16(message.version);
+  writer.writeU8(message.viewRadius);
+  writeVec3(writer, message.position);
+  endMessage(out, start);
+}
+
+void writeWelcome(std::vector<uint8_t> &out, const WelcomeMessage &message) {
+  auto start = beginMessage(out, MessageType::Welcome);
+  ByteWriter writer(out);
+  writer.writeU32(message.clientId);
+  writer.writeU32(message.token);
+  writer.writeU32(message.seed);
+  writer.writeU16(message.tickRate);
+  writer.writeU16(message.udpPort);
+  writer.writeU8(message.viewRadius);
+  endMessage(out, start);
+}
+
+void writeServerTick(std::vector<uint8_t> &out, const ServerTickMessage &message) {
+  auto start = beginMessage(out, MessageType::ServerTick);
+  ByteWriter writer(out);
+  writer.writeU32(message.tick);
+  endMessage(out, start);
+}
+
+void writeColumnData(std::vector<uint8_t> &out, const ColumnDataMessage &message) {
+  auto start = beginMessage(out, MessageType::ColumnData);
+  ByteWriter writer(out);
+  writeColumnPos(writer, message.position);
+  writer.writeU8(message.firstSurfaceChunk);
+  endMessage(out, start);
+}
+
+void writeChunkData(std::vector<uint8_t> &out, ChunkPos position, uint32_t version, const BlockStorage &blocks) {
+  auto start = beginMessage(out, MessageType::ChunkData);
+  ByteWriter writer(out);
+  writeChunkPos(writer, position);
+  writer.writeU32(version);
+  encodeBlocks(writer, blocks);
+  endMessage(out, start);
+}
+
+void writeColumnUnload(std::vector<uint8_t> &out, ColumnPos position) {
+  auto start = beginMessage(out, MessageType::ColumnUnload);
+  ByteWriter writer(out);
+  writeColumnPos(writer, position);
+  endMessage(out, start);
+}
+
+void writeBlockChanges(std::vector<uint8_t> &out, const BlockChangesMessage &message) {
+  auto start = beginMessage(out, MessageType::BlockChanges);
+  ByteWriter writer(out);
+  writeChunkPos(writer, message.position);
+  writer.writeU32(message.baseVersion);
+  writer.writeU32(message.version);
+  encodeBlockChanges(writer, message.changes);
+  endMessage(out, start);
+}
+
+void writeSetBlock(std::vector<uint8_t> &out, const SetBlockMessage &message) {
+  auto start = beginMessage(out, MessageType::SetBlock);
+  ByteWriter writer(out);
+  writer.writeI32(message.position.x);
+  writer.writeI32(message.position.y);
+  writer.writeI32(message.position.z);
+  writer.writeU16(message.block);
+  endMessage(out, start);
+}
+
+void writeChunkResync(std::vector<uint8_t> &out, ChunkPos position) {
+  auto start = beginMessage(out, MessageType::ChunkResync);
+  ByteWriter writer(out);
+  writeChunkPos(writer, position);
+  endMessage(out, start);
+}
+
+void writePlayerInput(std::vector<uint8_t> &out, const PlayerInputMessage &message) {
+  ByteWriter writer(out);
+  writer.writeU8(static_cast<uint8_t>(MessageType::PlayerInput));
+  writer.writeU32(message.token);
+  writer.writeU8(static_cast<uint8_t>(message.inputs.size()));
+  for (const auto &input: message.inputs) {
+    writer.writeU32(input.sequence);
+    writer.writeU8(input.buttons);
+    writer.writeF32(input.yaw);
+    writer.writeF32(input.pitch);
+  }
+}
+
+void writePlayerStates(std::vector<uint8_t> &out, const PlayerStatesMessage &message) {
+  auto start = beginMessage(out, MessageType::PlayerStates);
+  ByteWriter writer(out);
+  writer.writeU32(message.tick);
+  writer.writeU32(message.lastInput);
+  writeVec3(writer, message.state.position);
+  writeVec3(writer, message.state.velocity);
+  writer.writeU8(message.state.onGround ? 1 : 0);
+  writer.writeVarU32(static_cast<uint32_t>(message.players.size()));
+  for (const auto &player: message.players) {
+    writer.writeU32(player.id);
+    writeVec3(writer, player.position);
+    writer.writeF32(player.yaw);
+  }
+  writer.writeVarU32(static_cast<uint32_t>(message.removed.size()));
+  for (auto id: message.removed) {
+    writer.writeU32(id);
+  }
+  endMessage(out, start);
+}
+
+bool readHello(ByteReader &reader, HelloMessage &message) {
+  message.version = reader.readU16();
+  message.viewRadius = reader.readU8();
+  message.position = readVec3(reader);
+  return reader.isValid();
+}
+
+bool readWelcome(ByteReader &reader, WelcomeMessage &message) {
+  message.clientId = reader.readU32();
+  message.token = reader.readU32();
+  message.seed = reader.readU32();
+  message.tickRate = reader.readU16();
+  message.udpPort = reader.readU16();
+  message.viewRadius = reader.readU8();
+  return reader.isValid();
+}
+
+bool readServerTick(ByteReader &reader, ServerTickMessage &message) {
+  message.tick = reader.readU32();
+  return reader.isValid();
+}
+
+bool readColumnData(ByteReader &reader, ColumnDataMessage &message) {
+  message.position = readColumnPos(reader);
+  message.firstSurfaceChunk = reader.readU8();
+  return reader.isValid();
+}
+
+bool readChunkData(ByteReader &reader, ChunkPos &position, uint32_t &version, BlockStorage &blocks) {
+  position = readChunkPos(reader);
+  version = reader.readU32();
+  return reader.isValid() && decodeBlocks(reader, blocks);
+}
+
+bool readColumnUnload(ByteReader &reader, ColumnPos &position) {
+  position = readColumnPos(reader);
+  return reader.isValid();
+}
+
+bool readBlockChanges(ByteReader &reader, BlockChangesMessage &message) {
+  message.position = readChunkPos(reader);
+  message.baseVersion = reader.readU32();
+  message.version = reader.readU32();
+  return reader.isValid() && decodeBlockChanges(reader, message.changes);
+}
+
+bool readSetBlock(ByteReader &reader, SetBlockMessage &message) {
+  message.position.x = reader.readI32();
+  message.position.y = reader.readI32();
+  message.position.z = reader.readI32();
+  message.block = reader.readU16();
+  return reader.isValid();
+}
+
+bool readChunkResync(ByteReader &reader, ChunkPos &position) {
+  position = readChunkPos(reader);
+  return reader.isValid();
+}
+
+bool readPlayerInput(ByteReader &reader, PlayerInputMessage &message) {
+  message.token = reader.readU32();
+  auto count = reader.readU8();
+  if (count > INPUTS_PER_DATAGRAM) {
+    return false;
+  }
+
+  message.inputs.resize(count);
+  for (auto &input: message.inputs) {
+    input.sequence = reader.readU32();
+    input.buttons = reader.readU8();
+    input.yaw = reader.readF32();
+    input.pitch = reader.readF32();
+  }
+  return reader.isValid();
+}
+
+bool readPlayerStates(ByteReader &reader, PlayerStatesMessage &message) {
+  constexpr size_t PLAYER_SIZE = 4 + 3 * 4 + 4;
+
+  message.tick = reader.readU32();
+  message.lastInput = reader.readU32();
+  message.state.position = readVec3(reader);
+  message.state.velocity = readVec3(reader);
+  message.state.onGround = reader.readU8() != 0;
+  auto count = reader.readVarU32();
+  // A corrupt count must not reserve more than the message could hold
+  if (!reader.isValid() || count > reader.remaining() / PLAYER_SIZE) {
+    return false;
+  }
+
+  message.players.resize(count);
+  for (auto &player: message.players) {
+    player.id = reader.readU32();
+    player.position = readVec3(reader);
+    player.yaw = reader.readF32();
+  }
+
+  auto removed = reader.readVarU32();
+  if (!reader.isValid() || removed > reader.remaining() / sizeof(uint32_t)) {
+    return false;
+  }
+
+  message.removed.resize(removed);
+  for (auto &id: message.removed) {
+    id = reader.readU32();
+  }
+  return reader.isValid();
+}
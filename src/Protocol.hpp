@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "BlockStorage.hpp"
+#include "ByteBuffer.hpp"
+#include "ChunkCodec.hpp"
+#include "ChunkPos.hpp"
+#include "PlayerMovement.hpp"
+
+constexpr uint16_t PROTOCOL_VERSION = 6;
+constexpr uint16_t DEFAULT_SERVER_PORT = 25565;
+constexpr int SERVER_TICK_RATE = 20;
+
+// TCP messages are framed as a u32 length of everything that follows, a u8 MessageType and the payload.
+// UDP datagrams carry the type byte and payload only.
+constexpr size_t MESSAGE_HEADER_SIZE = 5;
+constexpr size_t MAX_MESSAGE_SIZE = 256 * 1024;
+constexpr size_t MAX_DATAGRAM_SIZE = 1200;
+
+// Every input datagram repeats the newest inputs, so a lost datagram only costs anything when this many
+// in a row are lost
+constexpr size_t INPUTS_PER_DATAGRAM = 8;
+
+enum class MessageType : uint8_t {
+  // Client to server, TCP
+  Hello = 1,
+  // Server to client, TCP
+  Welcome,
+  // Sent before any chunk of its column; chunks of the column that never arrive are air or buried
+  ColumnData,
+  ChunkData,
+  ColumnUnload,
+  ServerTick,
+  // Client to server, UDP
+  PlayerInput,
+  // Server to client, TCP
+  BlockChanges,
+  // Client to server, TCP
+  SetBlock,
+  ChunkResync,
+  // Server to client, TCP
+  PlayerStates
+};
+
+struct HelloMessage {
+  uint16_t version;
+  uint8_t viewRadius;
+  glm::vec3 position;
+};
+
+struct WelcomeMessage {
+  uint32_t clientId;
+  // Proves ownership of the session in UDP datagrams, which have no connection to tie them to
+  uint32_t token;
+  uint32_t seed;
+  uint16_t tickRate;
+  uint16_t udpPort;
+  uint8_t viewRadius;
+};
+
+struct ColumnDataMessage {
+  ColumnPos position;
+  // Missing chunks below this one are solid and enclosed, the ones above it are air
+  uint8_t firstSurfaceChunk;
+};
+
+struct ServerTickMessage {
+  uint32_t tick;
+};
+
+// Every block change a chunk went through in one tick. A client only applies it on top of baseVersion;
+// any other version means it missed something and has to ask for a ChunkResync.
+struct BlockChangesMessage {
+  ChunkPos position;
+  uint32_t baseVersion;
+  uint32_t version;
+  std::vector<BlockChange> changes;
+};
+
+struct SetBlockMessage {
+  glm::ivec3 position;
+  BlockId block;
+};
+
+struct PlayerInputMessage {
+  uint32_t token;
+  // Oldest first; the server skips the ones it already has
+  std::vector<PlayerInput> inputs;
+};
+
+// Sent every tick: the client's state on the server after applying its input lastInput, the other players
+// in view whose turn it is to be updated, and the ones that have left view since the last message
+struct PlayerStatesMessage {
+  uint32_t tick;
+  uint32_t lastInput;
+  PlayerState state;
+  std::vector<RemotePlayer> players;
+  std::vector<uint32_t> removed;
+};
+
+// Starts a framed message at the end of out and returns where it begins; endMessage() fills in the length
+size_t beginMessage(std::vector<uint8_t> &out, MessageType type);
+
+void endMessage(std::vector<uint8_t> &out, size_t start);
+
+void writeHello(std::vector<uint8_t> &out, const HelloMessage &message);
+
+void writeWelcome(std::vector<uint8_t> &out, const WelcomeMessage &message);
+
+void writeServerTick(std::vector<uint8_t> &out, const ServerTickMessage &message);
+
+void writeColumnData(std::vector<uint8_t> &out, const ColumnDataMessage &message);
+
+void writeChunkData(std::vector<uint8_t> &out, ChunkPos position, uint32_t version, const BlockStorage &blocks);
+
+void writeColumnUnload(std::vector<uint8_t> &out, ColumnPos position);
+
+void writeBlockChanges(std::vector<uint8_t> &out, const BlockChangesMessage &message);
+
+void writeSetBlock(std::vector<uint8_t> &out, const SetBlockMessage &message);
+
+void writeChunkResync(std::vector<uint8_t> &out, ChunkPos position);
+
+void writePlayerInput(std::vector<uint8_t> &out, const PlayerInputMessage &message);
+
+void writePlayerStates(std::vector<uint8_t> &out, const PlayerStatesMessage &message);
+
+// Readers take the payload after the type byte and return false on truncated or malformed input
+bool readHello(ByteReader &reader, HelloMessage &message);
+
+bool readWelcome(ByteReader &reader, WelcomeMessage &message);
+
+bool readServerTick(ByteReader &reader, ServerTickMessage &message);
+
+bool readColumnData(ByteReader &reader, ColumnDataMessage &message);
+
+bool readChunkData(ByteReader &reader, ChunkPos &position, uint32_t &version, BlockStorage &blocks);
+
+bool readColumnUnload(ByteReader &reader, ColumnPos &position);
+
+bool readBlockChanges(ByteReader &reader, BlockChangesMessage &message);
+
+bool readSetBlock(ByteReader &reader, SetBlockMessage &message);
+
+bool readChunkResync(ByteReader &reader, ChunkPos &position);
+
+bool readPlayerInput(ByteReader &reader, PlayerInputMessage &message);
+
+bool readPlayerStates(ByteReader &reader, PlayerStatesMessage &message);
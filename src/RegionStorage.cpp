@@ -0,0 +1,370 @@
+#include "RegionStorage.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "ByteBuffer.hpp"
+#include "ChunkCodec.hpp"
+
+namespace {
+  constexpr uint32_t REGION_MAGIC = 0x4752424E; // "NBRG"
+  constexpr uint32_t REGION_FORMAT_VERSION = 2;
+  constexpr uint32_t WORLD_MAGIC = 0x4457424E; // "NBWD"
+  constexpr uint32_t WORLD_FORMAT_VERSION = 1;
+
+  // Magic and format version, then a (first sector, length in bytes) pair per chunk
+  constexpr size_t REGION_TABLE_OFFSET = 8;
+  constexpr size_t REGION_ENTRY_SIZE = 8;
+  constexpr size_t REGION_HEADER_SECTORS =
+    (REGION_TABLE_OFFSET + REGION_CHUNK_COUNT * REGION_ENTRY_SIZE + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+
+  ColumnPos regionOf(ChunkPos position) {
+    return {floorDiv(position.x, REGION_SIZE), floorDiv(position.z, REGION_SIZE)};
+  }
+
+  // A column's chunks are next to each other, bottom to top
+  int entryIndex(ChunkPos position) {
+    auto column = floorMod(position.x, REGION_SIZE) + floorMod(position.z, REGION_SIZE) * REGION_SIZE;
+    return column * WORLD_HEIGHT_CHUNKS + position.y;
+  }
+
+  bool isInWorld(ChunkPos position) {
+    return position.y >= 0 && position.y < WORLD_HEIGHT_CHUNKS;
+  }
+
+  size_t sectorsFor(size_t bytes) {
+    return (bytes + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+  }
+
+  // First free run of count sectors; when there is none, where the free run at the end starts, which
+  // the caller extends by growing the file
+  size_t findFreeSectors(const std::vector<bool> &used, size_t count) {
+    size_t run = 0;
+    for (size_t i = 0; i < used.size(); ++i) {
+      run = used[i] ? 0 : run + 1;
+      if (run == count) {
+        return i + 1 - count;
+      }
+    }
+    return used.size() - run;
+  }
+}
+
+RegionStorage::RegionStorage(std::filesystem::path directory) : directory(std::move(directory)) {
+  std::error_code error;
+  std::filesystem::create_directories(this->directory, error);
+  if (error) {
+    std::cerr << "Error creating world directory " << this->directory << ": " << error.message() << std::endl;
+  }
+
+  writer = std::thread(&RegionStorage::writeLoop, this);
+}
+
+RegionStorage::~RegionStorage() {
+  {
+    std::lock_guard lock(queueMutex);
+    stopping = true;
+  }
+  queueChanged.notify_all();
+  writer.join();
+
+  std::lock_guard lock(regionsMutex);
+  for (auto &[position, region]: regions) {
+    if (region) {
+      region->file.sync();
+    }
+  }
+}
+
+bool RegionStorage::load(ChunkPos position, BlockStorage &blocks, uint32_t &version) {
+  if (!isInWorld(position)) {
+    return false;
+  }
+
+  {
+    std::lock_guard lock(queueMutex);
+    if (auto it = pending.find(position); it != pending.end()) {
+      blocks = it->second.blocks;
+      version = it->second.version;
+      return true;
+    }
+  }
+
+  auto *region = getRegion(regionOf(position), false);
+  if (region == nullptr) {
+    return false;
+  }
+
+  std::shared_lock lock(region->mutex);
+  auto entry = region->table[entryIndex(position)];
+  if (entry.length == 0) {
+    return false;
+  }
+
+  // Decoding touches the record's pages for the first time; that page fault is the whole read
+  ByteReader reader(region->file.data() + entry.firstSector * REGION_SECTOR_SIZE, entry.length);
+  version = reader.readU32();
+  if (!decodeBlocks(reader, blocks) || !reader.isValid()) {
+    std::cerr << "Discarding unreadable saved chunk " << position.x << ", " << position.y << ", " << position.z
+              << std::endl;
+    return false;
+  }
+
+  chunksLoaded.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void RegionStorage::save(ChunkPos position, const BlockStorage &blocks, uint32_t version) {
+  if (!isInWorld(position)) {
+    return;
+  }
+
+  {
+    std::lock_guard lock(queueMutex);
+    auto [it, inserted] = pending.try_emplace(position);
+    it->second.blocks = blocks;
+    it->second.version = version;
+    it->second.serial = nextSerial++;
+    if (inserted) {
+      saveOrder.push_back(position);
+    }
+  }
+  queueChanged.notify_all();
+}
+
+void RegionStorage::flush() {
+  {
+    std::unique_lock lock(queueMutex);
+    queueChanged.wait(lock, [this]() {
+      return saveOrder.empty() && !writing;
+    });
+  }
+
+  std::lock_guard lock(regionsMutex);
+  for (auto &[position, region]: regions) {
+    if (region) {
+      std::shared_lock regionLock(region->mutex);
+      region->file.sync();
+    }
+  }
+}
+
+bool RegionStorage::loadSeed(uint32_t &seed) const {
+  std::ifstream file(directory / "world.dat", std::ios::binary);
+  uint8_t data[12];
+  if (!file.read(reinterpret_cast<char *>(data), sizeof(data))) {
+    return false;
+  }
+
+  ByteReader reader(data, sizeof(data));
+  if (reader.readU32() != WORLD_MAGIC || reader.readU32() != WORLD_FORMAT_VERSION) {
+    return false;
+  }
+  seed = reader.readU32();
+  return true;
+}
+
+bool RegionStorage::saveSeed(uint32_t seed) const {
+  std::vector<uint8_t> data;
+  ByteWriter writer(data);
+  writer.writeU32(WORLD_MAGIC);
+  writer.writeU32(WORLD_FORMAT_VERSION);
+  writer.writeU32(seed);
+
+  std::ofstream file(directory / "world.dat", std::ios::binary | std::ios::trunc);
+  return static_cast<bool>(file.write(reinterpret_cast<const char *>(data.data()),
+                                      static_cast<std::streamsize>(data.size())));
+}
+
+const std::filesystem::path &RegionStorage::getDirectory() const {
+  return directory;
+}
+
+RegionStats RegionStorage::getStats() const {
+  RegionStats stats{};
+  {
+    std::lock_guard lock(regionsMutex);
+    for (const auto &[position, region]: regions) {
+      stats.regionsOpen += region != nullptr;
+    }
+  }
+  {
+    std::lock_guard lock(queueMutex);
+    stats.pendingSaves = pending.size();
+  }
+  stats.chunksLoaded = chunksLoaded.load(std::memory_order_relaxed);
+  stats.chunksSaved = chunksSaved.load(std::memory_order_relaxed);
+  stats.bytesWritten = bytesWritten.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void RegionStorage::writeLoop() {
+  std::unique_lock lock(queueMutex);
+  while (true) {
+    queueChanged.wait(lock, [this]() {
+      return stopping || !saveOrder.empty();
+    });
+    if (saveOrder.empty()) {
+      return;
+    }
+
+    auto position = saveOrder.front();
+    saveOrder.pop_front();
+    const auto &queued = pending.at(position);
+    auto blocks = queued.blocks;
+    auto version = queued.version;
+    auto serial = queued.serial;
+    writing = true;
+
+    lock.unlock();
+    if (writeChunk(position, blocks, version)) {
+      chunksSaved.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      std::cerr << "Error saving chunk " << position.x << ", " << position.y << ", " << position.z << std::endl;
+    }
+    lock.lock();
+
+    // A save() that came in meanwhile replaced the copy without queueing it again
+    writing = false;
+    auto it = pending.find(position);
+    if (it->second.serial == serial) {
+      pending.erase(it);
+    } else {
+      saveOrder.push_back(position);
+    }
+    queueChanged.notify_all();
+  }
+}
+
+bool RegionStorage::writeChunk(ChunkPos position, const BlockStorage &blocks, uint32_t version) {
+  std::vector<uint8_t> record;
+  ByteWriter recordWriter(record);
+  recordWriter.writeU32(version);
+  encodeBlocks(recordWriter, blocks);
+
+  auto *region = getRegion(regionOf(position), true);
+  if (region == nullptr) {
+    return false;
+  }
+
+  std::unique_lock lock(region->mutex);
+  auto &used = region->usedSectors;
+  auto count = sectorsFor(record.size());
+
+  // The new record never overwrites the old one, so a crash mid-write leaves the previous copy intact
+  auto first = findFreeSectors(used, count);
+  if (first + count > used.size()) {
+    auto sectors = std::max(first + count, used.size() + REGION_GROWTH_SECTORS);
+    if (!region->file.reserve(sectors * REGION_SECTOR_SIZE)) {
+      return false;
+    }
+    used.resize(sectors, false);
+  }
+
+  if (!region->file.write(first * REGION_SECTOR_SIZE, record.data(), record.size())) {
+    return false;
+  }
+
+  auto index = entryIndex(position);
+  std::vector<uint8_t> entryBytes;
+  ByteWriter entryWriter(entryBytes);
+  entryWriter.writeU32(static_cast<uint32_t>(first));
+  entryWriter.writeU32(static_cast<uint32_t>(record.size()));
+  if (!region->file.write(REGION_TABLE_OFFSET + index * REGION_ENTRY_SIZE, entryBytes.data(), entryBytes.size())) {
+    return false;
+  }
+
+  auto &entry = region->table[index];
+  if (entry.length != 0) {
+    std::fill_n(used.begin() + entry.firstSector, sectorsFor(entry.length), false);
+  }
+  std::fill_n(used.begin() + static_cast<ptrdiff_t>(first), count, true);
+  entry = {static_cast<uint32_t>(first), static_cast<uint32_t>(record.size())};
+
+  bytesWritten.fetch_add(record.size() + entryBytes.size(), std::memory_order_relaxed);
+  return true;
+}
+
+RegionStorage::Region *RegionStorage::getRegion(ColumnPos regionPosition, bool create) {
+  std::lock_guard lock(regionsMutex);
+  auto it = regions.find(regionPosition);
+  if (it != regions.end() && (it->second || !create)) {
+    return it->second.get();
+  }
+
+  // Missing files are remembered as null so chunks that were never saved do not touch the disk again
+  auto path = getRegionPath(regionPosition);
+  std::error_code error;
+  if (!create && !std::filesystem::exists(path, error)) {
+    regions[regionPosition] = nullptr;
+    return nullptr;
+  }
+
+  auto region = std::make_unique<Region>();
+  if (!openRegion(*region, path)) {
+    std::cerr << "Error opening region file " << path << std::endl;
+    regions[regionPosition] = nullptr;
+    return nullptr;
+  }
+
+  auto *opened = region.get();
+  regions[regionPosition] = std::move(region);
+  return opened;
+}
+
+bool RegionStorage::openRegion(Region &region, const std::filesystem::path &path) {
+  auto &file = region.file;
+  if (!file.open(path)) {
+    return false;
+  }
+
+  if (file.size() == 0) {
+    std::vector<uint8_t> header;
+    ByteWriter writer(header);
+    writer.writeU32(REGION_MAGIC);
+    writer.writeU32(REGION_FORMAT_VERSION);
+    if (!file.reserve(REGION_HEADER_SECTORS * REGION_SECTOR_SIZE) ||
+        !file.write(0, header.data(), header.size())) {
+      return false;
+    }
+  }
+
+  auto sectorCount = file.size() / REGION_SECTOR_SIZE;
+  if (sectorCount < REGION_HEADER_SECTORS) {
+    return false;
+  }
+
+  ByteReader reader(file.data(), REGION_HEADER_SECTORS * REGION_SECTOR_SIZE);
+  if (reader.readU32() != REGION_MAGIC || reader.readU32() != REGION_FORMAT_VERSION) {
+    return false;
+  }
+
+  region.usedSectors.assign(sectorCount, false);
+  std::fill_n(region.usedSectors.begin(), REGION_HEADER_SECTORS, true);
+
+  // Entries that point outside the file or into another record are dropped; their chunks regenerate
+  for (auto &entry: region.table) {
+    RegionEntry stored{reader.readU32(), reader.readU32()};
+    if (stored.length == 0) {
+      continue;
+    }
+
+    auto first = static_cast<size_t>(stored.firstSector);
+    auto count = sectorsFor(stored.length);
+    auto valid = first >= REGION_HEADER_SECTORS && first + count <= sectorCount;
+    for (size_t i = first; valid && i < first + count; ++i) {
+      valid = !region.usedSectors[i];
+    }
+    if (!valid) {
+      continue;
+    }
+
+    std::fill_n(region.usedSectors.begin() + static_cast<ptrdiff_t>(first), count, true);
+    entry = stored;
+  }
+  return true;
+}
+
+std::filesystem::path RegionStorage::getRegionPath(ColumnPos regionPosition) const {
+  return directory / ("r." + std::to_string(regionPosition.x) + "." + std::to_string(regionPosition.y) + ".nbr");
+}
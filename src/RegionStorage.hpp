@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "BlockStorage.hpp"
+#include "ChunkPos.hpp"
+#include "MappedFile.hpp"
+
+// Chunks are grouped into region files of REGION_SIZE x REGION_SIZE full-height columns. Each file starts
+// with a table of where every chunk's record lives, followed by records allocated in whole sectors.
+constexpr int REGION_SIZE = 32;
+constexpr int REGION_CHUNK_COUNT = REGION_SIZE * REGION_SIZE * WORLD_HEIGHT_CHUNKS;
+constexpr size_t REGION_SECTOR_SIZE = 4096;
+
+// Files grow by at least this many sectors at a time so appending rarely has to remap them
+constexpr size_t REGION_GROWTH_SECTORS = 64;
+
+struct RegionStats {
+  size_t regionsOpen;
+  size_t pendingSaves;
+  uint64_t chunksLoaded;
+  uint64_t chunksSaved;
+  uint64_t bytesWritten;
+};
+
+// On-disk chunk persistence. Loads decode straight out of the memory-mapped region file and are safe from
+// any thread. Saves only copy the blocks and return; a background thread encodes and writes them, so
+// callers never wait on the disk unless they ask to with flush().
+class RegionStorage {
+public:
+  explicit RegionStorage(std::filesystem::path directory);
+
+  // Writes everything still queued before returning
+  ~RegionStorage();
+
+  RegionStorage(const RegionStorage &) = delete;
+
+  RegionStorage &operator=(const RegionStorage &) = delete;
+
+  // Returns false when the chunk was never saved or lies outside the world. A chunk queued for saving
+  // loads as queued.
+  bool load(ChunkPos position, BlockStorage &blocks, uint32_t &version);
+
+  // Queues a copy of the blocks; saving the same chunk again before it is written replaces the copy
+  void save(ChunkPos position, const BlockStorage &blocks, uint32_t version);
+
+  // Blocks until every queued save is on disk
+  void flush();
+
+  // The world's seed, kept next to the region files; returns false for a new world
+  bool loadSeed(uint32_t &seed) const;
+
+  bool saveSeed(uint32_t seed) const;
+
+  [[nodiscard]] const std::filesystem::path &getDirectory() const;
+
+  [[nodiscard]] RegionStats getStats() const;
+
+private:
+  struct RegionEntry {
+    uint32_t firstSector;
+    uint32_t length;
+  };
+
+  struct Region {
+    MappedFile file;
+    // Readers share it; the writer takes it alone while it moves records and remaps
+    std::shared_mutex mutex;
+    RegionEntry table[REGION_CHUNK_COUNT]{};
+    std::vector<bool> usedSectors;
+  };
+
+  struct PendingSave {
+    BlockStorage blocks;
+    uint32_t version;
+    // Bumped by every save() so the writer can tell when a newer copy arrived while it was writing
+    uint64_t serial;
+  };
+
+  std::filesystem::path directory;
+
+  // Regions are opened on first use and stay open; a null entry marks a file that does not exist yet
+  mutable std::mutex regionsMutex;
+  std::unordered_map<ColumnPos, std::unique_ptr<Region>, ColumnPosHash> regions;
+
+  mutable std::mutex queueMutex;
+  std::condition_variable queueChanged;
+  std::unordered_map<ChunkPos, PendingSave, ChunkPosHash> pending;
+  std::deque<ChunkPos> saveOrder;
+  uint64_t nextSerial = 0;
+  bool writing = false;
+  bool stopping = false;
+
+  std::atomic<uint64_t> chunksLoaded = 0;
+  std::atomic<uint64_t> chunksSaved = 0;
+  std::atomic<uint64_t> bytesWritten = 0;
+
+  // Declared last so it starts once everything above exists
+  std::thread writer;
+
+  void writeLoop();
+
+  bool writeChunk(ChunkPos position, const BlockStorage &blocks, uint32_t version);
+
+  Region *getRegion(ColumnPos regionPosition, bool create);
+
+  bool openRegion(Region &region, const std::filesystem::path &path);
+
+  [[nodiscard]] std::filesystem::path getRegionPath(ColumnPos regionPosition) const;
+};
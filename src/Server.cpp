@@ -0,0 +1,710 @@
+#include "Server.hpp"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include "ChunkLight.hpp"
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+
+  constexpr auto TICK_INTERVAL = std::chrono::microseconds(1000000 / SERVER_TICK_RATE);
+
+  // After a stall longer than this the tick clock restarts instead of running the missed ticks back to back
+  constexpr int MAX_TICK_BACKLOG = 5;
+
+  const glm::ivec3 FACE_OFFSETS[] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+
+  ColumnPos columnAt(glm::vec3 position) {
+    return columnOf(chunkContaining(glm::ivec3(glm::floor(position))));
+  }
+
+  int distanceSquared(ColumnPos a, ColumnPos b) {
+    auto delta = a - b;
+    return delta.x * delta.x + delta.y * delta.y;
+  }
+}
+
+Server::Server(uint32_t seed, uint16_t port, unsigned workerCount, std::shared_ptr<RegionStorage> storage)
+  : terrain(seed), port(port), storage(std::move(storage)), random(std::random_device()()),
+    movementCollision([this](glm::ivec3 position) {
+      return isSolidForMovement(position);
+    }),
+    jobs(std::make_unique<JobSystem>(workerCount)) {
+}
+
+Server::~Server() {
+  jobs.reset();
+}
+
+bool Server::start() {
+  listener = Socket::listenTcp(port);
+  if (!listener.isValid()) {
+    return false;
+  }
+
+  // With port 0 the system picked one; UDP uses the same number so clients only need one
+  port = listener.getLocalPort();
+  datagrams = Socket::bindUdp(port);
+  if (!datagrams.isValid()) {
+    listener.close();
+    return false;
+  }
+
+  poller.add(listener, LISTENER_POLL_ID, POLL_READABLE);
+  poller.add(datagrams, DATAGRAM_POLL_ID, POLL_READABLE);
+  return true;
+}
+
+void Server::run(const std::atomic<bool> &running) {
+  auto nextTick = Clock::now();
+
+  while (running.load(std::memory_order_relaxed)) {
+    auto now = Clock::now();
+    if (now < nextTick) {
+      auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextTick - now).count();
+      pollNetwork(static_cast<int>(std::max<int64_t>(wait, 1)));
+      continue;
+    }
+
+    tick();
+
+    nextTick += TICK_INTERVAL;
+    if (Clock::now() - nextTick > TICK_INTERVAL * MAX_TICK_BACKLOG) {
+      nextTick = Clock::now();
+    }
+  }
+
+  save();
+}
+
+void Server::pollNetwork(int timeoutMs) {
+  poller.wait(timeoutMs, events);
+
+  for (const auto &event: events) {
+    if (event.id == LISTENER_POLL_ID) {
+      acceptClients();
+      continue;
+    }
+    if (event.id == DATAGRAM_POLL_ID) {
+      receiveDatagrams();
+      continue;
+    }
+
+    auto it = clients.find(static_cast<uint32_t>(event.id));
+    if (it == clients.end()) {
+      continue;
+    }
+
+    auto &client = *it->second;
+    if (event.readable || event.failed) {
+      auto receivedBefore = client.connection.getBytesReceived();
+      auto open = client.connection.receive();
+      stats.bytesReceived += client.connection.getBytesReceived() - receivedBefore;
+      if (!open || !handleMessages(client)) {
+        disconnect(client.id);
+        continue;
+      }
+    }
+    if (event.writable) {
+      flushClient(client);
+    }
+  }
+}
+
+void Server::tick() {
+  auto start = Clock::now();
+  ++tickCount;
+
+  for (auto &[id, client]: clients) {
+    client->tickBytes = 0;
+  }
+
+  collectGeneratedColumns();
+  broadcastBlockChanges();
+
+  std::vector<uint8_t> tickMessage;
+  writeServerTick(tickMessage, {static_cast<uint32_t>(tickCount)});
+
+  // Everyone moves before anyone is told where the others are
+  for (auto &[id, client]: clients) {
+    if (client->welcomed) {
+      client->inputs.apply(client->state, MAX_INPUTS_PER_SERVER_TICK, movementCollision);
+      interest.setPlayer(id, client->state.position, client->viewRadius);
+    }
+  }
+  interest.rebuildGrid();
+
+  for (auto &[id, client]: clients) {
+    if (!client->welcomed) {
+      continue;
+    }
+
+    // Columns go last, so they only get the budget the rest of the tick left
+    updateInterest(*client);
+    queue(*client, tickMessage);
+    sendPlayerStates(*client);
+    streamColumns(*client);
+  }
+
+  std::vector<uint32_t> lost;
+  for (auto &[id, client]: clients) {
+    flushClient(*client);
+    if (!client->connection.isOpen()) {
+      lost.push_back(id);
+    }
+  }
+  for (auto id: lost) {
+    disconnect(id);
+  }
+
+  if (tickCount % SERVER_AUTOSAVE_TICKS == 0) {
+    saveChunks();
+  }
+  if (tickCount % SERVER_TICK_RATE == 0) {
+    evictIdleColumns();
+  }
+
+  auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  auto interestStats = interest.getStats();
+  stats.playerUpdates = interestStats.selected;
+  stats.playerUpdatesDeferred = interestStats.deferred;
+  stats.clients = clients.size();
+  stats.ticks = tickCount;
+  stats.cachedColumns = columns.size();
+  stats.lastTickMs = elapsed;
+  stats.maxTickMs = std::max(stats.maxTickMs, elapsed);
+  stats.totalTickMs += elapsed;
+}
+
+bool Server::setBlock(glm::ivec3 position, BlockId block) {
+  auto chunkPosition = chunkContaining(position);
+  auto it = columns.find(columnOf(chunkPosition));
+  if (position.y < 0 || position.y >= WORLD_HEIGHT || it == columns.end() || !it->second->ready) {
+    return false;
+  }
+
+  auto &column = *it->second;
+  auto index = BlockStorage::index(floorMod(position.x, CHUNK_SIZE), floorMod(position.y, CHUNK_SIZE),
+                                   floorMod(position.z, CHUNK_SIZE));
+  auto *chunk = column.chunks[chunkPosition.y].get();
+  if (chunk == nullptr) {
+    BlockId skipped = chunkPosition.y < column.firstSurfaceChunk ? TERRAIN_BLOCK : 0;
+    if (skipped == block) {
+      return true;
+    }
+    chunk = &createSkippedChunk(chunkPosition, column);
+  }
+
+  if (chunk->blocks.get(index) == block) {
+    return true;
+  }
+
+  chunk->blocks.set(index, block);
+  if (chunk->pendingChanges.empty()) {
+    changedChunks.push_back(chunkPosition);
+  }
+  chunk->pendingChanges.push_back({static_cast<uint16_t>(index), block});
+
+  // Digging into a buried chunk's border uncovers its blocks, so clients need it to draw them
+  if (block == 0) {
+    for (auto offset: FACE_OFFSETS) {
+      auto neighbor = chunkContaining(position + offset);
+      auto neighborColumn = columns.find(columnOf(neighbor));
+      if (neighbor == chunkPosition || neighbor.y < 0 || neighborColumn == columns.end() ||
+          !neighborColumn->second->ready) {
+        continue;
+      }
+
+      auto &candidate = *neighborColumn->second;
+      if (neighbor.y < candidate.firstSurfaceChunk && !candidate.chunks[neighbor.y]) {
+        createSkippedChunk(neighbor, candidate);
+      }
+    }
+  }
+  return true;
+}
+
+void Server::save() {
+  saveChunks();
+  if (storage) {
+    storage->flush();
+  }
+}
+
+uint16_t Server::getPort() const {
+  return port;
+}
+
+const ServerStats &Server::getStats() const {
+  return stats;
+}
+
+void Server::acceptClients() {
+  while (true) {
+    SocketAddress address;
+    auto socket = listener.accept(&address);
+    if (!socket.isValid()) {
+      return;
+    }
+
+    socket.setNoDelay(true);
+
+    auto client = std::make_unique<ClientSession>();
+    client->id = nextClientId++;
+    do {
+      client->token = random();
+    } while (client->token == 0 || clientsByToken.contains(client->token));
+    client->connection = Connection(std::move(socket));
+
+    if (!poller.add(client->connection.getSocket(), client->id, POLL_READABLE)) {
+      continue;
+    }
+
+    clientsByToken.emplace(client->token, client->id);
+    clients.emplace(client->id, std::move(client));
+  }
+}
+
+void Server::receiveDatagrams() {
+  uint8_t buffer[MAX_DATAGRAM_SIZE];
+  SocketAddress address;
+
+  while (true) {
+    auto size = datagrams.receiveFrom(buffer, sizeof(buffer), address);
+    if (size == SOCKET_WOULD_BLOCK) {
+      return;
+    }
+    if (size <= 0) {
+      continue;
+    }
+    stats.bytesReceived += size;
+
+    ByteReader reader(buffer, static_cast<size_t>(size));
+    PlayerInputMessage message{};
+    if (static_cast<MessageType>(reader.readU8()) != MessageType::PlayerInput || !readPlayerInput(reader, message)) {
+      continue;
+    }
+
+    auto token = clientsByToken.find(message.token);
+    if (token == clientsByToken.end()) {
+      continue;
+    }
+
+    // Inputs are queued, not applied, so a client sending faster than it should gains nothing
+    auto &client = *clients.at(token->second);
+    for (const auto &input: message.inputs) {
+      client.inputs.push(input);
+    }
+    if (!message.inputs.empty()) {
+      client.yaw = message.inputs.back().yaw;
+    }
+    client.udpAddress = address;
+  }
+}
+
+bool Server::handleMessages(ClientSession &client) {
+  MessageType type;
+  ByteReader payload;
+  while (client.connection.nextMessage(type, payload)) {
+    if (!client.welcomed) {
+      HelloMessage hello{};
+      if (type != MessageType::Hello || !readHello(payload, hello) || hello.version != PROTOCOL_VERSION) {
+        std::cerr << "Client " << client.id << " sent an unusable hello (protocol version " << hello.version
+                  << ")" << std::endl;
+        return false;
+      }
+      handleHello(client, hello);
+      continue;
+    }
+
+    switch (type) {
+      case MessageType::SetBlock: {
+        SetBlockMessage message{};
+        if (!readSetBlock(payload, message)) {
+          return false;
+        }
+        handleSetBlock(client, message);
+        break;
+      }
+      case MessageType::ChunkResync: {
+        ChunkPos position;
+        if (!readChunkResync(payload, position)) {
+          return false;
+        }
+        handleResync(client, position);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return client.connection.isOpen();
+}
+
+void Server::handleHello(ClientSession &client, const HelloMessage &hello) {
+  client.welcomed = true;
+  client.viewRadius = std::clamp(static_cast<int>(hello.viewRadius), 1, MAX_CLIENT_VIEW_RADIUS);
+  client.state = {hello.position, glm::vec3(0.0f), false};
+
+  WelcomeMessage welcome{};
+  welcome.clientId = client.id;
+  welcome.token = client.token;
+  welcome.seed = terrain.getSeed();
+  welcome.tickRate = SERVER_TICK_RATE;
+  welcome.udpPort = port;
+  welcome.viewRadius = static_cast<uint8_t>(client.viewRadius);
+  writeWelcome(client.connection.getSendBuffer(), welcome);
+  flushClient(client);
+}
+
+void Server::handleSetBlock(ClientSession &client, const SetBlockMessage &message) {
+  // Clients may only edit what they have been sent, and only into blocks that exist
+  if (message.block < BLOCK_TYPE_COUNT && client.sentColumns.contains(columnOf(chunkContaining(message.position)))) {
+    setBlock(message.position, message.block);
+  }
+}
+
+void Server::handleResync(ClientSession &client, ChunkPos position) {
+  // Queued straight away, so the fresh copy arrives before any batch built on top of it
+  auto *chunk = findChunk(position);
+  if (chunk != nullptr && client.sentColumns.contains(columnOf(position))) {
+    queue(client, getChunkMessage(position, *chunk));
+    ++stats.resyncs;
+  }
+}
+
+void Server::flushClient(ClientSession &client) {
+  auto sentBefore = client.connection.getBytesSent();
+  client.connection.flush();
+  stats.bytesSent += client.connection.getBytesSent() - sentBefore;
+
+  // Level-triggered writability would wake every wait, so only ask for it while data is backed up
+  auto wantsWrite = client.connection.getQueuedBytes() > 0;
+  if (wantsWrite != client.wantsWrite && client.connection.isOpen()) {
+    client.wantsWrite = wantsWrite;
+    poller.modify(client.connection.getSocket(), client.id, POLL_READABLE | (wantsWrite ? POLL_WRITABLE : 0));
+  }
+}
+
+void Server::disconnect(uint32_t clientId) {
+  auto it = clients.find(clientId);
+  if (it == clients.end()) {
+    return;
+  }
+
+  if (it->second->connection.getSocket().isValid()) {
+    poller.remove(it->second->connection.getSocket());
+  }
+  for (auto position: it->second->sentColumns) {
+    interest.unsubscribe(clientId, position);
+  }
+  interest.removePlayer(clientId);
+  clientsByToken.erase(it->second->token);
+  clients.erase(it);
+}
+
+void Server::collectGeneratedColumns() {
+  std::vector<std::shared_ptr<ServerColumn>> generated;
+  {
+    std::lock_guard lock(completionMutex);
+    generated.swap(generatedColumns);
+  }
+
+  for (auto &column: generated) {
+    column->ready = true;
+    for (const auto &chunk: column->chunks) {
+      if (chunk) {
+        ++(chunk->loaded ? stats.chunksLoaded : stats.chunksGenerated);
+      }
+    }
+  }
+  pendingGenerations -= generated.size();
+}
+
+void Server::broadcastBlockChanges() {
+  std::vector<uint8_t> message;
+  for (auto position: changedChunks) {
+    auto *found = findChunk(position);
+    if (found == nullptr) {
+      continue;
+    }
+
+    auto &chunk = *found;
+    BlockChangesMessage changes{position, chunk.version, chunk.version + 1, std::move(chunk.pendingChanges)};
+    chunk.pendingChanges.clear();
+    coalesceBlockChanges(changes.changes);
+
+    ++chunk.version;
+    chunk.messageStale = true;
+    unsavedChunks.insert(position);
+    stats.blockChanges += changes.changes.size();
+
+    // Encoded once per chunk, then copied to everyone who has it loaded
+    message.clear();
+    writeBlockChanges(message, changes);
+    for (auto id: interest.getSubscribers(columnOf(position))) {
+      queue(*clients.at(id), message);
+    }
+  }
+  changedChunks.clear();
+}
+
+const std::vector<uint8_t> &Server::getChunkMessage(ChunkPos position, ServerChunk &chunk) {
+  if (chunk.messageStale) {
+    chunk.message.clear();
+    writeChunkData(chunk.message, position, chunk.version, chunk.blocks);
+    chunk.messageStale = false;
+  }
+  return chunk.message;
+}
+
+void Server::updateInterest(ClientSession &client) {
+  auto center = columnAt(client.state.position);
+  if (client.hasCenter && center == client.center) {
+    return;
+  }
+
+  auto previous = client.center;
+  auto hadCenter = client.hasCenter;
+  client.center = center;
+  client.hasCenter = true;
+
+  // Same hysteresis as the client's own eviction: one extra ring stays loaded
+  auto &out = client.connection.getSendBuffer();
+  auto unloadRadius = client.viewRadius + 1;
+  std::erase_if(client.sentColumns, [&](ColumnPos position) {
+    if (distanceSquared(position, center) <= unloadRadius * unloadRadius) {
+      return false;
+    }
+    writeColumnUnload(out, position);
+    interest.unsubscribe(client.id, position);
+    return true;
+  });
+
+  // The queue already holds whatever of the previous view is unsent, so only the columns that left the
+  // view go and the ones that came into it are added
+  auto radiusSquared = client.viewRadius * client.viewRadius;
+  std::erase_if(client.sendQueue, [&](ColumnPos position) {
+    return distanceSquared(position, center) > radiusSquared;
+  });
+  for (auto dx = -client.viewRadius; dx <= client.viewRadius; ++dx) {
+    for (auto dz = -client.viewRadius; dz <= client.viewRadius; ++dz) {
+      ColumnPos position = center + ColumnPos(dx, dz);
+      if (dx * dx + dz * dz <= radiusSquared && !(hadCenter && distanceSquared(position, previous) <= radiusSquared) &&
+          !client.sentColumns.contains(position)) {
+        client.sendQueue.push_back(position);
+      }
+    }
+  }
+
+  std::sort(client.sendQueue.begin(), client.sendQueue.end(), [center](ColumnPos a, ColumnPos b) {
+    return distanceSquared(a, center) > distanceSquared(b, center);
+  });
+}
+
+void Server::sendPlayerStates(ClientSession &client) {
+  PlayerStatesMessage message{static_cast<uint32_t>(tickCount), client.inputs.getLastApplied(), client.state, {}, {}};
+
+  interest.selectPlayers(client.id, MAX_PLAYER_UPDATES_PER_TICK, selectedPlayers, message.removed);
+  for (auto id: selectedPlayers) {
+    const auto &other = *clients.at(id);
+    message.players.push_back({id, other.state.position, other.yaw});
+  }
+
+  auto &out = client.connection.getSendBuffer();
+  auto sizeBefore = out.size();
+  writePlayerStates(out, message);
+  client.tickBytes += out.size() - sizeBefore;
+}
+
+void Server::queue(ClientSession &client, const std::vector<uint8_t> &message) {
+  client.connection.queue(message.data(), message.size());
+  client.tickBytes += message.size();
+}
+
+void Server::streamColumns(ClientSession &client) {
+  auto budget = CLIENT_BYTES_PER_TICK - std::min(client.tickBytes, CLIENT_BYTES_PER_TICK);
+
+  // Walk from the nearest end; columns still generating keep their place so nearer ones go out first
+  auto scanned = size_t(0);
+  for (auto i = client.sendQueue.size(); i-- > 0 && scanned < COLUMN_SEND_SCAN_LIMIT; ++scanned) {
+    if (client.connection.getQueuedBytes() >= CLIENT_SEND_BUFFER_LIMIT) {
+      break;
+    }
+
+    auto position = client.sendQueue[i];
+    auto column = requestColumn(position, distanceSquared(position, client.center));
+    if (!column || !column->ready) {
+      continue;
+    }
+
+    // A column goes out whole, so the client never sees part of one
+    auto size = column->message.size();
+    for (auto y = 0; y < WORLD_HEIGHT_CHUNKS; ++y) {
+      if (const auto &chunk = column->chunks[y]) {
+        size += getChunkMessage({position.x, y, position.y}, *chunk).size();
+      }
+    }
+    if (size > budget) {
+      break;
+    }
+
+    client.connection.queue(column->message.data(), column->message.size());
+    for (const auto &chunk: column->chunks) {
+      if (chunk) {
+        client.connection.queue(chunk->message.data(), chunk->message.size());
+        ++stats.chunksSent;
+      }
+    }
+    client.tickBytes += size;
+    client.sentColumns.insert(position);
+    interest.subscribe(client.id, position);
+    client.sendQueue.erase(client.sendQueue.begin() + static_cast<ptrdiff_t>(i));
+    budget -= size;
+  }
+}
+
+std::shared_ptr<Server::ServerColumn> Server::requestColumn(ColumnPos position, int priority) {
+  if (auto it = columns.find(position); it != columns.end()) {
+    it->second->lastUsedTick = tickCount;
+    return it->second;
+  }
+
+  if (pendingGenerations >= MAX_PENDING_GENERATIONS) {
+    return nullptr;
+  }
+
+  auto column = std::make_shared<ServerColumn>();
+  column->lastUsedTick = tickCount;
+  columns.emplace(position, column);
+  ++pendingGenerations;
+
+  jobs->submit(priority, [this, column, position]() mutable {
+    HeightMap map;
+    terrain.getHeightMap(position, map);
+    column->firstSurfaceChunk = map.getFirstSurfaceChunk();
+    auto lastSurfaceChunk = map.getLastSurfaceChunk();
+
+    // Saved chunks come back wherever they are, since an edit may have put blocks in the sky or dug into
+    // buried ground
+    for (auto y = 0; y < WORLD_HEIGHT_CHUNKS; ++y) {
+      ChunkPos chunkPosition(position.x, y, position.y);
+      auto chunk = std::make_shared<ServerChunk>();
+      if (storage && storage->load(chunkPosition, chunk->blocks, chunk->version)) {
+        chunk->loaded = true;
+      } else if (y >= column->firstSurfaceChunk && y <= lastSurfaceChunk) {
+        terrain.generate(chunkPosition, map, chunk->blocks);
+      } else {
+        continue;
+      }
+
+      writeChunkData(chunk->message, chunkPosition, chunk->version, chunk->blocks);
+      column->chunks[y] = std::move(chunk);
+    }
+    writeColumnData(column->message, {position, static_cast<uint8_t>(column->firstSurfaceChunk)});
+
+    std::lock_guard lock(completionMutex);
+    generatedColumns.push_back(std::move(column));
+  });
+
+  if (jobs->getWorkerCount() == 0) {
+    jobs->runPending(1);
+  }
+  return column;
+}
+
+Server::ServerChunk *Server::findChunk(ChunkPos position) const {
+  auto it = columns.find(columnOf(position));
+  if (position.y < 0 || position.y >= WORLD_HEIGHT_CHUNKS || it == columns.end() || !it->second->ready) {
+    return nullptr;
+  }
+  return it->second->chunks[position.y].get();
+}
+
+bool Server::isSolidForMovement(glm::ivec3 position) const {
+  if (position.y < 0) {
+    return true;
+  }
+  if (position.y >= WORLD_HEIGHT) {
+    return false;
+  }
+
+  auto chunkPosition = chunkContaining(position);
+  auto it = columns.find(columnOf(chunkPosition));
+  if (it == columns.end() || !it->second->ready) {
+    return true;
+  }
+
+  const auto &column = *it->second;
+  const auto *chunk = column.chunks[chunkPosition.y].get();
+  if (chunk == nullptr) {
+    return chunkPosition.y < column.firstSurfaceChunk;
+  }
+  return chunk->blocks.get(BlockStorage::index(floorMod(position.x, CHUNK_SIZE), floorMod(position.y, CHUNK_SIZE),
+                                               floorMod(position.z, CHUNK_SIZE))) != 0;
+}
+
+Server::ServerChunk &Server::createSkippedChunk(ChunkPos position, ServerColumn &column) {
+  auto chunk = std::make_shared<ServerChunk>();
+  terrain.generate(position, chunk->blocks);
+  writeChunkData(chunk->message, position, chunk->version, chunk->blocks);
+  ++stats.chunksGenerated;
+
+  // Saved even while unchanged, so a buried chunk that has been uncovered still exists the next time its
+  // column loads
+  unsavedChunks.insert(position);
+
+  // Clients that have the column need the chunk before any change to it
+  for (auto id: interest.getSubscribers(columnOf(position))) {
+    queue(*clients.at(id), chunk->message);
+  }
+
+  column.chunks[position.y] = chunk;
+  return *chunk;
+}
+
+void Server::evictIdleColumns() {
+  if (columns.size() <= SERVER_COLUMN_CACHE_LIMIT) {
+    return;
+  }
+
+  // Anything a client still has loaded may be wanted again soon
+  for (const auto &[id, client]: clients) {
+    for (auto position: client->sentColumns) {
+      if (auto it = columns.find(position); it != columns.end()) {
+        it->second->lastUsedTick = tickCount;
+      }
+    }
+  }
+
+  std::erase_if(columns, [this](const auto &entry) {
+    const auto &[position, column] = entry;
+    if (!column->ready || tickCount - column->lastUsedTick <= SERVER_COLUMN_IDLE_TICKS) {
+      return false;
+    }
+
+    for (auto y = 0; y < WORLD_HEIGHT_CHUNKS; ++y) {
+      if (unsavedChunks.contains({position.x, y, position.y})) {
+        return false;
+      }
+    }
+    return true;
+  });
+}
+
+void Server::saveChunks() {
+  if (!storage) {
+    return;
+  }
+
+  for (auto position: unsavedChunks) {
+    auto *chunk = findChunk(position);
+    if (chunk == nullptr) {
+      continue;
+    }
+
+    storage->save(position, chunk->blocks, chunk->version);
+    ++stats.chunksSaved;
+  }
+  unsavedChunks.clear();
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Connection.hpp"
+#include "InterestManager.hpp"
+#include "JobSystem.hpp"
+#include "Poller.hpp"
+#include "Protocol.hpp"
+#include "RegionStorage.hpp"
+#include "TerrainGenerator.hpp"
+
+constexpr int MAX_CLIENT_VIEW_RADIUS = 16;
+
+// A client stops being fed columns while this much is still waiting in its send buffer, so a slow reader
+// costs the server memory proportional to this, not to its view radius
+constexpr size_t CLIENT_SEND_BUFFER_LIMIT = 512 * 1024;
+// Everything queued for a client in one tick counts against this; columns only get what the rest left over
+constexpr size_t CLIENT_BYTES_PER_TICK = 256 * 1024;
+
+// Other players a client hears about per tick; beyond that, the nearest are updated every tick and the rest
+// take turns
+constexpr size_t MAX_PLAYER_UPDATES_PER_TICK = 64;
+
+// Queue entries inspected per client and tick when looking for generated columns to send
+constexpr size_t COLUMN_SEND_SCAN_LIMIT = 64;
+
+constexpr size_t MAX_PENDING_GENERATIONS = 128;
+
+// Columns no client has wanted for this many ticks are dropped once the cache holds more than the limit
+constexpr size_t SERVER_COLUMN_CACHE_LIMIT = 2048;
+constexpr uint64_t SERVER_COLUMN_IDLE_TICKS = 10 * SERVER_TICK_RATE;
+
+// Edited chunks are queued for saving this often, and once more when the server stops
+constexpr uint64_t SERVER_AUTOSAVE_TICKS = 5 * SERVER_TICK_RATE;
+
+struct ServerStats {
+  size_t clients;
+  uint64_t ticks;
+  uint64_t chunksGenerated;
+  uint64_t chunksLoaded;
+  uint64_t chunksSaved;
+  uint64_t chunksSent;
+  uint64_t blockChanges;
+  uint64_t resyncs;
+  uint64_t playerUpdates;
+  uint64_t playerUpdatesDeferred;
+  uint64_t bytesSent;
+  uint64_t bytesReceived;
+  size_t cachedColumns;
+  double lastTickMs;
+  double maxTickMs;
+  double totalTickMs;
+};
+
+// The authoritative world. Owns terrain generation and streams columns of chunks to every connected client
+// in order of distance from its player, at a fixed tick rate. Clients only hear about the columns and players
+// within their view radius, within a per-tick byte budget. Clients connect over TCP, which carries every
+// reliable message; movement inputs arrive as UDP datagrams on the same port number and are applied here,
+// so the server decides where every player is. With storage, saved chunks are loaded in place of generating
+// them and edits are saved as they happen.
+class Server {
+public:
+  explicit Server(uint32_t seed, uint16_t port = DEFAULT_SERVER_PORT,
+                  unsigned workerCount = JobSystem::defaultWorkerCount(),
+                  std::shared_ptr<RegionStorage> storage = nullptr);
+
+  ~Server();
+
+  // Opens the listening sockets; returns false when the port is taken
+  bool start();
+
+  // Ticks at SERVER_TICK_RATE until running is cleared, handling network traffic in between, then saves
+  void run(const std::atomic<bool> &running);
+
+  // Waits at most timeoutMs for network traffic and handles whatever arrives
+  void pollNetwork(int timeoutMs);
+
+  void tick();
+
+  // Edits a generated column; the change reaches clients with the next tick's BlockChanges batch. Chunks
+  // that were skipped as air or buried are created on demand and sent ahead of it.
+  // Returns false when the block lies outside the world or in a column that is not generated yet.
+  bool setBlock(glm::ivec3 position, BlockId block);
+
+  // Queues every chunk edited since it was last saved and waits until they are written
+  void save();
+
+  [[nodiscard]] uint16_t getPort() const;
+
+  [[nodiscard]] const ServerStats &getStats() const;
+
+private:
+  struct ServerChunk {
+    BlockStorage blocks;
+    // The framed ChunkData message, encoded once and shared by every client that needs it
+    std::vector<uint8_t> message;
+    bool messageStale = false;
+    // Read back from storage rather than generated
+    bool loaded = false;
+
+    // Bumped once per tick that changes the chunk; clients compare it to spot missed batches
+    uint32_t version = 0;
+    std::vector<BlockChange> pendingChanges;
+  };
+
+  struct ServerColumn {
+    // Null where the chunk was skipped as air or buried
+    std::array<std::shared_ptr<ServerChunk>, WORLD_HEIGHT_CHUNKS> chunks;
+    // The framed ColumnData message, sent ahead of the chunks
+    std::vector<uint8_t> message;
+    int firstSurfaceChunk = 0;
+    bool ready = false;
+    uint64_t lastUsedTick = 0;
+  };
+
+  struct ClientSession {
+    uint32_t id;
+    uint32_t token;
+    Connection connection;
+    bool welcomed = false;
+    bool wantsWrite = false;
+    // Queued since the tick started, against CLIENT_BYTES_PER_TICK
+    size_t tickBytes = 0;
+
+    int viewRadius = 0;
+    PlayerState state{};
+    float yaw = 0.0f;
+    InputQueue inputs;
+    SocketAddress udpAddress;
+
+    ColumnPos center{};
+    bool hasCenter = false;
+
+    // Every column in view not sent yet, farthest first so the nearest is taken from the back
+    std::vector<ColumnPos> sendQueue;
+    std::unordered_set<ColumnPos, ColumnPosHash> sentColumns;
+  };
+
+  TerrainGenerator terrain;
+  uint16_t port;
+  std::shared_ptr<RegionStorage> storage;
+
+  Socket listener;
+  Socket datagrams;
+  Poller poller;
+  std::vector<PollEvent> events;
+
+  std::mt19937 random;
+  uint32_t nextClientId = FIRST_CLIENT_ID;
+  std::unordered_map<uint32_t, std::unique_ptr<ClientSession>> clients;
+  std::unordered_map<uint32_t, uint32_t> clientsByToken;
+
+  // Bound once to isSolidForMovement() for every player's movement
+  SolidBlockQuery movementCollision;
+
+  // Who can see which players, and which clients have which columns
+  InterestManager interest;
+  std::vector<uint32_t> selectedPlayers;
+
+  std::unordered_map<ColumnPos, std::shared_ptr<ServerColumn>, ColumnPosHash> columns;
+  size_t pendingGenerations = 0;
+
+  // Chunks with pendingChanges, in the order they were first edited this tick
+  std::vector<ChunkPos> changedChunks;
+
+  // Chunks changed since they were last saved. They cannot be regenerated from the seed, so their columns
+  // are not evicted until they are saved.
+  std::unordered_set<ChunkPos, ChunkPosHash> unsavedChunks;
+
+  // Filled by worker threads, drained at the start of every tick
+  std::mutex completionMutex;
+  std::vector<std::shared_ptr<ServerColumn>> generatedColumns;
+
+  uint64_t tickCount = 0;
+  ServerStats stats{};
+
+  // Declared last so workers are joined before anything they write to is destroyed
+  std::unique_ptr<JobSystem> jobs;
+
+  // Poll ids of the server's own sockets; client ids double as poll ids and start after them
+  static constexpr uint64_t LISTENER_POLL_ID = 0;
+  static constexpr uint64_t DATAGRAM_POLL_ID = 1;
+  static constexpr uint32_t FIRST_CLIENT_ID = 2;
+
+  void acceptClients();
+
+  void receiveDatagrams();
+
+  // Returns false when the client broke the protocol and has to be dropped
+  bool handleMessages(ClientSession &client);
+
+  void handleHello(ClientSession &client, const HelloMessage &hello);
+
+  void handleSetBlock(ClientSession &client, const SetBlockMessage &message);
+
+  void handleResync(ClientSession &client, ChunkPos position);
+
+  void flushClient(ClientSession &client);
+
+  void disconnect(uint32_t clientId);
+
+  void collectGeneratedColumns();
+
+  void broadcastBlockChanges();
+
+  // The chunk's ChunkData message, re-encoded first when edits have made it stale
+  const std::vector<uint8_t> &getChunkMessage(ChunkPos position, ServerChunk &chunk);
+
+  void updateInterest(ClientSession &client);
+
+  // The client's own authoritative state and the players in view the interest manager picked for it
+  void sendPlayerStates(ClientSession &client);
+
+  void queue(ClientSession &client, const std::vector<uint8_t> &message);
+
+  void streamColumns(ClientSession &client);
+
+  // Columns that are not generated yet count as solid, so players wait at their edge instead of falling
+  [[nodiscard]] bool isSolidForMovement(glm::ivec3 position) const;
+
+  // Returns the cached column, starting its generation when it is not cached yet
+  std::shared_ptr<ServerColumn> requestColumn(ColumnPos position, int priority);
+
+  // Null when the column is not generated yet or the chunk was skipped
+  [[nodiscard]] ServerChunk *findChunk(ChunkPos position) const;
+
+  // Generates a chunk its column skipped and sends it to every client that has the column
+  ServerChunk &createSkippedChunk(ChunkPos position, ServerColumn &column);
+
+  void saveChunks();
+
+  void evictIdleColumns();
+};
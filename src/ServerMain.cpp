@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include "Server.hpp"
+
+std::atomic<bool> isServerRunning = true;
+
+void stopServer(int) {
+  isServerRunning = false;
+}
+
+int main(int argc, char *argv[]) {
+  uint16_t port = DEFAULT_SERVER_PORT;
+  uint32_t seed = time(nullptr) % 1000;
+  auto seedGiven = false;
+  std::string worldDirectory = "world";
+  auto workers = JobSystem::defaultWorkerCount();
+
+  for (auto i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (argument == "--port" && i + 1 < argc) {
+      port = static_cast<uint16_t>(std::stoi(argv[++i]));
+    } else if (argument == "--seed" && i + 1 < argc) {
+      seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+      seedGiven = true;
+    } else if (argument == "--world" && i + 1 < argc) {
+      worldDirectory = argv[++i];
+    } else if (argument == "--workers" && i + 1 < argc) {
+      workers = static_cast<unsigned>(std::stoul(argv[++i]));
+    } else {
+      std::cerr << "Usage: netblocks_server [--port port] [--seed seed] [--world directory] [--workers count]" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // An existing world keeps the seed it was created with
+  auto storage = std::make_shared<RegionStorage>(worldDirectory);
+  uint32_t savedSeed;
+  if (storage->loadSeed(savedSeed)) {
+    if (seedGiven && savedSeed != seed) {
+      std::cerr << "Ignoring --seed, " << worldDirectory << " was created with seed " << savedSeed << std::endl;
+    }
+    seed = savedSeed;
+  } else if (!storage->saveSeed(seed)) {
+    std::cerr << "Error writing the seed to " << worldDirectory << std::endl;
+  }
+
+  Server server(seed, port, workers, storage);
+  if (!server.start()) {
+    return EXIT_FAILURE;
+  }
+
+  std::signal(SIGINT, stopServer);
+  std::signal(SIGTERM, stopServer);
+
+  std::cout << "Serving " << worldDirectory << " (seed " << seed << ") on port " << server.getPort() << " with "
+            << workers << " workers at " << SERVER_TICK_RATE << " ticks per second" << std::endl;
+  server.run(isServerRunning);
+
+  const auto &stats = server.getStats();
+  std::cout << "Stopped after " << stats.ticks << " ticks (" << stats.totalTickMs / std::max<uint64_t>(stats.ticks, 1)
+            << " ms average, " << stats.maxTickMs << " ms worst), " << stats.chunksGenerated << " chunks generated, "
+            << stats.chunksLoaded << " loaded, " << stats.chunksSaved << " saved, " << stats.chunksSent << " sent, "
+            << stats.bytesSent / 1024 << " KiB out, " << stats.bytesReceived / 1024 << " KiB in" << std::endl;
+  return EXIT_SUCCESS;
+}
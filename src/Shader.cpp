@@ -1,4 +1,5 @@
 #include "Shader.hpp"
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -15,6 +16,7 @@ Shader::Shader(const std::string &vertexPath, const std::string &fragmentPath) {
   glLinkProgram(program);
 
   checkLinkErrors(program);
+  reflectUniforms();
 
   glDeleteShader(vertexShader);
   glDeleteShader(fragmentShader);
@@ -28,20 +30,41 @@ void Shader::use() const {
   glUseProgram(program);
 }
 
+GLint Shader::getUniformLocation(const std::string &name) const {
+  auto found = uniformLocations.find(name);
+  return found != uniformLocations.end() ? found->second : -1;
+}
+
 void Shader::setBool(const std::string &name, bool value) const {
-  glUniform1i(glGetUniformLocation(program, name.c_str()), static_cast<int>(value));
+  glUniform1i(getUniformLocation(name), static_cast<int>(value));
 }
 
 void Shader::setInt(const std::string &name, int value) const {
-  glUniform1i(glGetUniformLocation(program, name.c_str()), value);
+  glUniform1i(getUniformLocation(name), value);
 }
 
 void Shader::setFloat(const std::string &name, float value) const {
-  glUniform1f(glGetUniformLocation(program, name.c_str()), value);
+  glUniform1f(getUniformLocation(name), value);
+}
+
+void Shader::setVec2(const std::string &name, glm::vec2 value) const {
+  glUniform2fv(getUniformLocation(name), 1, glm::value_ptr(value));
+}
+
+void Shader::setVec3(const std::string &name, glm::vec3 value) const {
+  setVec3(getUniformLocation(name), value);
 }
 
 void Shader::setMat4(const std::string &name, glm::mat4 value) const {
-  glUniformMatrix4fv(glGetUniformLocation(program, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
+  setMat4(getUniformLocation(name), value);
+}
+
+void Shader::setVec3(GLint location, glm::vec3 value) const {
+  glUniform3fv(location, 1, glm::value_ptr(value));
+}
+
+void Shader::setMat4(GLint location, const glm::mat4 &value) const {
+  glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
 GLuint Shader::compileShader(const std::string &path, GLenum type) const {
@@ -92,3 +115,36 @@ void Shader::checkLinkErrors(GLuint programId) const {
     exitGame(EXIT_FAILURE);
   }
 }
+
+void Shader::reflectUniforms() {
+  GLint count = 0;
+  GLint maxLength = 0;
+  glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+  glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+  std::string name(std::max(maxLength, 1), '\0');
+  for (auto i = 0; i < count; ++i) {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    glGetActiveUniform(program, i, static_cast<GLsizei>(name.size()), &length, &size, &type, name.data());
+
+    // Members of uniform blocks have no location and are skipped
+    auto location = glGetUniformLocation(program, name.c_str());
+    if (location < 0) {
+      continue;
+    }
+
+    // Arrays are reported as "name[0]" but set by their plain name
+    std::string uniform(name.data(), length);
+    if (uniform.ends_with("[0]")) {
+      uniform.resize(uniform.size() - 3);
+    }
+    uniformLocations.emplace(std::move(uniform), location);
+  }
+
+  auto cameraBlock = glGetUniformBlockIndex(program, CAMERA_BLOCK_NAME);
+  if (cameraBlock != GL_INVALID_INDEX) {
+    glUniformBlockBinding(program, cameraBlock, CAMERA_BLOCK_BINDING);
+  }
+}
@@ -1,9 +1,14 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include "gl.hpp"
 #include <glm/glm.hpp>
 
+// Uniform blocks shared by every program, attached to fixed binding points when a program is linked
+constexpr const char *CAMERA_BLOCK_NAME = "Camera";
+constexpr GLuint CAMERA_BLOCK_BINDING = 0;
+
 class Shader {
 public:
   Shader(const std::string &vertexPath, const std::string &fragmentPath);
@@ -12,20 +17,35 @@ public:
 
   void use() const;
 
+  // Locations are read once at link time; -1 for a name the program does not use, which the setters ignore
+  [[nodiscard]] GLint getUniformLocation(const std::string &name) const;
+
   void setBool(const std::string &name, bool value) const;
 
   void setInt(const std::string &name, int value) const;
 
   void setFloat(const std::string &name, float value) const;
 
+  void setVec2(const std::string &name, glm::vec2 value) const;
+
+  void setVec3(const std::string &name, glm::vec3 value) const;
+
   void setMat4(const std::string &name, glm::mat4 value) const;
 
+  // For uniforms set many times a frame, with a location looked up beforehand
+  void setVec3(GLint location, glm::vec3 value) const;
+
+  void setMat4(GLint location, const glm::mat4 &value) const;
+
 private:
   GLuint program;
+  std::unordered_map<std::string, GLint> uniformLocations;
 
   [[nodiscard]] GLuint compileShader(const std::string &path, GLenum type) const;
 
   void checkCompileErrors(GLuint shader, const std::string &path) const;
 
   void checkLinkErrors(GLuint programId) const;
+
+  void reflectUniforms();
 };
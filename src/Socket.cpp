@@ -0,0 +1,314 @@
+#include "Socket.hpp"
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+#ifdef _WIN32
+
+using ssize_t = int;
+
+#else
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+
+#endif
+
+namespace {
+  void initializeSockets() {
+#ifdef _WIN32
+    static std::once_flag once;
+    std::call_once(once, []() {
+      WSADATA data;
+      if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+        std::cerr << "Error initializing Winsock" << std::endl;
+      }
+    });
+#endif
+  }
+
+  bool wouldBlock() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+  }
+
+  bool interrupted() {
+#ifdef _WIN32
+    return false;
+#else
+    return errno == EINTR;
+#endif
+  }
+
+  std::string lastError() {
+#ifdef _WIN32
+    return "error " + std::to_string(WSAGetLastError());
+#else
+    return std::strerror(errno);
+#endif
+  }
+
+  void closeHandle(SocketHandle handle) {
+#ifdef _WIN32
+    closesocket(handle);
+#else
+    ::close(handle);
+#endif
+  }
+
+  ptrdiff_t transferResult(ssize_t result) {
+    if (result >= 0) {
+      return result;
+    }
+    return wouldBlock() ? SOCKET_WOULD_BLOCK : SOCKET_FAILED;
+  }
+
+  // MSG_NOSIGNAL keeps a write to a reset connection from raising SIGPIPE on Linux
+#ifdef MSG_NOSIGNAL
+  constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+  constexpr int SEND_FLAGS = 0;
+#endif
+
+  SocketAddress anyAddress(uint16_t port) {
+    SocketAddress address;
+    auto *ipv4 = reinterpret_cast<sockaddr_in *>(&address.storage);
+    ipv4->sin_family = AF_INET;
+    ipv4->sin_addr.s_addr = htonl(INADDR_ANY);
+    ipv4->sin_port = htons(port);
+    address.length = sizeof(sockaddr_in);
+    return address;
+  }
+}
+
+bool SocketAddress::operator==(const SocketAddress &other) const {
+  return length == other.length && std::memcmp(&storage, &other.storage, length) == 0;
+}
+
+uint16_t SocketAddress::getPort() const {
+  if (storage.ss_family != AF_INET) {
+    return 0;
+  }
+  return ntohs(reinterpret_cast<const sockaddr_in *>(&storage)->sin_port);
+}
+
+void SocketAddress::setPort(uint16_t port) {
+  if (storage.ss_family == AF_INET) {
+    reinterpret_cast<sockaddr_in *>(&storage)->sin_port = htons(port);
+  }
+}
+
+std::string SocketAddress::toString() const {
+  if (storage.ss_family != AF_INET) {
+    return "?";
+  }
+
+  char text[INET_ADDRSTRLEN] = {};
+  inet_ntop(AF_INET, &reinterpret_cast<const sockaddr_in *>(&storage)->sin_addr, text, sizeof(text));
+  return std::string(text) + ":" + std::to_string(getPort());
+}
+
+bool SocketAddress::resolve(const std::string &host, uint16_t port, SocketAddress &address) {
+  initializeSockets();
+
+  addrinfo hints{};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+
+  addrinfo *results = nullptr;
+  if (getaddrinfo(host.c_str(), nullptr, &hints, &results) != 0 || results == nullptr) {
+    return false;
+  }
+
+  address = {};
+  std::memcpy(&address.storage, results->ai_addr, results->ai_addrlen);
+  address.length = static_cast<socklen_t>(results->ai_addrlen);
+  address.setPort(port);
+  freeaddrinfo(results);
+  return true;
+}
+
+Socket::Socket(SocketHandle handle) : handle(handle) {
+}
+
+Socket::~Socket() {
+  close();
+}
+
+Socket::Socket(Socket &&other) noexcept : handle(other.handle) {
+  other.handle = INVALID_SOCKET_HANDLE;
+}
+
+Socket &Socket::operator=(Socket &&other) noexcept {
+  if (this != &other) {
+    close();
+    handle = other.handle;
+    other.handle = INVALID_SOCKET_HANDLE;
+  }
+  return *this;
+}
+
+Socket Socket::listenTcp(uint16_t port, int backlog) {
+  initializeSockets();
+
+  Socket socket(::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+  if (!socket.isValid()) {
+    std::cerr << "Error creating TCP socket: " << lastError() << std::endl;
+    return {};
+  }
+
+  int reuse = 1;
+  setsockopt(socket.handle, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+
+  auto address = anyAddress(port);
+  if (bind(socket.handle, reinterpret_cast<const sockaddr *>(&address.storage), address.length) != 0 ||
+      listen(socket.handle, backlog) != 0 || !socket.setNonBlocking()) {
+    std::cerr << "Error listening on TCP port " << port << ": " << lastError() << std::endl;
+    return {};
+  }
+  return socket;
+}
+
+Socket Socket::connectTcp(const SocketAddress &address) {
+  initializeSockets();
+
+  Socket socket(::socket(address.storage.ss_family, SOCK_STREAM, IPPROTO_TCP));
+  if (!socket.isValid()) {
+    std::cerr << "Error creating TCP socket: " << lastError() << std::endl;
+    return {};
+  }
+
+  if (connect(socket.handle, reinterpret_cast<const sockaddr *>(&address.storage), address.length) != 0 ||
+      !socket.setNonBlocking()) {
+    std::cerr << "Error connecting to " << address.toString() << ": " << lastError() << std::endl;
+    return {};
+  }
+  return socket;
+}
+
+Socket Socket::bindUdp(uint16_t port) {
+  initializeSockets();
+
+  Socket socket(::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+  if (!socket.isValid()) {
+    std::cerr << "Error creating UDP socket: " << lastError() << std::endl;
+    return {};
+  }
+
+  auto address = anyAddress(port);
+  if (bind(socket.handle, reinterpret_cast<const sockaddr *>(&address.storage), address.length) != 0 ||
+      !socket.setNonBlocking()) {
+    std::cerr << "Error binding UDP port " << port << ": " << lastError() << std::endl;
+    return {};
+  }
+  return socket;
+}
+
+Socket Socket::accept(SocketAddress *address) const {
+  SocketAddress peer;
+  peer.length = sizeof(peer.storage);
+
+  SocketHandle accepted;
+  do {
+    accepted = ::accept(handle, reinterpret_cast<sockaddr *>(&peer.storage), &peer.length);
+  } while (accepted == INVALID_SOCKET_HANDLE && interrupted());
+
+  if (accepted == INVALID_SOCKET_HANDLE) {
+    return {};
+  }
+
+  Socket socket(accepted);
+  if (!socket.setNonBlocking()) {
+    return {};
+  }
+  if (address) {
+    *address = peer;
+  }
+  return socket;
+}
+
+ptrdiff_t Socket::send(const void *data, size_t size) const {
+  ssize_t result;
+  do {
+    result = ::send(handle, static_cast<const char *>(data), static_cast<int>(size), SEND_FLAGS);
+  } while (result < 0 && interrupted());
+  return transferResult(result);
+}
+
+ptrdiff_t Socket::receive(void *data, size_t size) const {
+  ssize_t result;
+  do {
+    result = ::recv(handle, static_cast<char *>(data), static_cast<int>(size), 0);
+  } while (result < 0 && interrupted());
+
+  // An orderly shutdown by the peer is as final as a reset
+  if (result == 0 && size > 0) {
+    return SOCKET_FAILED;
+  }
+  return transferResult(result);
+}
+
+ptrdiff_t Socket::sendTo(const void *data, size_t size, const SocketAddress &address) const {
+  auto result = ::sendto(handle, static_cast<const char *>(data), static_cast<int>(size), SEND_FLAGS,
+                         reinterpret_cast<const sockaddr *>(&address.storage), address.length);
+  return transferResult(result);
+}
+
+ptrdiff_t Socket::receiveFrom(void *data, size_t size, SocketAddress &address) const {
+  address.length = sizeof(address.storage);
+  auto result = ::recvfrom(handle, static_cast<char *>(data), static_cast<int>(size), 0,
+                           reinterpret_cast<sockaddr *>(&address.storage), &address.length);
+  return transferResult(result);
+}
+
+void Socket::setNoDelay(bool enabled) const {
+  int value = enabled ? 1 : 0;
+  setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void Socket::setBufferSizes(int sendBytes, int receiveBytes) const {
+  setsockopt(handle, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char *>(&sendBytes), sizeof(sendBytes));
+  setsockopt(handle, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char *>(&receiveBytes), sizeof(receiveBytes));
+}
+
+uint16_t Socket::getLocalPort() const {
+  SocketAddress address;
+  address.length = sizeof(address.storage);
+  if (getsockname(handle, reinterpret_cast<sockaddr *>(&address.storage), &address.length) != 0) {
+    return 0;
+  }
+  return address.getPort();
+}
+
+SocketHandle Socket::getHandle() const {
+  return handle;
+}
+
+bool Socket::isValid() const {
+  return handle != INVALID_SOCKET_HANDLE;
+}
+
+void Socket::close() {
+  if (handle != INVALID_SOCKET_HANDLE) {
+    closeHandle(handle);
+    handle = INVALID_SOCKET_HANDLE;
+  }
+}
+
+bool Socket::setNonBlocking() const {
+#ifdef _WIN32
+  u_long enabled = 1;
+  return ioctlsocket(handle, FIONBIO, &enabled) == 0;
+#else
+  auto flags = fcntl(handle, F_GETFL, 0);
+  return flags >= 0 && fcntl(handle, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
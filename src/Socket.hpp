@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef _WIN32
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+using SocketHandle = SOCKET;
+constexpr SocketHandle INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+
+#else
+
+#include <sys/socket.h>
+
+using SocketHandle = int;
+constexpr SocketHandle INVALID_SOCKET_HANDLE = -1;
+
+#endif
+
+// Returned by the transfer calls instead of a byte count
+constexpr ptrdiff_t SOCKET_WOULD_BLOCK = -1;
+constexpr ptrdiff_t SOCKET_FAILED = -2;
+
+struct SocketAddress {
+  sockaddr_storage storage{};
+  socklen_t length = 0;
+
+  [[nodiscard]] bool operator==(const SocketAddress &other) const;
+
+  [[nodiscard]] uint16_t getPort() const;
+
+  void setPort(uint16_t port);
+
+  [[nodiscard]] std::string toString() const;
+
+  // Resolves an IPv4 host name or dotted address; returns false when it cannot be resolved
+  static bool resolve(const std::string &host, uint16_t port, SocketAddress &address);
+};
+
+// Owning, move-only wrapper over a BSD socket. Every socket is switched to non-blocking mode as soon as
+// it is connected, so transfers return SOCKET_WOULD_BLOCK instead of stalling the caller. A peer closing
+// a TCP stream reads as SOCKET_FAILED.
+class Socket {
+public:
+  Socket() = default;
+
+  ~Socket();
+
+  Socket(Socket &&other) noexcept;
+
+  Socket &operator=(Socket &&other) noexcept;
+
+  Socket(const Socket &) = delete;
+
+  Socket &operator=(const Socket &) = delete;
+
+  // Port 0 picks a free port; getLocalPort() reports which one
+  static Socket listenTcp(uint16_t port, int backlog = 512);
+
+  // Connects with a blocking call, then switches to non-blocking mode
+  static Socket connectTcp(const SocketAddress &address);
+
+  static Socket bindUdp(uint16_t port);
+
+  Socket accept(SocketAddress *address = nullptr) const;
+
+  ptrdiff_t send(const void *data, size_t size) const;
+
+  ptrdiff_t receive(void *data, size_t size) const;
+
+  ptrdiff_t sendTo(const void *data, size_t size, const SocketAddress &address) const;
+
+  ptrdiff_t receiveFrom(void *data, size_t size, SocketAddress &address) const;
+
+  void setNoDelay(bool enabled) const;
+
+  void setBufferSizes(int sendBytes, int receiveBytes) const;
+
+  [[nodiscard]] uint16_t getLocalPort() const;
+
+  [[nodiscard]] SocketHandle getHandle() const;
+
+  [[nodiscard]] bool isValid() const;
+
+  void close();
+
+private:
+  SocketHandle handle = INVALID_SOCKET_HANDLE;
+
+  explicit Socket(SocketHandle handle);
+
+  [[nodiscard]] bool setNonBlocking() const;
+};
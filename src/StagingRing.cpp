@@ -0,0 +1,112 @@
+#include "StagingRing.hpp"
+
+StagingRing::StagingRing(GLsizeiptr size) : buffer(0), mapped(nullptr), size(size), head(0) {
+#ifdef PLATFORM_DESKTOP
+  constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+  glBufferStorage(GL_COPY_READ_BUFFER, size, nullptr, flags);
+  mapped = static_cast<uint8_t *>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, size, flags));
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+#endif
+}
+
+StagingRing::~StagingRing() {
+  GLsync deleted = nullptr;
+  for (const auto &region: regions) {
+    if (region.fence != nullptr && region.fence != deleted) {
+      glDeleteSync(region.fence);
+      deleted = region.fence;
+    }
+  }
+
+#ifdef PLATFORM_DESKTOP
+  if (buffer != 0) {
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glUnmapBuffer(GL_COPY_READ_BUFFER);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  }
+#endif
+  glDeleteBuffers(1, &buffer);
+}
+
+bool StagingRing::allocate(GLsizeiptr bytes, GLintptr &offset, void *&pointer) {
+  if (mapped == nullptr || bytes <= 0 || bytes > size) {
+    return false;
+  }
+
+  retire();
+
+  GLintptr begin = head;
+  if (begin + bytes > size) {
+    begin = 0;
+  }
+
+  if (overlaps(begin, begin + bytes)) {
+    return false;
+  }
+
+  if (!regions.empty() && regions.back().fence == nullptr && regions.back().end == begin) {
+    regions.back().end = begin + bytes;
+  } else {
+    regions.push_back({begin, begin + bytes, nullptr});
+  }
+
+  head = begin + bytes;
+  offset = begin;
+  pointer = mapped + begin;
+  return true;
+}
+
+void StagingRing::endFrame() {
+  if (regions.empty() || regions.back().fence != nullptr) {
+    return;
+  }
+
+  // Every region written this frame shares the frame's fence
+  auto fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  for (auto it = regions.rbegin(); it != regions.rend() && it->fence == nullptr; ++it) {
+    it->fence = fence;
+  }
+}
+
+GLuint StagingRing::getBuffer() const {
+  return buffer;
+}
+
+GLsizeiptr StagingRing::getSize() const {
+  return size;
+}
+
+GLsizeiptr StagingRing::getBytesInFlight() const {
+  GLsizeiptr bytes = 0;
+  for (const auto &region: regions) {
+    bytes += region.end - region.begin;
+  }
+  return bytes;
+}
+
+void StagingRing::retire() {
+  while (!regions.empty() && regions.front().fence != nullptr) {
+    auto fence = regions.front().fence;
+    auto status = glClientWaitSync(fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+      return;
+    }
+
+    while (!regions.empty() && regions.front().fence == fence) {
+      regions.pop_front();
+    }
+    glDeleteSync(fence);
+  }
+}
+
+bool StagingRing::overlaps(GLintptr begin, GLintptr end) const {
+  for (const auto &region: regions) {
+    if (begin < region.end && region.begin < end) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include "gl.hpp"
+
+// Persistently mapped upload buffer (GL 4.4+). Writes go straight into mapped memory and are copied
+// into their destination with glCopyBufferSubData; each frame's region is fenced and only reused
+// once the GPU has consumed it, so uploads never block on the driver.
+class StagingRing {
+public:
+  explicit StagingRing(GLsizeiptr size);
+
+  ~StagingRing();
+
+  // Reserves size bytes for this frame; fails instead of waiting when the ring is full
+  [[nodiscard]] bool allocate(GLsizeiptr size, GLintptr &offset, void *&pointer);
+
+  void endFrame();
+
+  [[nodiscard]] GLuint getBuffer() const;
+
+  [[nodiscard]] GLsizeiptr getSize() const;
+
+  [[nodiscard]] GLsizeiptr getBytesInFlight() const;
+
+private:
+  struct Region {
+    GLintptr begin;
+    GLintptr end;
+    GLsync fence;
+  };
+
+  GLuint buffer;
+  uint8_t *mapped;
+  GLsizeiptr size;
+  GLintptr head;
+  std::deque<Region> regions;
+
+  void retire();
+
+  [[nodiscard]] bool overlaps(GLintptr begin, GLintptr end) const;
+};
@@ -0,0 +1,123 @@
+#include "TerrainGenerator.hpp"
+#include <algorithm>
+
+namespace {
+  // The relief noise hashes with its own seed so it does not repeat the detail noise at a larger scale
+  constexpr uint32_t RELIEF_SEED_OFFSET = 0x5BD1E995;
+}
+
+int HeightMap::getFirstSurfaceChunk() const {
+  auto chunk = 0;
+  while (chunk < WORLD_HEIGHT_CHUNKS && lowest > (chunk + 1) * CHUNK_SIZE) {
+    ++chunk;
+  }
+  return chunk;
+}
+
+int HeightMap::getLastSurfaceChunk() const {
+  return std::min(floorDiv(highest - 1, CHUNK_SIZE), WORLD_HEIGHT_CHUNKS - 1);
+}
+
+TerrainGenerator::TerrainGenerator(uint32_t seed, TerrainType type) : seed(seed), type(type) {
+}
+
+void TerrainGenerator::getHeightMap(ColumnPos column, HeightMap &map) const {
+  constexpr auto count = HEIGHT_MAP_SIZE * HEIGHT_MAP_SIZE;
+
+  switch (type) {
+    case TerrainType::Hills: {
+      // Every sample is taken at its own block coordinate rather than stepped from a grid origin, so the
+      // same block gets the same height whichever column's map it lands in
+      float xs[count];
+      float zs[count];
+      float reliefXs[count];
+      float reliefZs[count];
+      for (auto x = 0; x < HEIGHT_MAP_SIZE; ++x) {
+        for (auto z = 0; z < HEIGHT_MAP_SIZE; ++z) {
+          auto i = x * HEIGHT_MAP_SIZE + z;
+          auto blockX = static_cast<float>(column.x * CHUNK_SIZE + x - 1);
+          auto blockZ = static_cast<float>(column.y * CHUNK_SIZE + z - 1);
+          xs[i] = blockX * NOISE_SCALE;
+          zs[i] = blockZ * NOISE_SCALE;
+          reliefXs[i] = blockX * RELIEF_NOISE_SCALE;
+          reliefZs[i] = blockZ * RELIEF_NOISE_SCALE;
+        }
+      }
+
+      float detail[count];
+      float relief[count];
+      fractalNoise2(xs, zs, count, seed, TERRAIN_NOISE, detail);
+      fractalNoise2(reliefXs, reliefZs, count, seed + RELIEF_SEED_OFFSET, RELIEF_NOISE, relief);
+
+      for (auto i = 0; i < count; ++i) {
+        auto detailHeight = (detail[i] + 1.0f) / 2.0f * HEIGHT_SCALE;
+        auto reliefHeight = (relief[i] + 1.0f) / 2.0f * RELIEF_HEIGHT_SCALE;
+        map.heights[i] = std::clamp(TERRAIN_BASE_HEIGHT + static_cast<int>(reliefHeight + detailHeight), 1,
+                                    WORLD_HEIGHT - 1);
+      }
+      break;
+    }
+    case TerrainType::Flat:
+      std::fill_n(map.heights, count, FLAT_TERRAIN_HEIGHT);
+      break;
+    case TerrainType::Checkerboard:
+      // Half the blocks are air, so nothing is ever enclosed; highest is set below
+      std::fill_n(map.heights, count, 0);
+      break;
+  }
+
+  map.lowest = *std::min_element(map.heights, map.heights + count);
+  map.highest = type == TerrainType::Checkerboard ? CHUNK_SIZE : 0;
+  for (auto x = 0; x < CHUNK_SIZE; ++x) {
+    for (auto z = 0; z < CHUNK_SIZE; ++z) {
+      map.highest = std::max(map.highest, map.get(x, z));
+    }
+  }
+}
+
+void TerrainGenerator::generate(ChunkPos position, BlockStorage &blocks) const {
+  HeightMap map;
+  getHeightMap(columnOf(position), map);
+  generate(position, map, blocks);
+}
+
+void TerrainGenerator::generate(ChunkPos position, const HeightMap &map, BlockStorage &blocks) const {
+  BlockId values[CHUNK_VOLUME] = {};
+  auto bottom = position.y * CHUNK_SIZE;
+
+  switch (type) {
+    case TerrainType::Hills:
+    case TerrainType::Flat:
+      for (auto x = 0; x < CHUNK_SIZE; ++x) {
+        for (auto z = 0; z < CHUNK_SIZE; ++z) {
+          auto height = std::min(map.get(x, z) - bottom, CHUNK_SIZE);
+          for (auto y = 0; y < height; ++y) {
+            values[BlockStorage::index(x, y, z)] = TERRAIN_BLOCK;
+          }
+        }
+      }
+      break;
+    case TerrainType::Checkerboard:
+      if (position.y != 0) {
+        break;
+      }
+      for (auto x = 0; x < CHUNK_SIZE; ++x) {
+        for (auto y = 0; y < CHUNK_SIZE; ++y) {
+          for (auto z = 0; z < CHUNK_SIZE; ++z) {
+            values[BlockStorage::index(x, y, z)] = (x + y + z) & 1;
+          }
+        }
+      }
+      break;
+  }
+
+  blocks.assign(values);
+}
+
+uint32_t TerrainGenerator::getSeed() const {
+  return seed;
+}
+
+TerrainType TerrainGenerator::getType() const {
+  return type;
+}
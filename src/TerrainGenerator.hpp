@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include "BlockStorage.hpp"
+#include "Noise.hpp"
+
+constexpr float NOISE_SCALE = 0.1f;
+constexpr float HEIGHT_SCALE = 8.0f;
+constexpr FractalSettings TERRAIN_NOISE{3, 2.0f, 0.5f};
+constexpr int FLAT_TERRAIN_HEIGHT = 4;
+
+// Everything below the surface is made of this
+constexpr BlockId TERRAIN_BLOCK = 1;
+
+// Broad hills and mountains underneath the small-scale noise
+constexpr int TERRAIN_BASE_HEIGHT = 32;
+constexpr float RELIEF_NOISE_SCALE = 0.006f;
+constexpr float RELIEF_HEIGHT_SCALE = 128.0f;
+constexpr FractalSettings RELIEF_NOISE{4, 2.0f, 0.5f};
+
+enum class TerrainType {
+  Hills,
+  Flat,
+  // Alternating solid and air blocks, every face exposed; the worst case for meshing. Fills y = 0 to
+  // CHUNK_SIZE only.
+  Checkerboard
+};
+
+constexpr int HEIGHT_MAP_SIZE = CHUNK_SIZE + 2;
+
+// Surface heights of a column and the ring of blocks around it. Everything below the surface is solid, so
+// this is enough to tell which chunks of the column are worth generating at all.
+struct HeightMap {
+  int heights[HEIGHT_MAP_SIZE * HEIGHT_MAP_SIZE];
+  // Over the whole map, ring included
+  int lowest;
+  // Within the column only
+  int highest;
+
+  // x and z from -1 to CHUNK_SIZE
+  [[nodiscard]] int get(int x, int z) const {
+    return heights[(x + 1) * HEIGHT_MAP_SIZE + z + 1];
+  }
+
+  // Chunks below this are solid and so are all of their neighbours' adjacent blocks, so nothing in them
+  // can ever be seen
+  [[nodiscard]] int getFirstSurfaceChunk() const;
+
+  // Chunks above this are air
+  [[nodiscard]] int getLastSurfaceChunk() const;
+};
+
+// Fills chunks from their position alone, so it is safe to share between worker threads.
+class TerrainGenerator {
+public:
+  explicit TerrainGenerator(uint32_t seed, TerrainType type = TerrainType::Hills);
+
+  void getHeightMap(ColumnPos column, HeightMap &map) const;
+
+  void generate(ChunkPos position, BlockStorage &blocks) const;
+
+  // Generates with a height map already built for the chunk's column
+  void generate(ChunkPos position, const HeightMap &map, BlockStorage &blocks) const;
+
+  [[nodiscard]] uint32_t getSeed() const;
+
+  [[nodiscard]] TerrainType getType() const;
+
+private:
+  uint32_t seed;
+  TerrainType type;
+};
@@ -0,0 +1,886 @@
+#include "World.hpp"
+#include <algorithm>
+#include <cmath>
+#include "Profiler.hpp"
+
+namespace {
+  constexpr int FACE_POSITIVE_Y = 2;
+  constexpr int FACE_NEGATIVE_Y = 3;
+
+  // Chunk offset each face leads to, in FaceMasks order
+  const ChunkPos FACE_OFFSETS[] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+
+  // Culling grid cells without a loaded chunk: air, or a column not loaded yet, lets the search through;
+  // buried chunks do not
+  constexpr int32_t EMPTY_CELL = -1;
+  constexpr int32_t SOLID_CELL = -2;
+
+  constexpr int oppositeFace(int face) {
+    return face ^ 1;
+  }
+}
+
+World::World(uint32_t seed, std::shared_ptr<ChunkArena> arena, ChunkSource source, int renderRadius,
+             unsigned workerCount)
+  : arena(std::move(arena)), terrain(seed), source(source), renderRadius(renderRadius),
+    lightEngine([this](ChunkPos position) { return getLightChunk(position); }), centerChunk(0), centerColumn(0),
+    jobs(std::make_unique<JobSystem>(workerCount)) {
+  solidBlocks.fill(TERRAIN_BLOCK);
+}
+
+World::~World() {
+  saveModifiedChunks();
+  chunks.forEach([](ChunkPos, const std::shared_ptr<Chunk> &chunk) {
+    chunk->cancel();
+  });
+  for (auto &[position, column]: columns) {
+    if (column.cancelled) {
+      column.cancelled->store(true, std::memory_order_relaxed);
+    }
+  }
+  jobs.reset();
+}
+
+void World::update(glm::vec3 cameraPosition, bool isRendering) {
+  PROFILE_ZONE("world update");
+  centerChunk = chunkContaining(glm::ivec3(glm::floor(cameraPosition)));
+  auto cameraColumn = columnOf(centerChunk);
+
+  if (!hasCenter || cameraColumn != centerColumn) {
+    centerColumn = cameraColumn;
+    hasCenter = true;
+    evictDistantColumns();
+    rebuildLoadQueue();
+  }
+
+  auto loads = 0;
+  while (loads < MAX_COLUMN_LOADS_PER_FRAME && !loadQueue.empty()) {
+    auto column = loadQueue.back();
+    loadQueue.pop_back();
+
+    if (!columns.contains(column)) {
+      loadColumn(column);
+      ++loads;
+    }
+  }
+
+  if (jobs->getWorkerCount() == 0) {
+    jobs->runPending(MAX_MAIN_THREAD_JOBS_PER_FRAME);
+  }
+
+  processGeneratedColumns();
+  propagateLight();
+  if (isRendering) {
+    updateLodLevels(cameraPosition);
+    submitMeshJobs();
+    uploadMeshes();
+    arena->endFrame();
+  }
+}
+
+void World::render(const std::shared_ptr<Shader> &shader, const glm::mat4 &viewProjection,
+                   glm::vec3 cameraPosition) {
+  PROFILE_ZONE("render");
+  cullChunks(Frustum(viewProjection), cameraPosition);
+
+  arena->bind();
+  arena->draw(*shader, drawSlots);
+  glBindVertexArray(0);
+}
+
+void World::receiveColumn(ColumnPos column, int firstSurfaceChunk) {
+  columns[column] = {firstSurfaceChunk, true, nullptr};
+  lightEngine.seedColumnBorders(column);
+  markColumnNeighborsDirty(column);
+}
+
+void World::receiveChunk(ChunkPos position, BlockStorage &&blocks) {
+  if (position.y < 0 || position.y >= WORLD_HEIGHT_CHUNKS) {
+    return;
+  }
+
+  auto wasOpenSky = getLightChunk(position).isOpenSky;
+  auto [column, added] = columns.try_emplace(columnOf(position));
+  column->second.ready = true;
+
+  auto chunk = chunks.find(position);
+  if (!chunk) {
+    chunk = std::make_shared<Chunk>(position);
+    chunk->load(std::move(blocks));
+    chunks.insert(position, chunk);
+    lightEngine.addChunk(position, wasOpenSky);
+  } else {
+    // Only the blocks that differ from the copy being replaced change the light
+    auto previous = chunk->getBlocks();
+    chunk->load(std::move(blocks));
+    for (auto index = 0; index < CHUNK_VOLUME; ++index) {
+      if (chunk->getBlocks().get(index) != previous.get(index)) {
+        lightEngine.changeBlock(chunk->getOrigin() + glm::ivec3(index / (CHUNK_SIZE * CHUNK_SIZE),
+                                                                (index / CHUNK_SIZE) % CHUNK_SIZE,
+                                                                index % CHUNK_SIZE));
+      }
+    }
+  }
+  chunk->markDirty();
+  markNeighborsDirty(position);
+}
+
+void World::unloadColumn(ColumnPos column) {
+  if (!columns.contains(column)) {
+    return;
+  }
+
+  removeColumn(column);
+  markColumnNeighborsDirty(column);
+
+  std::erase_if(pendingUploads, [](const MeshResult &result) {
+    return result.chunk->isCancelled();
+  });
+}
+
+void World::applyBlockChanges(ChunkPos position, const std::vector<BlockChange> &changes) {
+  auto chunk = chunks.find(position);
+  if (!chunk || !chunk->isGenerated()) {
+    return;
+  }
+
+  for (const auto &change: changes) {
+    glm::ivec3 local(change.index / (CHUNK_SIZE * CHUNK_SIZE), (change.index / CHUNK_SIZE) % CHUNK_SIZE,
+                     change.index % CHUNK_SIZE);
+    chunk->setBlock(local.x, local.y, local.z, change.block);
+    lightEngine.changeBlock(chunk->getOrigin() + local);
+    markNeighborsDirty(position, local);
+  }
+}
+
+void World::setStorage(std::shared_ptr<RegionStorage> regionStorage) {
+  storage = std::move(regionStorage);
+}
+
+void World::saveModifiedChunks() {
+  chunks.forEach([this](ChunkPos, const std::shared_ptr<Chunk> &chunk) {
+    saveChunk(*chunk);
+  });
+}
+
+BlockId World::getBlock(glm::ivec3 position) const {
+  auto chunkPosition = chunkContaining(position);
+  auto chunk = chunks.find(chunkPosition);
+  if (!chunk) {
+    return isBuried(chunkPosition) ? TERRAIN_BLOCK : 0;
+  }
+
+  auto local = position - chunk->getOrigin();
+  return chunk->getBlock(local.x, local.y, local.z);
+}
+
+bool World::isSolidForMovement(glm::ivec3 position) const {
+  if (position.y < 0) {
+    return true;
+  }
+  if (position.y >= WORLD_HEIGHT) {
+    return false;
+  }
+
+  auto chunkPosition = chunkContaining(position);
+  auto column = columns.find(columnOf(chunkPosition));
+  if (column == columns.end() || !column->second.ready) {
+    return true;
+  }
+
+  auto chunk = chunks.find(chunkPosition);
+  if (!chunk) {
+    return chunkPosition.y < column->second.firstSurfaceChunk;
+  }
+  if (!chunk->isGenerated()) {
+    return true;
+  }
+
+  auto local = position - chunk->getOrigin();
+  return chunk->isLocalSolid(local.x, local.y, local.z);
+}
+
+bool World::setBlock(glm::ivec3 position, BlockId block) {
+  auto chunkPosition = chunkContaining(position);
+  auto column = columns.find(columnOf(chunkPosition));
+  if (position.y < 0 || position.y >= WORLD_HEIGHT || column == columns.end() || !column->second.ready) {
+    return false;
+  }
+
+  auto chunk = chunks.find(chunkPosition);
+  if (!chunk) {
+    if (getBlock(position) == block) {
+      return true;
+    }
+    if (source == ChunkSource::Remote) {
+      return false;
+    }
+    chunk = createSkippedChunk(chunkPosition);
+  }
+
+  auto local = position - chunk->getOrigin();
+  if (!chunk->isGenerated() || chunk->getBlock(local.x, local.y, local.z) == block) {
+    return chunk->isGenerated();
+  }
+
+  chunk->setBlock(local.x, local.y, local.z, block);
+  lightEngine.changeBlock(position);
+  markNeighborsDirty(chunkPosition, local);
+
+  // Digging into a buried chunk's border uncovers its blocks, so it has to exist to be drawn
+  if (block == 0 && source == ChunkSource::Generate) {
+    for (auto offset: FACE_OFFSETS) {
+      auto neighbor = chunkContaining(position + offset);
+      if (neighbor != chunkPosition && !chunks.contains(neighbor) && isBuried(neighbor)) {
+        createSkippedChunk(neighbor);
+      }
+    }
+  }
+  return true;
+}
+
+bool World::raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, RaycastHit &hit) const {
+  if (glm::dot(direction, direction) == 0.0f) {
+    return false;
+  }
+  direction = glm::normalize(direction);
+
+  // Amanatides-Woo: tMax is how far along the ray the next boundary on each axis lies, tDelta how far
+  // apart those boundaries are
+  auto block = glm::ivec3(glm::floor(origin));
+  glm::ivec3 step;
+  glm::vec3 tMax;
+  glm::vec3 tDelta;
+  for (auto axis = 0; axis < 3; ++axis) {
+    step[axis] = direction[axis] > 0.0f ? 1 : direction[axis] < 0.0f ? -1 : 0;
+    tDelta[axis] = step[axis] != 0 ? 1.0f / std::abs(direction[axis]) : INFINITY;
+    auto boundary = step[axis] > 0 ? static_cast<float>(block[axis] + 1) : static_cast<float>(block[axis]);
+    tMax[axis] = step[axis] != 0 ? (boundary - origin[axis]) / direction[axis] : INFINITY;
+  }
+
+  glm::ivec3 normal(0);
+  auto distance = 0.0f;
+  while (distance <= maxDistance) {
+    if (auto id = getBlock(block); id != 0) {
+      hit = {block, normal, distance, id};
+      return true;
+    }
+
+    // Nothing above or below the world to hit once the ray is leaving it
+    if ((block.y >= WORLD_HEIGHT && step.y >= 0) || (block.y < 0 && step.y <= 0)) {
+      return false;
+    }
+
+    auto axis = tMax.x < tMax.y ? (tMax.x < tMax.z ? 0 : 2) : (tMax.y < tMax.z ? 1 : 2);
+    distance = tMax[axis];
+    block[axis] += step[axis];
+    tMax[axis] += tDelta[axis];
+    normal = glm::ivec3(0);
+    normal[axis] = -step[axis];
+  }
+  return false;
+}
+
+std::shared_ptr<Chunk> World::getChunk(ChunkPos position) const {
+  return chunks.find(position);
+}
+
+void World::setRenderRadius(int radius) {
+  renderRadius = std::max(radius, 1);
+  evictDistantColumns();
+  rebuildLoadQueue();
+}
+
+int World::getRenderRadius() const {
+  return renderRadius;
+}
+
+size_t World::getChunkCount() const {
+  return chunks.size();
+}
+
+void World::setMeshingMode(MeshingMode mode) {
+  if (mode == meshingMode) {
+    return;
+  }
+
+  meshingMode = mode;
+  chunks.forEach([](ChunkPos, const std::shared_ptr<Chunk> &chunk) {
+    chunk->markDirty();
+  });
+}
+
+MeshingMode World::getMeshingMode() const {
+  return meshingMode;
+}
+
+MeshStats World::getMeshStats() const {
+  MeshStats stats;
+  chunks.forEach([&stats](ChunkPos, const std::shared_ptr<Chunk> &chunk) {
+    stats += chunk->getMeshStats();
+  });
+  return stats;
+}
+
+void World::setLodEnabled(bool enabled) {
+  lodEnabled = enabled;
+}
+
+bool World::isLodEnabled() const {
+  return lodEnabled;
+}
+
+std::array<LodStats, LOD_LEVEL_COUNT> World::getLodStats() const {
+  std::array<LodStats, LOD_LEVEL_COUNT> stats{};
+  chunks.forEach([&stats](ChunkPos, const std::shared_ptr<Chunk> &chunk) {
+    if (chunk->getDrawSlot() != NO_DRAW_SLOT) {
+      auto &level = stats[chunk->getMeshLodLevel()];
+      ++level.chunks;
+      level.triangles += chunk->getMeshStats().quads * 2;
+    }
+  });
+  return stats;
+}
+
+size_t World::getBlockMemoryUsage() const {
+  size_t bytes = 0;
+  chunks.forEach([&bytes](ChunkPos, const std::shared_ptr<Chunk> &chunk) {
+    bytes += chunk->getBlocks().getMemoryUsage();
+  });
+  return bytes;
+}
+
+const CullStats &World::getCullStats() const {
+  return cullStats;
+}
+
+void World::rebuildLoadQueue() {
+  loadQueue.clear();
+  if (source == ChunkSource::Remote) {
+    return;
+  }
+
+  for (auto dx = -renderRadius; dx <= renderRadius; ++dx) {
+    for (auto dz = -renderRadius; dz <= renderRadius; ++dz) {
+      ColumnPos column = centerColumn + ColumnPos(dx, dz);
+      if (isInRadius(column, renderRadius) && !columns.contains(column)) {
+        loadQueue.push_back(column);
+      }
+    }
+  }
+
+  std::sort(loadQueue.begin(), loadQueue.end(), [this](ColumnPos a, ColumnPos b) {
+    return getPriority(a) > getPriority(b);
+  });
+}
+
+void World::loadColumn(ColumnPos column) {
+  auto cancelled = std::make_shared<std::atomic<bool>>(false);
+  columns[column] = {0, false, cancelled};
+
+  jobs->submit(getPriority(column), [this, column, cancelled, storage = storage]() {
+    PROFILE_ZONE("generate column");
+    if (cancelled->load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    HeightMap map;
+    terrain.getHeightMap(column, map);
+    GeneratedColumn result{column, map.getFirstSurfaceChunk(), {}};
+    auto lastSurfaceChunk = map.getLastSurfaceChunk();
+
+    // Saved chunks come back wherever they are, since an edit may have put blocks in the sky or dug into
+    // buried ground
+    for (auto y = 0; y < WORLD_HEIGHT_CHUNKS; ++y) {
+      ChunkPos position(column.x, y, column.y);
+      BlockStorage blocks;
+      uint32_t version;
+      if (storage && storage->load(position, blocks, version)) {
+        result.chunks.push_back({position, std::move(blocks), std::make_unique<ChunkLight>()});
+      } else if (y >= result.firstSurfaceChunk && y <= lastSurfaceChunk) {
+        terrain.generate(position, map, blocks);
+        result.chunks.push_back({position, std::move(blocks), std::make_unique<ChunkLight>()});
+      }
+    }
+
+    if (cancelled->load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    // Light within the column here, off the main thread; only its borders are left for when it joins the
+    // world, since the columns around it count as unloaded until then
+    LightEngine columnLight([&result](ChunkPos position) {
+      if (position.y >= WORLD_HEIGHT_CHUNKS) {
+        return LightChunk{nullptr, nullptr, true};
+      }
+      if (columnOf(position) != result.position || position.y < 0) {
+        return LightChunk{};
+      }
+      for (auto &chunk: result.chunks) {
+        if (chunk.position.y == position.y) {
+          return LightChunk{&chunk.blocks, chunk.light.get(), false};
+        }
+      }
+      return LightChunk{nullptr, nullptr, position.y >= result.firstSurfaceChunk};
+    });
+    for (const auto &chunk: result.chunks) {
+      columnLight.addChunk(chunk.position, chunk.position.y >= result.firstSurfaceChunk);
+    }
+    columnLight.propagate();
+
+    std::lock_guard lock(completionMutex);
+    generatedColumns.push_back(std::move(result));
+  });
+}
+
+void World::evictDistantColumns() {
+  // Keep one extra ring loaded so walking back and forth over a border does not thrash
+  std::vector<ColumnPos> evicted;
+  for (const auto &[column, state]: columns) {
+    if (!isInRadius(column, renderRadius + 1)) {
+      evicted.push_back(column);
+    }
+  }
+
+  for (auto column: evicted) {
+    removeColumn(column);
+  }
+
+  std::erase_if(pendingUploads, [](const MeshResult &result) {
+    return result.chunk->isCancelled();
+  });
+}
+
+void World::removeColumn(ColumnPos column) {
+  for (auto y = 0; y < WORLD_HEIGHT_CHUNKS; ++y) {
+    ChunkPos position(column.x, y, column.y);
+    if (auto chunk = chunks.find(position)) {
+      saveChunk(*chunk);
+      chunk->cancel();
+      chunks.erase(position);
+    }
+  }
+
+  auto it = columns.find(column);
+  if (it != columns.end() && it->second.cancelled) {
+    it->second.cancelled->store(true, std::memory_order_relaxed);
+  }
+  columns.erase(column);
+}
+
+void World::saveChunk(Chunk &chunk) {
+  if (storage && chunk.isModified()) {
+    storage->save(chunk.getPosition(), chunk.getBlocks(), 0);
+    chunk.clearModified();
+  }
+}
+
+std::shared_ptr<Chunk> World::createSkippedChunk(ChunkPos position) {
+  // Saved chunks were all loaded with the column, so this one has never been saved
+  BlockStorage blocks;
+  terrain.generate(position, blocks);
+
+  // Flagged for saving even while unchanged, so a buried chunk that has been uncovered still exists the
+  // next time its column loads
+  auto wasOpenSky = getLightChunk(position).isOpenSky;
+  auto chunk = std::make_shared<Chunk>(position);
+  chunk->load(std::move(blocks));
+  chunk->markModified();
+  chunks.insert(position, chunk);
+  lightEngine.addChunk(position, wasOpenSky);
+  return chunk;
+}
+
+bool World::isBuried(ChunkPos position) const {
+  if (position.y < 0 || position.y >= WORLD_HEIGHT_CHUNKS) {
+    return false;
+  }
+
+  auto column = columns.find(columnOf(position));
+  return column != columns.end() && column->second.ready && position.y < column->second.firstSurfaceChunk;
+}
+
+LightChunk World::getLightChunk(ChunkPos position) {
+  if (position.y < 0) {
+    return {};
+  }
+  if (position.y >= WORLD_HEIGHT_CHUNKS) {
+    return {nullptr, nullptr, true};
+  }
+
+  auto column = columns.find(columnOf(position));
+  if (column == columns.end() || !column->second.ready) {
+    return {};
+  }
+
+  auto chunk = chunks.find(position);
+  if (!chunk) {
+    return {nullptr, nullptr, position.y >= column->second.firstSurfaceChunk};
+  }
+  if (!chunk->isGenerated()) {
+    return {};
+  }
+  return {&chunk->getBlocks(), &chunk->getLight(), false};
+}
+
+void World::propagateLight() {
+  PROFILE_ZONE("light");
+  lightEngine.propagate();
+  lightEngine.takeDirtyChunks(lightDirtyChunks);
+  for (auto position: lightDirtyChunks) {
+    if (auto chunk = chunks.find(position)) {
+      chunk->markDirty();
+    }
+  }
+}
+
+void World::markNeighborsDirty(ChunkPos position) {
+  for (auto offset: FACE_OFFSETS) {
+    if (auto neighbor = chunks.find(position + offset)) {
+      neighbor->markDirty();
+    }
+  }
+}
+
+void World::markNeighborsDirty(ChunkPos position, glm::ivec3 local) {
+  glm::ivec3 min(0);
+  glm::ivec3 max(0);
+  for (auto axis = 0; axis < 3; ++axis) {
+    min[axis] = local[axis] == 0 ? -1 : 0;
+    max[axis] = local[axis] == CHUNK_SIZE - 1 ? 1 : 0;
+  }
+
+  for (auto dx = min.x; dx <= max.x; ++dx) {
+    for (auto dy = min.y; dy <= max.y; ++dy) {
+      for (auto dz = min.z; dz <= max.z; ++dz) {
+        if (dx == 0 && dy == 0 && dz == 0) {
+          continue;
+        }
+        if (auto neighbor = chunks.find(position + ChunkPos(dx, dy, dz))) {
+          neighbor->markDirty();
+        }
+      }
+    }
+  }
+}
+
+void World::markColumnNeighborsDirty(ColumnPos column) {
+  for (auto dx = -1; dx <= 1; ++dx) {
+    for (auto dz = -1; dz <= 1; ++dz) {
+      for (auto y = 0; y < WORLD_HEIGHT_CHUNKS && (dx != 0 || dz != 0); ++y) {
+        if (auto neighbor = chunks.find({column.x + dx, y, column.y + dz})) {
+          neighbor->markDirty();
+        }
+      }
+    }
+  }
+}
+
+void World::processGeneratedColumns() {
+  PROFILE_ZONE("process columns");
+  std::vector<GeneratedColumn> generated;
+  std::vector<MeshResult> meshed;
+  {
+    std::lock_guard lock(completionMutex);
+    generated.swap(generatedColumns);
+    meshed.swap(meshedChunks);
+  }
+
+  // Columns evicted while their job ran are dropped here
+  for (auto &result: generated) {
+    auto column = columns.find(result.position);
+    if (column == columns.end() || column->second.ready) {
+      continue;
+    }
+
+    column->second = {result.firstSurfaceChunk, true, nullptr};
+    for (auto &generatedChunk: result.chunks) {
+      auto chunk = std::make_shared<Chunk>(generatedChunk.position);
+      chunk->load(std::move(generatedChunk.blocks));
+      chunk->getLight() = *generatedChunk.light;
+      chunks.insert(generatedChunk.position, chunk);
+    }
+    lightEngine.seedColumnBorders(result.position);
+    markColumnNeighborsDirty(result.position);
+  }
+
+  for (auto &result: meshed) {
+    result.chunk->setMeshInFlight(false);
+    if (!result.chunk->isCancelled()) {
+      pendingUploads.push_back(std::move(result));
+    }
+  }
+}
+
+void World::updateLodLevels(glm::vec3 cameraPosition) {
+  chunks.forEach([this, cameraPosition](ChunkPos, const std::shared_ptr<Chunk> &chunk) {
+    auto level = 0;
+    if (lodEnabled) {
+      auto center = glm::vec3(chunk->getOrigin()) + CHUNK_SIZE * 0.5f;
+      auto distance = glm::distance(center, cameraPosition) / CHUNK_SIZE;
+
+      level = chooseLodLevel(chunk->getLodLevel(), distance, renderRadius);
+    }
+    chunk->setLodLevel(level);
+  });
+}
+
+void World::submitMeshJobs() {
+  PROFILE_ZONE("submit meshes");
+  std::vector<std::shared_ptr<Chunk>> dirty;
+  chunks.forEach([&dirty](ChunkPos, const std::shared_ptr<Chunk> &chunk) {
+    if (chunk->needsMesh()) {
+      dirty.push_back(chunk);
+    }
+  });
+
+  std::sort(dirty.begin(), dirty.end(), [this](const std::shared_ptr<Chunk> &a, const std::shared_ptr<Chunk> &b) {
+    return getPriority(a->getPosition()) < getPriority(b->getPosition());
+  });
+
+  if (dirty.size() > MAX_MESH_SUBMITS_PER_FRAME) {
+    dirty.resize(MAX_MESH_SUBMITS_PER_FRAME);
+  }
+
+  for (auto &chunk: dirty) {
+    auto snapshot = std::make_shared<ChunkSnapshot>();
+    createSnapshot(chunk->getPosition(), *snapshot);
+    chunk->setMeshInFlight(true);
+
+    auto priority = getPriority(chunk->getPosition());
+    jobs->submit(priority, [this, chunk, snapshot, priority, mode = meshingMode,
+                            level = chunk->getLodLevel()]() mutable {
+      PROFILE_ZONE("mesh");
+      MeshResult result{std::move(chunk), {}, {}, priority};
+      if (!result.chunk->isCancelled()) {
+        result.data = ChunkMesher(*snapshot, mode, level).build();
+        result.connectivity = ChunkConnectivity(*snapshot);
+      }
+
+      std::lock_guard lock(completionMutex);
+      meshedChunks.push_back(std::move(result));
+    });
+  }
+}
+
+void World::uploadMeshes() {
+  PROFILE_ZONE("uploads");
+  // Nearest chunks first
+  std::sort(pendingUploads.begin(), pendingUploads.end(), [](const MeshResult &a, const MeshResult &b) {
+    return a.priority > b.priority;
+  });
+
+  // The budget is checked before each upload, so the first always goes out and a single mesh larger than
+  // the budget cannot stall the queue
+  size_t uploadedBytes = 0;
+  while (!pendingUploads.empty() && uploadedBytes < UPLOAD_BUDGET_BYTES_PER_FRAME) {
+    auto &result = pendingUploads.back();
+    result.chunk->uploadToGPU(*arena, result.data, result.connectivity);
+    uploadedBytes += std::max(result.data.byteSize(), size_t(1));
+    pendingUploads.pop_back();
+  }
+}
+
+void World::cullChunks(const Frustum &frustum, glm::vec3 cameraPosition) {
+  PROFILE_ZONE("cull");
+  // Loaded chunks never lie beyond the eviction ring, so a fixed grid of cells around the center covers
+  // them all; cells are indexed ((x * gridSide) + z) * WORLD_HEIGHT_CHUNKS + y
+  auto gridRadius = renderRadius + 1;
+  auto gridSide = gridRadius * 2 + 1;
+  auto cellCount = static_cast<size_t>(gridSide * gridSide * WORLD_HEIGHT_CHUNKS);
+  auto gridOrigin = ChunkPos(centerColumn.x - gridRadius, 0, centerColumn.y - gridRadius);
+  auto cellOf = [gridSide, gridOrigin](ChunkPos position) {
+    auto cell = position - gridOrigin;
+    if (cell.x < 0 || cell.x >= gridSide || cell.z < 0 || cell.z >= gridSide || cell.y < 0 ||
+        cell.y >= WORLD_HEIGHT_CHUNKS) {
+      return -1;
+    }
+    return (cell.x * gridSide + cell.z) * WORLD_HEIGHT_CHUNKS + cell.y;
+  };
+
+  cullGrid.assign(cellCount, EMPTY_CELL);
+  cullMinX.resize(cellCount);
+  cullMinY.resize(cellCount);
+  cullMinZ.resize(cellCount);
+  for (auto x = 0; x < gridSide; ++x) {
+    for (auto z = 0; z < gridSide; ++z) {
+      for (auto y = 0; y < WORLD_HEIGHT_CHUNKS; ++y) {
+        auto cell = (x * gridSide + z) * WORLD_HEIGHT_CHUNKS + y;
+        auto origin = glm::vec3((gridOrigin + ChunkPos(x, y, z)) * CHUNK_SIZE);
+        cullMinX[cell] = origin.x;
+        cullMinY[cell] = origin.y;
+        cullMinZ[cell] = origin.z;
+      }
+    }
+  }
+
+  for (const auto &[column, state]: columns) {
+    for (auto y = 0; state.ready && y < state.firstSurfaceChunk; ++y) {
+      if (auto cell = cellOf({column.x, y, column.y}); cell >= 0) {
+        cullGrid[cell] = SOLID_CELL;
+      }
+    }
+  }
+
+  cullCandidates.clear();
+  cullCandidateCells.clear();
+  chunks.forEach([this, &cellOf](ChunkPos position, const std::shared_ptr<Chunk> &chunk) {
+    auto cell = cellOf(position);
+    if (cell >= 0) {
+      cullGrid[cell] = static_cast<int32_t>(cullCandidates.size());
+    }
+    cullCandidates.push_back(chunk.get());
+    cullCandidateCells.push_back(cell);
+  });
+
+  cullInFrustum.resize(cellCount);
+  frustum.cullBoxes(cullMinX.data(), cullMinY.data(), cullMinZ.data(), cellCount, glm::vec3(CHUNK_SIZE),
+                    cullInFrustum.data());
+
+  cullVisited.assign(cellCount, 0);
+  cullQueue.clear();
+
+  auto seedCell = [this](int32_t cell, int8_t entryFace, uint8_t directions) {
+    if (cullInFrustum[cell] && !cullVisited[cell] && cullGrid[cell] != SOLID_CELL) {
+      cullVisited[cell] = 1;
+      cullQueue.push_back({cell, entryFace, directions});
+    }
+  };
+
+  auto seedLayer = [this, gridSide, &seedCell](int y, int8_t entryFace, uint8_t directions) {
+    for (auto column = 0; column < gridSide * gridSide; ++column) {
+      seedCell(column * WORLD_HEIGHT_CHUNKS + y, entryFace, directions);
+    }
+  };
+
+  // Start from the cell holding the camera; from above or below the world every column is entered
+  // through its top or bottom face instead
+  auto cameraCell = cellOf(chunkContaining(glm::ivec3(glm::floor(cameraPosition))));
+  if (cameraPosition.y >= static_cast<float>(WORLD_HEIGHT)) {
+    seedLayer(WORLD_HEIGHT_CHUNKS - 1, FACE_POSITIVE_Y, 1u << FACE_NEGATIVE_Y);
+  } else if (cameraPosition.y < 0.0f) {
+    seedLayer(0, FACE_NEGATIVE_Y, 1u << FACE_POSITIVE_Y);
+  } else if (cameraCell >= 0 && cullGrid[cameraCell] != SOLID_CELL) {
+    cullVisited[cameraCell] = 1;
+    cullQueue.push_back({cameraCell, -1, 0});
+  } else {
+    // Nothing to flood from, so fall back to frustum culling alone
+    for (size_t cell = 0; cell < cellCount; ++cell) {
+      seedCell(static_cast<int32_t>(cell), -1, 0);
+    }
+  }
+
+  floodVisibility();
+
+  drawSlots.clear();
+  cullStats = {};
+  for (const auto &visit : cullQueue) {
+    auto candidate = cullGrid[visit.cell];
+    if (candidate < 0) {
+      continue;
+    }
+    auto slot = cullCandidates[candidate]->getDrawSlot();
+    if (slot != NO_DRAW_SLOT) {
+      drawSlots.push_back(slot);
+    }
+  }
+
+  for (size_t i = 0; i < cullCandidates.size(); ++i) {
+    if (cullCandidates[i]->getDrawSlot() == NO_DRAW_SLOT) {
+      continue;
+    }
+
+    ++cullStats.chunks;
+    auto cell = cullCandidateCells[i];
+    if (cell < 0 || !cullInFrustum[cell]) {
+      ++cullStats.frustumCulled;
+    } else if (!cullVisited[cell]) {
+      ++cullStats.occlusionCulled;
+    }
+  }
+  cullStats.drawn = drawSlots.size();
+}
+
+void World::floodVisibility() {
+  auto gridSide = (renderRadius + 1) * 2 + 1;
+
+  // Breadth-first over cells, so cullQueue ends up roughly front to back. A chunk entered through one face
+  // only lets the search continue through faces its air connects to, and never back towards the camera
+  // along an axis it has already moved away on. Cells without a chunk are open air and connect every face.
+  for (size_t head = 0; head < cullQueue.size(); ++head) {
+    auto visit = cullQueue[head];
+    auto candidate = cullGrid[visit.cell];
+    const auto *connectivity = candidate >= 0 ? &cullCandidates[candidate]->getConnectivity() : nullptr;
+
+    auto y = visit.cell % WORLD_HEIGHT_CHUNKS;
+    auto x = visit.cell / WORLD_HEIGHT_CHUNKS / gridSide;
+    auto z = visit.cell / WORLD_HEIGHT_CHUNKS % gridSide;
+
+    for (auto face = 0; face < 6; ++face) {
+      if ((visit.directions >> oppositeFace(face)) & 1u) {
+        continue;
+      }
+      if (visit.entryFace >= 0 && connectivity != nullptr && !connectivity->connects(visit.entryFace, face)) {
+        continue;
+      }
+
+      auto next = glm::ivec3(x, y, z) + FACE_OFFSETS[face];
+      if (next.x < 0 || next.x >= gridSide || next.z < 0 || next.z >= gridSide || next.y < 0 ||
+          next.y >= WORLD_HEIGHT_CHUNKS) {
+        continue;
+      }
+
+      auto neighbor = (next.x * gridSide + next.z) * WORLD_HEIGHT_CHUNKS + next.y;
+      if (cullVisited[neighbor] || !cullInFrustum[neighbor] || cullGrid[neighbor] == SOLID_CELL) {
+        continue;
+      }
+
+      cullVisited[neighbor] = 1;
+      cullQueue.push_back({neighbor, static_cast<int8_t>(oppositeFace(face)),
+                           static_cast<uint8_t>(visit.directions | (1u << face))});
+    }
+  }
+}
+
+void World::createSnapshot(ChunkPos position, ChunkSnapshot &snapshot) const {
+  const BlockStorage *neighbors[3][3][3];
+  const ChunkLight *lights[3][3][3];
+  uint8_t missingLight[3][3][3];
+  for (auto dx = -1; dx <= 1; ++dx) {
+    for (auto dy = -1; dy <= 1; ++dy) {
+      for (auto dz = -1; dz <= 1; ++dz) {
+        auto neighborPosition = position + ChunkPos(dx, dy, dz);
+        auto chunk = chunks.find(neighborPosition);
+        const BlockStorage *blocks = nullptr;
+        const ChunkLight *light = nullptr;
+        if (chunk && chunk->isGenerated()) {
+          blocks = &chunk->getBlocks();
+          light = &chunk->getLight();
+        } else if (isBuried(neighborPosition)) {
+          blocks = &solidBlocks;
+        }
+        neighbors[dx + 1][dy + 1][dz + 1] = blocks;
+        lights[dx + 1][dy + 1][dz + 1] = light;
+        missingLight[dx + 1][dy + 1][dz + 1] = blocks == &solidBlocks ? 0 : FULL_SKY_LIGHT;
+      }
+    }
+  }
+
+  snapshot.fill(neighbors);
+  snapshot.fillLight(lights, missingLight);
+}
+
+int World::getPriority(ChunkPos position) const {
+  auto delta = position - centerChunk;
+  return delta.x * delta.x + delta.y * delta.y + delta.z * delta.z;
+}
+
+int World::getPriority(ColumnPos column) const {
+  auto delta = column - centerColumn;
+  return delta.x * delta.x + delta.y * delta.y;
+}
+
+bool World::isInRadius(ColumnPos column, int radius) const {
+  auto delta = column - centerColumn;
+  return delta.x * delta.x + delta.y * delta.y <= radius * radius;
+}
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Chunk.hpp"
+#include "ChunkCodec.hpp"
+#include "ChunkMap.hpp"
+#include "ChunkMesher.hpp"
+#include "Frustum.hpp"
+#include "JobSystem.hpp"
+#include "LightEngine.hpp"
+#include "RegionStorage.hpp"
+#include "Shader.hpp"
+#include "TerrainGenerator.hpp"
+
+constexpr int DEFAULT_RENDER_RADIUS = 8;
+constexpr int MAX_COLUMN_LOADS_PER_FRAME = 8;
+constexpr int MAX_MESH_SUBMITS_PER_FRAME = 32;
+constexpr size_t UPLOAD_BUDGET_BYTES_PER_FRAME = 2 * 1024 * 1024;
+constexpr size_t MAX_MAIN_THREAD_JOBS_PER_FRAME = 4;
+
+enum class ChunkSource {
+  // Columns around the camera are generated locally from the seed
+  Generate,
+  // Columns and chunks only arrive through receiveColumn() and receiveChunk(), from a server
+  Remote
+};
+
+struct RaycastHit {
+  glm::ivec3 block;
+  // Face of the block the ray entered through; zero when the ray started inside it
+  glm::ivec3 normal;
+  float distance;
+  BlockId id;
+};
+
+struct CullStats {
+  size_t chunks;
+  size_t frustumCulled;
+  size_t occlusionCulled;
+  size_t drawn;
+};
+
+struct LodStats {
+  size_t chunks;
+  size_t triangles;
+};
+
+// Chunks are loaded a column at a time, but only the chunks of a column that hold part of the surface
+// exist: the ones above it are air and the ones below are solid and enclosed, so neither has anything to
+// draw. Memory and meshing follow the surface area rather than the world's volume.
+class World {
+public:
+  World(uint32_t seed, std::shared_ptr<ChunkArena> arena, ChunkSource source = ChunkSource::Generate,
+        int renderRadius = DEFAULT_RENDER_RADIUS, unsigned workerCount = JobSystem::defaultWorkerCount());
+
+  ~World();
+
+  // Loads, generates and lights the columns around the camera. Meshes are only built and uploaded while
+  // rendering; chunks left dirty meanwhile are meshed once it resumes.
+  void update(glm::vec3 cameraPosition, bool isRendering);
+
+  void render(const std::shared_ptr<Shader> &shader, const glm::mat4 &viewProjection, glm::vec3 cameraPosition);
+
+  // Starts a column produced elsewhere; its chunks that never arrive count as solid below
+  // firstSurfaceChunk and as air above it
+  void receiveColumn(ColumnPos column, int firstSurfaceChunk);
+
+  // Adds or replaces a chunk with blocks produced elsewhere and queues it and its neighbours for meshing
+  void receiveChunk(ChunkPos position, BlockStorage &&blocks);
+
+  void unloadColumn(ColumnPos column);
+
+  void applyBlockChanges(ChunkPos position, const std::vector<BlockChange> &changes);
+
+  // Saved chunks are then loaded in place of generating them, and edited chunks are saved when they are
+  // evicted or saveModifiedChunks() is called. Set it before the first update().
+  void setStorage(std::shared_ptr<RegionStorage> regionStorage);
+
+  // Hands every edited chunk to storage, which writes them in the background
+  void saveModifiedChunks();
+
+  // Air outside the world and in columns that are not loaded
+  [[nodiscard]] BlockId getBlock(glm::ivec3 position) const;
+
+  // Whether a block stops the player. Terrain not loaded or generated yet is solid, as is everything below
+  // the world, so the player waits at its edge instead of falling through
+  [[nodiscard]] bool isSolidForMovement(glm::ivec3 position) const;
+
+  // Edits a loaded column and marks the chunk, plus any neighbour whose border sampling sees the block, for
+  // remeshing. Only flags are set, so any number of edits costs at most one remesh per chunk per frame.
+  // Chunks that were skipped as air or buried are created on demand, including buried ones an edit
+  // uncovers. Returns false when the block is outside the world or its column is not loaded.
+  bool setBlock(glm::ivec3 position, BlockId block);
+
+  // Walks the blocks along the ray in order and reports the first solid one within maxDistance
+  bool raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, RaycastHit &hit) const;
+
+  [[nodiscard]] std::shared_ptr<Chunk> getChunk(ChunkPos position) const;
+
+  void setRenderRadius(int radius);
+
+  [[nodiscard]] int getRenderRadius() const;
+
+  [[nodiscard]] size_t getChunkCount() const;
+
+  void setMeshingMode(MeshingMode mode);
+
+  [[nodiscard]] MeshingMode getMeshingMode() const;
+
+  [[nodiscard]] MeshStats getMeshStats() const;
+
+  // When disabled every chunk is meshed at full resolution
+  void setLodEnabled(bool enabled);
+
+  [[nodiscard]] bool isLodEnabled() const;
+
+  // Meshed chunks and their triangles, by the level their current mesh was built at
+  [[nodiscard]] std::array<LodStats, LOD_LEVEL_COUNT> getLodStats() const;
+
+  [[nodiscard]] size_t getBlockMemoryUsage() const;
+
+  [[nodiscard]] const CullStats &getCullStats() const;
+
+private:
+  struct Column {
+    int firstSurfaceChunk = 0;
+    // False while the column is still being generated
+    bool ready = false;
+    // Set when the column is evicted, so its generation job stops early; only columns loaded here have one
+    std::shared_ptr<std::atomic<bool>> cancelled;
+  };
+
+  struct GeneratedChunk {
+    ChunkPos position;
+    BlockStorage blocks;
+    // Lit on the worker as if the columns around were not loaded
+    std::unique_ptr<ChunkLight> light;
+  };
+
+  struct GeneratedColumn {
+    ColumnPos position;
+    int firstSurfaceChunk;
+    std::vector<GeneratedChunk> chunks;
+  };
+
+  struct MeshResult {
+    std::shared_ptr<Chunk> chunk;
+    MeshData data;
+    ChunkConnectivity connectivity;
+    int priority;
+  };
+
+  struct CullVisit {
+    int32_t cell;
+    int8_t entryFace;
+    uint8_t directions;
+  };
+
+  // Declared before the chunks, which release their arena ranges on destruction
+  std::shared_ptr<ChunkArena> arena;
+
+  ChunkMap chunks;
+  std::unordered_map<ColumnPos, Column, ColumnPosHash> columns;
+  TerrainGenerator terrain;
+  std::shared_ptr<RegionStorage> storage;
+  ChunkSource source;
+  int renderRadius;
+  MeshingMode meshingMode = MeshingMode::Naive;
+  bool lodEnabled = true;
+
+  // Stands in for buried chunks in snapshots, so their neighbours do not mesh faces against them
+  BlockStorage solidBlocks;
+
+  // Light is kept up to date on the main thread, where the chunks change; edits only queue work, which is
+  // done once per update() before meshing
+  LightEngine lightEngine;
+  std::vector<ChunkPos> lightDirtyChunks;
+
+  ChunkPos centerChunk;
+  ColumnPos centerColumn;
+  bool hasCenter = false;
+
+  // Columns still to load around centerColumn, farthest first so the nearest is popped from the back
+  std::vector<ColumnPos> loadQueue;
+
+  // Filled by worker threads, drained on the main thread
+  std::mutex completionMutex;
+  std::vector<GeneratedColumn> generatedColumns;
+  std::vector<MeshResult> meshedChunks;
+
+  std::vector<MeshResult> pendingUploads;
+
+  // Culling scratch, rebuilt every frame. cullGrid covers every chunk position of the loaded columns around
+  // centerColumn, holding an index into cullCandidates or one of the cell constants; cell boxes are kept in
+  // SoA form for Frustum::cullBoxes.
+  std::vector<Chunk *> cullCandidates;
+  std::vector<int32_t> cullCandidateCells;
+  std::vector<float> cullMinX;
+  std::vector<float> cullMinY;
+  std::vector<float> cullMinZ;
+  std::vector<uint8_t> cullInFrustum;
+  std::vector<uint8_t> cullVisited;
+  std::vector<int32_t> cullGrid;
+  std::vector<CullVisit> cullQueue;
+  std::vector<uint32_t> drawSlots;
+  CullStats cullStats{};
+
+  // Declared last so workers are joined before anything they write to is destroyed
+  std::unique_ptr<JobSystem> jobs;
+
+  void rebuildLoadQueue();
+
+  void loadColumn(ColumnPos column);
+
+  void evictDistantColumns();
+
+  // Saves and drops every chunk of the column, leaving neighbours as they are
+  void removeColumn(ColumnPos column);
+
+  void saveChunk(Chunk &chunk);
+
+  // Generates a chunk its column skipped as air or buried; Generate mode only
+  std::shared_ptr<Chunk> createSkippedChunk(ChunkPos position);
+
+  // Whether a chunk that does not exist counts as solid: below its column's surface or below the world
+  [[nodiscard]] bool isBuried(ChunkPos position) const;
+
+  [[nodiscard]] LightChunk getLightChunk(ChunkPos position);
+
+  // Runs the queued light updates and remeshes the chunks whose light changed
+  void propagateLight();
+
+  void markNeighborsDirty(ChunkPos position);
+
+  // Marks the neighbours, diagonals included, that sample the block at local of this chunk
+  void markNeighborsDirty(ChunkPos position, glm::ivec3 local);
+
+  // Every chunk of the columns around, whose borders change once this column is known
+  void markColumnNeighborsDirty(ColumnPos column);
+
+  void processGeneratedColumns();
+
+  void updateLodLevels(glm::vec3 cameraPosition);
+
+  void submitMeshJobs();
+
+  void uploadMeshes();
+
+  void cullChunks(const Frustum &frustum, glm::vec3 cameraPosition);
+
+  void floodVisibility();
+
+  void createSnapshot(ChunkPos position, ChunkSnapshot &snapshot) const;
+
+  [[nodiscard]] int getPriority(ChunkPos position) const;
+
+  [[nodiscard]] int getPriority(ColumnPos column) const;
+
+  [[nodiscard]] bool isInRadius(ColumnPos column, int radius) const;
+};
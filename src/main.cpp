@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 
 #ifdef PLATFORM_WEB
@@ -7,30 +8,89 @@
 
 #elif PLATFORM_DESKTOP
 
+// Winsock 2 has to come before windows.h, which otherwise pulls in the old winsock.h
+#include <winsock2.h>
 #include <windows.h>
+#include "NetworkClient.hpp"
 
 #endif
 
 #include "gl.hpp"
-#include "Chunk.hpp"
+#include "World.hpp"
 #include "Shader.hpp"
+#include "CameraUniforms.hpp"
 #include "Exit.hpp"
 #include "glm/ext/matrix_clip_space.hpp"
 #include "glm/ext/matrix_transform.hpp"
 #include "Input.hpp"
 #include "Camera.hpp"
+#include "PlayerMovement.hpp"
+#include "FrameGraph.hpp"
+#include "GpuTimer.hpp"
+#include "Profiler.hpp"
 #include <SDL2/SDL.h>
 
 bool isGameRunning = true;
 SDL_Window *window = nullptr;
 SDL_GLContext gl_context;
-std::shared_ptr<Chunk> chunk;
+std::shared_ptr<World> world;
+std::shared_ptr<ChunkArena> chunkArena;
 std::shared_ptr<Shader> standardShader;
 std::shared_ptr<Shader> simpleShader;
+std::shared_ptr<CameraUniforms> cameraUniforms;
 std::shared_ptr<Input> input;
 std::shared_ptr<Camera> camera;
 int windowWidth, windowHeight;
 
+#ifdef PLATFORM_DESKTOP
+std::string serverHost;
+uint16_t serverPort = DEFAULT_SERVER_PORT;
+std::shared_ptr<NetworkClient> networkClient;
+
+// Connected, the player moves by predicted inputs the server replays, and other players play back from its
+// snapshots
+std::shared_ptr<MovementPredictor> movementPredictor;
+std::shared_ptr<RemotePlayers> remotePlayers;
+std::vector<PlayerInput> recentInputs;
+std::vector<RemotePlayer> visiblePlayers;
+GLuint playerVAO, playerVBO;
+
+// Single-player worlds are kept here; edited chunks are saved this often and on exit
+constexpr double AUTOSAVE_INTERVAL_SECONDS = 30.0;
+std::string worldDirectory = "world";
+std::shared_ptr<RegionStorage> regionStorage;
+double autosaveTimer = 0;
+
+// Frames wait for vsync unless it is turned off, and are held to frameCap per second when that is set. With
+// rendering off, by --no-render or while the window is minimized, the loop only runs the simulation and
+// sleeps between movement steps instead of spinning.
+bool isVsyncEnabled = true;
+int frameCap = 0;
+bool isRenderingRequested = true;
+bool isWindowMinimized = false;
+Uint64 nextFrameCounter = 0;
+#endif
+
+#ifdef NETBLOCKS_PROFILER
+// F4 shows the frame graph, F5 starts and stops a trace capture written here
+constexpr const char *TRACE_PATH = "netblocks-trace.json";
+std::shared_ptr<GpuTimer> gpuTimer;
+std::shared_ptr<FrameGraph> frameGraph;
+bool isFrameGraphVisible = false;
+#endif
+
+// Above the highest mountains, so the camera starts with the terrain in view; the player waits there until
+// the terrain below has loaded, then falls onto it
+constexpr float SPAWN_HEIGHT = 180.0f;
+
+// Movement steps are taken at MOVEMENT_TICK_RATE whatever the frame rate, with the same collision the
+// server uses, and the camera is drawn between the last two steps; F toggles flying
+constexpr double MAX_MOVEMENT_BACKLOG_SECONDS = 0.25;
+PlayerState player;
+PlayerState previousPlayer;
+double movementAccumulator = 0;
+bool isFlying = false;
+
 bool isMouseLocked = false;
 GLuint squareVAO, squareVBO, squareEBO;
 
@@ -83,17 +143,345 @@ Uint64 NOW = SDL_GetPerformanceCounter();
 Uint64 LAST = 0;
 double deltaTime = 0;
 
-void mainLoop() {
-  if (!isGameRunning) {
-    exitGame(EXIT_SUCCESS);
+bool isSolidForMovement(glm::ivec3 block) {
+  return world->isSolidForMovement(block);
+}
+
+#ifdef PLATFORM_DESKTOP
+
+void parseArguments(int count, char *arguments[]) {
+  for (auto i = 1; i < count; ++i) {
+    std::string argument = arguments[i];
+    if (argument == "--connect" && i + 1 < count) {
+      serverHost = arguments[++i];
+      if (auto colon = serverHost.rfind(':'); colon != std::string::npos) {
+        serverPort = static_cast<uint16_t>(std::stoi(serverHost.substr(colon + 1)));
+        serverHost.resize(colon);
+      }
+    } else if (argument == "--world" && i + 1 < count) {
+      worldDirectory = arguments[++i];
+    } else if (argument == "--fps" && i + 1 < count) {
+      frameCap = std::max(std::stoi(arguments[++i]), 0);
+    } else if (argument == "--no-vsync") {
+      isVsyncEnabled = false;
+    } else if (argument == "--no-render") {
+      isRenderingRequested = false;
+    } else {
+      std::cerr << "Unknown argument " << argument << " (usage: NetBlocks [--connect host[:port]] [--world directory]"
+                << " [--fps cap] [--no-vsync] [--no-render])" << std::endl;
+    }
   }
+}
 
-  LAST = NOW;
-  NOW = SDL_GetPerformanceCounter();
-  deltaTime = (double) ((NOW - LAST) * 1000 / (double) SDL_GetPerformanceFrequency()) / 1000.0;
+void connectToServer() {
+  networkClient = std::make_shared<NetworkClient>();
+  networkClient->setColumnReceivedHandler([](ColumnPos position, int firstSurfaceChunk) {
+    world->receiveColumn(position, firstSurfaceChunk);
+  });
+  networkClient->setChunkReceivedHandler([](ChunkPos position, BlockStorage &&blocks) {
+    world->receiveChunk(position, std::move(blocks));
+  });
+  networkClient->setColumnUnloadedHandler([](ColumnPos position) {
+    world->unloadColumn(position);
+  });
+  networkClient->setBlockChangesHandler([](ChunkPos position, const std::vector<BlockChange> &changes) {
+    world->applyBlockChanges(position, changes);
+  });
+  networkClient->setPlayerStatesHandler([](const PlayerStatesMessage &message) {
+    movementPredictor->reconcile(message.lastInput, message.state);
+    remotePlayers->addSnapshot(message.tick, message.players, message.removed);
+  });
+
+  movementPredictor = std::make_shared<MovementPredictor>(isSolidForMovement, player);
+  remotePlayers = std::make_shared<RemotePlayers>();
+
+  if (!networkClient->connect(serverHost, serverPort, world->getRenderRadius(), camera->position)) {
+    std::cerr << "Error connecting to " << serverHost << ":" << serverPort << std::endl;
+    exitGame(EXIT_FAILURE);
+  }
+  std::cout << "Connected to " << serverHost << ":" << serverPort << std::endl;
+}
+
+void updateNetwork() {
+  PROFILE_ZONE("network");
+
+  if (!networkClient->poll()) {
+    std::cerr << "Lost connection to the server" << std::endl;
+    isGameRunning = false;
+    return;
+  }
+
+  if (networkClient->isWelcomed()) {
+    remotePlayers->advance(deltaTime, networkClient->getWelcome().tickRate);
+  }
+}
+
+void initPlayerBox() {
+  // The collision box around the player's eye position
+  constexpr float HALF_WIDTH = PLAYER_HALF_WIDTH;
+  constexpr float BOTTOM = -PLAYER_EYE_HEIGHT;
+  constexpr float TOP = PLAYER_HEIGHT - PLAYER_EYE_HEIGHT;
+
+  std::vector<float> boxVertices;
+  auto corner = [&](int x, int y, int z) {
+    boxVertices.insert(boxVertices.end(),
+                       {x ? HALF_WIDTH : -HALF_WIDTH, y ? TOP : BOTTOM, z ? HALF_WIDTH : -HALF_WIDTH});
+  };
+  // Two triangles for each of the six faces
+  const int faces[6][4][3] = {
+    {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}}, {{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}},
+    {{0, 0, 0}, {0, 1, 0}, {0, 1, 1}, {0, 0, 1}}, {{1, 0, 0}, {1, 1, 0}, {1, 1, 1}, {1, 0, 1}},
+    {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}}, {{0, 1, 0}, {1, 1, 0}, {1, 1, 1}, {0, 1, 1}}
+  };
+  for (const auto &face: faces) {
+    for (auto i: {0, 1, 2, 0, 2, 3}) {
+      corner(face[i][0], face[i][1], face[i][2]);
+    }
+  }
+
+  glGenVertexArrays(1, &playerVAO);
+  glGenBuffers(1, &playerVBO);
+  glBindVertexArray(playerVAO);
+  glBindBuffer(GL_ARRAY_BUFFER, playerVBO);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(boxVertices.size() * sizeof(float)), boxVertices.data(),
+               GL_STATIC_DRAW);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), nullptr);
+  glEnableVertexAttribArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+}
+
+void renderRemotePlayers() {
+  remotePlayers->sample(visiblePlayers);
+  if (visiblePlayers.empty()) {
+    return;
+  }
+
+  simpleShader->use();
+  auto offset = simpleShader->getUniformLocation("offset");
+  glBindVertexArray(playerVAO);
+  for (const auto &player: visiblePlayers) {
+    simpleShader->setVec3(offset, player.position);
+    glDrawArrays(GL_TRIANGLES, 0, 36);
+  }
+  glBindVertexArray(0);
+}
+
+void openWorld() {
+  regionStorage = std::make_shared<RegionStorage>(worldDirectory);
+
+  uint32_t seed;
+  if (!regionStorage->loadSeed(seed)) {
+    seed = time(nullptr) % 1000;
+    regionStorage->saveSeed(seed);
+  }
+  std::cout << "Opened " << worldDirectory << " (seed " << seed << ")" << std::endl;
+
+  world = std::make_shared<World>(seed, chunkArena);
+  world->setStorage(regionStorage);
+}
+
+void updateAutosave() {
+  autosaveTimer += deltaTime;
+  if (autosaveTimer >= AUTOSAVE_INTERVAL_SECONDS) {
+    world->saveModifiedChunks();
+    autosaveTimer = 0;
+  }
+}
+
+void saveWorld() {
+  world->saveModifiedChunks();
+  regionStorage->flush();
+}
+
+bool isRendering() {
+  return isRenderingRequested && !isWindowMinimized;
+}
+
+void setVsync(bool enabled) {
+  if (SDL_GL_SetSwapInterval(enabled ? 1 : 0) != 0) {
+    std::cerr << "Error " << (enabled ? "enabling" : "disabling") << " vsync: " << SDL_GetError() << std::endl;
+    return;
+  }
+  isVsyncEnabled = enabled;
+}
+
+// Sleeps until the next frame is due, if anything limits the frame rate besides vsync. SDL_Delay only
+// sleeps whole milliseconds and can overshoot, so the last one is waited out on the performance counter.
+void paceFrame() {
+  PROFILE_ZONE("pacing");
+
+  auto period = isRendering() ? (frameCap > 0 ? 1.0 / frameCap : 0.0) : MOVEMENT_TICK_SECONDS;
+  if (period <= 0.0) {
+    return;
+  }
+
+  auto frequency = SDL_GetPerformanceFrequency();
+  auto periodCounts = static_cast<Uint64>(period * static_cast<double>(frequency));
+  auto now = SDL_GetPerformanceCounter();
+  // A frame that ran long moves the schedule instead of being caught up with a burst of short ones
+  if (nextFrameCounter == 0 || now > nextFrameCounter + periodCounts) {
+    nextFrameCounter = now;
+  }
+  nextFrameCounter += periodCounts;
+
+  while (now < nextFrameCounter) {
+    auto remainingMs = (nextFrameCounter - now) * 1000 / frequency;
+    if (remainingMs > 1) {
+      SDL_Delay(static_cast<Uint32>(remainingMs - 1));
+    }
+    now = SDL_GetPerformanceCounter();
+  }
+}
+
+#endif
+
+uint8_t readMovementButtons() {
+  uint8_t buttons = isFlying ? INPUT_FLY : 0;
+  if (!isMouseLocked) {
+    return buttons;
+  }
+
+  buttons |= input->isKey(SDL_SCANCODE_W) ? INPUT_FORWARD : 0;
+  buttons |= input->isKey(SDL_SCANCODE_S) ? INPUT_BACK : 0;
+  buttons |= input->isKey(SDL_SCANCODE_A) ? INPUT_LEFT : 0;
+  buttons |= input->isKey(SDL_SCANCODE_D) ? INPUT_RIGHT : 0;
+  buttons |= input->isKey(SDL_SCANCODE_LCTRL) ? INPUT_SPRINT : 0;
+  buttons |= input->isKey(SDL_SCANCODE_SPACE) ? INPUT_JUMP : 0;
+  return buttons;
+}
+
+void stepMovement() {
+  auto buttons = readMovementButtons();
+  previousPlayer = player;
+#ifdef PLATFORM_DESKTOP
+  // Every step is applied here straight away and sent in a datagram of its own, along with the few before it
+  // in case some are lost
+  if (networkClient) {
+    movementPredictor->predict(buttons, camera->yaw, camera->pitch);
+    movementPredictor->getRecentInputs(INPUTS_PER_DATAGRAM, recentInputs);
+    networkClient->sendInputs(recentInputs);
+    player = movementPredictor->getState();
+    return;
+  }
+#endif
+  player = simulateMovement(player, {0, buttons, camera->yaw, camera->pitch}, isSolidForMovement);
+}
+
+void updateMovement() {
+  PROFILE_ZONE("movement");
+
+#ifdef PLATFORM_DESKTOP
+  // Inputs sent before the welcome would be dropped, so steps wait for it
+  if (networkClient && !networkClient->isWelcomed()) {
+    return;
+  }
+#endif
+
+  movementAccumulator = std::min(movementAccumulator + deltaTime, MAX_MOVEMENT_BACKLOG_SECONDS);
+  while (movementAccumulator >= MOVEMENT_TICK_SECONDS) {
+    stepMovement();
+    movementAccumulator -= MOVEMENT_TICK_SECONDS;
+  }
+
+#ifdef PLATFORM_DESKTOP
+  // Reconciling may have moved the prediction without a step
+  if (networkClient) {
+    player = movementPredictor->getState();
+  }
+#endif
+  auto blend = static_cast<float>(movementAccumulator / MOVEMENT_TICK_SECONDS);
+  camera->position = glm::mix(previousPlayer.position, player.position, blend);
+}
+
+constexpr float REACH_DISTANCE = 8.0f;
+constexpr int EXPLOSION_RADIUS = 6;
+constexpr BlockId PLACED_BLOCK = 1;
+
+void changeBlock(glm::ivec3 position, BlockId block) {
+#ifdef PLATFORM_DESKTOP
+  // The server owns a remote world; the edit shows up once its BlockChanges come back
+  if (networkClient) {
+    networkClient->sendSetBlock(position, block);
+    return;
+  }
+#endif
+  world->setBlock(position, block);
+}
+
+// Left click breaks the targeted block, right click places one against it, a lamp with shift held, and
+// middle click blows up everything around it
+void editBlocks() {
+  RaycastHit hit;
+  if (!world->raycast(camera->position, camera->front, REACH_DISTANCE, hit)) {
+    return;
+  }
+
+  if (input->isMouseButtonDown(SDL_BUTTON_LEFT)) {
+    changeBlock(hit.block, 0);
+  } else if (input->isMouseButtonDown(SDL_BUTTON_RIGHT)) {
+    auto target = hit.block + hit.normal;
+    if (hit.normal != glm::ivec3(0) && !overlapsPlayer(player.position, target)) {
+      changeBlock(target, input->isKey(SDL_SCANCODE_LSHIFT) ? LAMP_BLOCK : PLACED_BLOCK);
+    }
+  } else if (input->isMouseButtonDown(SDL_BUTTON_MIDDLE)) {
+    for (auto dx = -EXPLOSION_RADIUS; dx <= EXPLOSION_RADIUS; ++dx) {
+      for (auto dy = -EXPLOSION_RADIUS; dy <= EXPLOSION_RADIUS; ++dy) {
+        for (auto dz = -EXPLOSION_RADIUS; dz <= EXPLOSION_RADIUS; ++dz) {
+          auto position = hit.block + glm::ivec3(dx, dy, dz);
+          if (dx * dx + dy * dy + dz * dz <= EXPLOSION_RADIUS * EXPLOSION_RADIUS && world->getBlock(position) != 0) {
+            changeBlock(position, 0);
+          }
+        }
+      }
+    }
+  }
+}
+
+#ifdef NETBLOCKS_PROFILER
+
+// Per-frame averages over the profiler's history, each zone named with its frame graph colour
+void printProfile() {
+  const auto &profiler = Profiler::get();
+  const auto &history = profiler.getHistory();
+  if (history.empty()) {
+    return;
+  }
+
+  auto frames = static_cast<double>(history.size());
+  double frameTime = 0;
+  for (const auto &frame: history) {
+    frameTime += static_cast<double>(frame.duration);
+  }
+  std::cout << frameTime / frames / 1e6 << " ms per frame over the last " << history.size() << " frames, "
+            << profiler.getDroppedEvents() << " zone events dropped" << std::endl;
+
+  for (size_t zone = 0; zone < profiler.getZoneCount() && zone < PROFILER_MAX_ZONES; ++zone) {
+    double mainThread = 0;
+    double workers = 0;
+    double gpu = 0;
+    for (const auto &frame: history) {
+      mainThread += static_cast<double>(frame.mainThread[zone]);
+      workers += static_cast<double>(frame.workers[zone]);
+      gpu += static_cast<double>(frame.gpu[zone]);
+    }
+
+    std::cout << "  " << profiler.getZoneName(zone) << " (" << FrameGraph::getZoneColorName(zone) << "): "
+              << mainThread / frames / 1e6 << " ms main thread, " << workers / frames / 1e6 << " ms workers, "
+              << gpu / frames / 1e6 << " ms GPU" << std::endl;
+  }
+}
+
+#endif
+
+void processInput() {
+  PROFILE_ZONE("input");
 
   input->update();
 
+  // The click that captures the mouse should not also edit
+  auto wasMouseLocked = isMouseLocked;
+
   SDL_Event event;
   while (SDL_PollEvent(&event)) {
     SDL_PumpEvents();
@@ -109,6 +497,12 @@ void mainLoop() {
       SDL_GetWindowSize(window, &windowWidth, &windowHeight);
 
       glViewport(0, 0, windowWidth, windowHeight);
+#ifdef PLATFORM_DESKTOP
+    } else if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_MINIMIZED) {
+      isWindowMinimized = true;
+    } else if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_RESTORED) {
+      isWindowMinimized = false;
+#endif
     }
   }
 
@@ -119,39 +513,184 @@ void mainLoop() {
   }
 #endif
 
+  if (input->isKeyDown(SDL_SCANCODE_G)) {
+    auto greedy = world->getMeshingMode() != MeshingMode::Greedy;
+    world->setMeshingMode(greedy ? MeshingMode::Greedy : MeshingMode::Naive);
+
+    auto stats = world->getMeshStats();
+    std::cout << "Greedy meshing " << (greedy ? "enabled, merging evenly shaded faces only" : "disabled")
+              << " (last meshes: " << stats.quads << " quads for " << stats.naiveQuads << " faces)" << std::endl;
+  }
+
+  if (input->isKeyDown(SDL_SCANCODE_F)) {
+    isFlying = !isFlying;
+    std::cout << "Flying " << (isFlying ? "enabled" : "disabled") << std::endl;
+  }
+
+#ifdef PLATFORM_DESKTOP
+  if (input->isKeyDown(SDL_SCANCODE_V)) {
+    setVsync(!isVsyncEnabled);
+    std::cout << "Vsync " << (isVsyncEnabled ? "enabled" : "disabled") << std::endl;
+  }
+#endif
+
+  if (input->isKeyDown(SDL_SCANCODE_L)) {
+    world->setLodEnabled(!world->isLodEnabled());
+    std::cout << "Level of detail " << (world->isLodEnabled() ? "enabled" : "disabled") << std::endl;
+  }
+
+  if (input->isKeyDown(SDL_SCANCODE_F3)) {
+    auto stats = chunkArena->getStats();
+    std::cout << world->getChunkCount() << " chunks, vertex arena " << stats.vertexBytesUsed / 1024 << "/"
+              << stats.vertexBytesCapacity / 1024 << " KiB, index arena " << stats.indexBytesUsed / 1024 << "/"
+              << stats.indexBytesCapacity / 1024 << " KiB, largest free vertex block "
+              << stats.largestFreeVertexBytes / 1024 << " KiB, " << stats.allocations << " allocations, "
+              << stats.stagingBytesInFlight / 1024 << " KiB staging in flight, " << stats.uploadedBytes / 1024
+              << " KiB uploaded, " << stats.drawSlots << " draw slots in " << stats.drawCalls << " draw calls"
+              << std::endl;
+    std::cout << world->getBlockMemoryUsage() / 1024 << " KiB of block storage" << std::endl;
+    auto cull = world->getCullStats();
+    std::cout << cull.drawn << "/" << cull.chunks << " chunks drawn, " << cull.frustumCulled << " outside the frustum, "
+              << cull.occlusionCulled << " occluded" << std::endl;
+    auto lods = world->getLodStats();
+    for (auto level = 0; level < LOD_LEVEL_COUNT; ++level) {
+      std::cout << "LOD " << level << " (" << (1 << level) << "x): " << lods[level].chunks << " chunks, "
+                << lods[level].triangles << " triangles" << std::endl;
+    }
+#ifdef PLATFORM_DESKTOP
+    if (networkClient) {
+      auto network = networkClient->getStats();
+      std::cout << network.columnsReceived << " columns received, " << network.chunksReceived << " chunks, "
+                << network.columnsUnloaded << " columns unloaded, "
+                << network.blockChangeBatches << " block change batches, " << network.resyncs << " resyncs, "
+                << network.bytesReceived / 1024 << " KiB in, " << network.bytesSent / 1024 << " KiB out, server tick "
+                << network.serverTick << std::endl;
+      auto prediction = movementPredictor->getStats();
+      std::cout << prediction.predicted << " inputs predicted, " << prediction.reconciled << " server states, "
+                << prediction.corrections << " corrections (last " << prediction.lastCorrection << ", largest "
+                << prediction.maxCorrection << " blocks), remote players at tick " << remotePlayers->getPlaybackTick()
+                << ", " << remotePlayers->getStarvedSamples() << " starved samples" << std::endl;
+    }
+    if (regionStorage) {
+      auto saves = regionStorage->getStats();
+      std::cout << saves.regionsOpen << " region files open, " << saves.chunksLoaded << " chunks loaded, "
+                << saves.chunksSaved << " saved (" << saves.bytesWritten / 1024 << " KiB), " << saves.pendingSaves
+                << " waiting to be written" << std::endl;
+    }
+#endif
+#ifdef NETBLOCKS_PROFILER
+    printProfile();
+#endif
+  }
+
+#ifdef NETBLOCKS_PROFILER
+  if (input->isKeyDown(SDL_SCANCODE_F4)) {
+    isFrameGraphVisible = !isFrameGraphVisible;
+  }
+
+  if (input->isKeyDown(SDL_SCANCODE_F5)) {
+    auto &profiler = Profiler::get();
+    if (!profiler.isCapturing()) {
+      profiler.startCapture();
+      std::cout << "Capturing trace" << std::endl;
+    } else if (profiler.stopCapture(TRACE_PATH)) {
+      std::cout << "Trace written to " << TRACE_PATH << std::endl;
+    } else {
+      std::cerr << "Failed to write " << TRACE_PATH << std::endl;
+    }
+  }
+#endif
+
   if (isMouseLocked) {
-    camera->processKeyboard(input, deltaTime);
     camera->processMouseMovement(input);
+    if (wasMouseLocked) {
+      editBlocks();
+    }
   }
+}
 
-  chunk->tryUpdateMesh();
-
+void renderFrame() {
   glClearColor(0x98 / 255.0f, 0xd6 / 255.0f, 0xff / 255.0f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  standardShader->use();
-
   auto view = camera->getViewMatrix();
-  standardShader->setMat4("view", view);
-
   auto projection = camera->getProjectionMatrix(windowWidth, windowHeight);
-  standardShader->setMat4("projection", projection);
+  cameraUniforms->update(view, projection);
 
-  glm::mat4 model = glm::mat4(1.0f);
-  standardShader->setMat4("model", model);
+  standardShader->use();
 
-  chunk->render();
+  {
+    PROFILE_GPU_ZONE(*gpuTimer, "world");
+    world->render(standardShader, projection * view, camera->position);
+  }
+
+#ifdef PLATFORM_DESKTOP
+  if (networkClient) {
+    renderRemotePlayers();
+  }
+#endif
 
 //  simpleShader->use();
 //
-//  simpleShader->setMat4("view", view);
-//  simpleShader->setMat4("projection", projection);
-//
 //  glBindVertexArray(squareVAO);
 //  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
 //  glBindVertexArray(0);
 
-  SDL_GL_SwapWindow(window);
+#ifdef NETBLOCKS_PROFILER
+  if (isFrameGraphVisible) {
+    frameGraph->render(Profiler::get(), windowWidth, windowHeight);
+  }
+#endif
+
+  {
+    PROFILE_ZONE("swap");
+    SDL_GL_SwapWindow(window);
+  }
+
+#ifdef NETBLOCKS_PROFILER
+  gpuTimer->collect();
+#endif
+}
+
+void mainLoop() {
+  if (!isGameRunning) {
+#ifdef PLATFORM_DESKTOP
+    if (regionStorage) {
+      saveWorld();
+    }
+#endif
+    exitGame(EXIT_SUCCESS);
+  }
+
+  LAST = NOW;
+  NOW = SDL_GetPerformanceCounter();
+  deltaTime = (double) ((NOW - LAST) * 1000 / (double) SDL_GetPerformanceFrequency()) / 1000.0;
+
+  processInput();
+
+#ifdef PLATFORM_DESKTOP
+  if (networkClient) {
+    updateNetwork();
+  }
+  if (regionStorage) {
+    updateAutosave();
+  }
+#endif
+
+  updateMovement();
+
+  // The browser already paces frames to the display through requestAnimationFrame
+#ifdef PLATFORM_DESKTOP
+  world->update(camera->position, isRendering());
+  if (isRendering()) {
+    renderFrame();
+  }
+  paceFrame();
+#else
+  world->update(camera->position, true);
+  renderFrame();
+#endif
+  PROFILE_END_FRAME();
 }
 
 void initialize() {
@@ -171,6 +710,10 @@ void initialize() {
   std::cout << "Game initialized." << std::endl;
 
   standardShader = std::make_shared<Shader>("assets/shaders/standard.es3.vsh", "assets/shaders/standard.es3.fsh");
+#ifdef NETBLOCKS_PROFILER
+  frameGraph = std::make_shared<FrameGraph>(
+    std::make_shared<Shader>("assets/shaders/graph.es3.vsh", "assets/shaders/graph.es3.fsh"));
+#endif
 #elif PLATFORM_DESKTOP
   auto system = SDL_Init(SDL_INIT_VIDEO);
   if (system != 0) {
@@ -178,8 +721,9 @@ void initialize() {
     exitGame(EXIT_FAILURE);
   }
 
+  // Without rendering the window is only kept for its GL context, which the world creates its buffers in
   window = SDL_CreateWindow("NetBlocks", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 854, 480,
-                            SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+                            SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | (isRenderingRequested ? 0 : SDL_WINDOW_HIDDEN));
   if (window == nullptr) {
     std::cerr << "Error creating window: " << SDL_GetError() << std::endl;
     exitGame(EXIT_FAILURE);
@@ -196,6 +740,7 @@ void initialize() {
   }
 
   SDL_GL_MakeCurrent(window, gl_context);
+  setVsync(isVsyncEnabled);
 
   auto glew = glewInit();
   if (glew != GLEW_OK) {
@@ -209,16 +754,38 @@ void initialize() {
 
   standardShader = std::make_shared<Shader>("assets/shaders/standard.gl46.vsh", "assets/shaders/standard.gl46.fsh");
   simpleShader = std::make_shared<Shader>("assets/shaders/simple.gl46.vsh", "assets/shaders/simple.gl46.fsh");
+#ifdef NETBLOCKS_PROFILER
+  frameGraph = std::make_shared<FrameGraph>(
+    std::make_shared<Shader>("assets/shaders/graph.gl46.vsh", "assets/shaders/graph.gl46.fsh"));
+#endif
 #endif
 
   SDL_GetWindowSize(window, &windowWidth, &windowHeight);
 
-  camera = std::make_shared<Camera>(glm::vec3(0.0f, 0.0f, 3.0f));
+  camera = std::make_shared<Camera>(glm::vec3(0.0f, SPAWN_HEIGHT, 0.0f));
+  player = {camera->position, glm::vec3(0.0f), false};
+  previousPlayer = player;
 
-  chunk = std::make_shared<Chunk>(0, 0, time(nullptr) % 1000);
+  cameraUniforms = std::make_shared<CameraUniforms>();
+  chunkArena = std::make_shared<ChunkArena>();
+#ifdef PLATFORM_DESKTOP
+  if (!serverHost.empty()) {
+    world = std::make_shared<World>(0, chunkArena, ChunkSource::Remote);
+    connectToServer();
+    initPlayerBox();
+  } else {
+    openWorld();
+  }
+#else
+  world = std::make_shared<World>(time(nullptr) % 1000, chunkArena);
+#endif
 
   input = std::make_shared<Input>();
 
+#ifdef NETBLOCKS_PROFILER
+  gpuTimer = std::make_shared<GpuTimer>();
+#endif
+
   //initSquare();
 
   //glEnable(GL_CULL_FACE);
@@ -229,6 +796,10 @@ void initialize() {
 }
 
 [[noreturn]] int main(int argv, char *argc[]) {
+#ifdef PLATFORM_DESKTOP
+  parseArguments(argv, argc);
+#endif
+
   initialize();
 
 #ifdef PLATFORM_WEB